@@ -1,123 +1,250 @@
 #include <anton/gizmo/arrow_3d.hpp>
 
 #include <intersection_tests.hpp>
+#include <simd.hpp>
 #include <utils.hpp>
+#include <vertex_output.hpp>
 
 namespace anton::gizmo {
-    [[nodiscard]] static Array<math::Vec3> generate_cone_geometry(Arrow_3D const& arrow, i32 const vert_count) {
-        Array<math::Vec3> circle = generate_circle(math::Vec3{0.0f}, math::Vec3{0.0f, 0.0f, -1.0f}, 0.5f, vert_count);
+    template<typename Output>
+    static void generate_cone_geometry(Arrow_3D const& arrow, i32 const vert_count, Output& output) {
+        Circle_Generator circle{math::Vec3{0.0f}, math::Vec3{0.0f, 0.0f, -1.0f}, 0.5f, vert_count};
         f32 const cap_size = arrow.cap_size;
         f32 const cap_length = arrow.cap_length;
         f32 const shaft_length = arrow.shaft_length;
         f32 const shaft_diameter = arrow.shaft_diameter;
-        Array<math::Vec3> cone{reserve, (i64)vert_count * (3 + 3 + 6 + 3)};
+        math::Vec3 const first = circle.next();
+        math::Vec3 v1 = first;
         for(i64 i = 0; i < vert_count; ++i) {
-            math::Vec3& v1 = circle[i];
-            math::Vec3& v2 = circle[(i + 1) % vert_count];
+            math::Vec3 const v2 = i + 1 < vert_count ? circle.next() : first;
             // Cone
-            cone.emplace_back(v1.x * cap_size, v1.y * cap_size, -shaft_length);
-            cone.emplace_back(v2.x * cap_size, v2.y * cap_size, -shaft_length);
-            cone.emplace_back(0.0f, 0.0f, -shaft_length - cap_length);
+            output.write({v1.x * cap_size, v1.y * cap_size, -shaft_length});
+            output.write({v2.x * cap_size, v2.y * cap_size, -shaft_length});
+            output.write({0.0f, 0.0f, -shaft_length - cap_length});
             // Cone base
-            cone.emplace_back(0.0f, 0.0f, -shaft_length);
-            cone.emplace_back(v2.x * cap_size, v2.y * cap_size, -shaft_length);
-            cone.emplace_back(v1.x * cap_size, v1.y * cap_size, -shaft_length);
+            output.write({0.0f, 0.0f, -shaft_length});
+            output.write({v2.x * cap_size, v2.y * cap_size, -shaft_length});
+            output.write({v1.x * cap_size, v1.y * cap_size, -shaft_length});
             // We don't generate 1st cylinder cap
             // Cylinder
-            cone.emplace_back(v1.x * shaft_diameter, v1.y * shaft_diameter, -shaft_length);
-            cone.emplace_back(v1.x * shaft_diameter, v1.y * shaft_diameter, 0.0f);
-            cone.emplace_back(v2.x * shaft_diameter, v2.y * shaft_diameter, 0.0f);
-            cone.emplace_back(v2.x * shaft_diameter, v2.y * shaft_diameter, 0.0f);
-            cone.emplace_back(v2.x * shaft_diameter, v2.y * shaft_diameter, -shaft_length);
-            cone.emplace_back(v1.x * shaft_diameter, v1.y * shaft_diameter, -shaft_length);
+            output.write({v1.x * shaft_diameter, v1.y * shaft_diameter, -shaft_length});
+            output.write({v1.x * shaft_diameter, v1.y * shaft_diameter, 0.0f});
+            output.write({v2.x * shaft_diameter, v2.y * shaft_diameter, 0.0f});
+            output.write({v2.x * shaft_diameter, v2.y * shaft_diameter, 0.0f});
+            output.write({v2.x * shaft_diameter, v2.y * shaft_diameter, -shaft_length});
+            output.write({v1.x * shaft_diameter, v1.y * shaft_diameter, -shaft_length});
             // 2nd cylinder cap
-            cone.emplace_back(0.0f, 0.0f, 0.0f);
-            cone.emplace_back(v1.x * shaft_diameter, v1.y * shaft_diameter, 0.0f);
-            cone.emplace_back(v2.x * shaft_diameter, v2.y * shaft_diameter, 0.0f);
+            output.write({0.0f, 0.0f, 0.0f});
+            output.write({v1.x * shaft_diameter, v1.y * shaft_diameter, 0.0f});
+            output.write({v2.x * shaft_diameter, v2.y * shaft_diameter, 0.0f});
+            v1 = v2;
         }
-        return cone;
     }
 
-    [[nodiscard]] static Array<math::Vec3> generate_cube_geometry(Arrow_3D const& arrow, i32 const vert_count) {
-        Array<math::Vec3> circle = generate_circle(math::Vec3{0.0f}, math::Vec3{0.0f, 0.0f, -1.0f}, 0.5f, vert_count);
+    template<typename Output>
+    static void generate_cube_geometry(Arrow_3D const& arrow, i32 const vert_count, Output& output) {
+        Circle_Generator circle{math::Vec3{0.0f}, math::Vec3{0.0f, 0.0f, -1.0f}, 0.5f, vert_count};
         f32 const shaft_length = arrow.shaft_length;
         f32 const shaft_diameter = arrow.shaft_diameter;
         f32 const half_size = 0.5f * arrow.cap_size;
         math::Vec3 const offset = {0, 0, -shaft_length + half_size};
-        Array<math::Vec3> cube{reserve, 36 + (3 + 6 + 3) * (i64)vert_count};
         // Generate cube
-        // Top face
-        cube.emplace_back(offset + math::Vec3{-half_size, half_size, half_size});
-        cube.emplace_back(offset + math::Vec3{half_size, half_size, half_size});
-        cube.emplace_back(offset + math::Vec3{-half_size, half_size, -half_size});
-        cube.emplace_back(offset + math::Vec3{-half_size, half_size, -half_size});
-        cube.emplace_back(offset + math::Vec3{half_size, half_size, half_size});
-        cube.emplace_back(offset + math::Vec3{half_size, half_size, -half_size});
-        // Bottom face
-        cube.emplace_back(offset + math::Vec3{-half_size, -half_size, half_size});
-        cube.emplace_back(offset + math::Vec3{-half_size, -half_size, -half_size});
-        cube.emplace_back(offset + math::Vec3{half_size, -half_size, half_size});
-        cube.emplace_back(offset + math::Vec3{-half_size, -half_size, -half_size});
-        cube.emplace_back(offset + math::Vec3{half_size, -half_size, -half_size});
-        cube.emplace_back(offset + math::Vec3{half_size, -half_size, half_size});
-        // Right face
-        cube.emplace_back(offset + math::Vec3{half_size, half_size, half_size});
-        cube.emplace_back(offset + math::Vec3{half_size, -half_size, half_size});
-        cube.emplace_back(offset + math::Vec3{half_size, -half_size, -half_size});
-        cube.emplace_back(offset + math::Vec3{half_size, half_size, half_size});
-        cube.emplace_back(offset + math::Vec3{half_size, -half_size, -half_size});
-        cube.emplace_back(offset + math::Vec3{half_size, half_size, -half_size});
-        // Left face
-        cube.emplace_back(offset + math::Vec3{-half_size, half_size, half_size});
-        cube.emplace_back(offset + math::Vec3{-half_size, -half_size, -half_size});
-        cube.emplace_back(offset + math::Vec3{-half_size, -half_size, half_size});
-        cube.emplace_back(offset + math::Vec3{-half_size, half_size, half_size});
-        cube.emplace_back(offset + math::Vec3{-half_size, half_size, -half_size});
-        cube.emplace_back(offset + math::Vec3{-half_size, -half_size, -half_size});
-        // Front face
-        cube.emplace_back(offset + math::Vec3{-half_size, half_size, -half_size});
-        cube.emplace_back(offset + math::Vec3{half_size, half_size, -half_size});
-        cube.emplace_back(offset + math::Vec3{-half_size, -half_size, -half_size});
-        cube.emplace_back(offset + math::Vec3{-half_size, -half_size, -half_size});
-        cube.emplace_back(offset + math::Vec3{half_size, half_size, -half_size});
-        cube.emplace_back(offset + math::Vec3{half_size, -half_size, -half_size});
-        // Back face
-        cube.emplace_back(offset + math::Vec3{-half_size, half_size, half_size});
-        cube.emplace_back(offset + math::Vec3{-half_size, -half_size, half_size});
-        cube.emplace_back(offset + math::Vec3{half_size, half_size, half_size});
-        cube.emplace_back(offset + math::Vec3{-half_size, -half_size, half_size});
-        cube.emplace_back(offset + math::Vec3{half_size, -half_size, half_size});
-        cube.emplace_back(offset + math::Vec3{half_size, half_size, half_size});
+        for(u32 const index: cube_indices) {
+            output.write(offset + cube_corners[index] * arrow.cap_size);
+        }
         // Generate shaft
+        math::Vec3 const first = circle.next();
+        math::Vec3 v1 = first;
         for(i64 i = 0; i < vert_count; ++i) {
-            math::Vec3& v1 = circle[i];
-            math::Vec3& v2 = circle[(i + 1) % vert_count];
+            math::Vec3 const v2 = i + 1 < vert_count ? circle.next() : first;
             // 1st cylinder cap
-            cube.emplace_back(0.0f, 0.0f, 0.0f);
-            cube.emplace_back(v1.x * shaft_diameter, v1.y * shaft_diameter, 0.0f);
-            cube.emplace_back(v2.x * shaft_diameter, v2.y * shaft_diameter, 0.0f);
+            output.write({0.0f, 0.0f, 0.0f});
+            output.write({v1.x * shaft_diameter, v1.y * shaft_diameter, 0.0f});
+            output.write({v2.x * shaft_diameter, v2.y * shaft_diameter, 0.0f});
             // Cylinder
-            cube.emplace_back(v1.x * shaft_diameter, v1.y * shaft_diameter, -shaft_length);
-            cube.emplace_back(v1.x * shaft_diameter, v1.y * shaft_diameter, 0.0f);
-            cube.emplace_back(v2.x * shaft_diameter, v2.y * shaft_diameter, 0.0f);
-            cube.emplace_back(v2.x * shaft_diameter, v2.y * shaft_diameter, 0.0f);
-            cube.emplace_back(v2.x * shaft_diameter, v2.y * shaft_diameter, -shaft_length);
-            cube.emplace_back(v1.x * shaft_diameter, v1.y * shaft_diameter, -shaft_length);
+            output.write({v1.x * shaft_diameter, v1.y * shaft_diameter, -shaft_length});
+            output.write({v1.x * shaft_diameter, v1.y * shaft_diameter, 0.0f});
+            output.write({v2.x * shaft_diameter, v2.y * shaft_diameter, 0.0f});
+            output.write({v2.x * shaft_diameter, v2.y * shaft_diameter, 0.0f});
+            output.write({v2.x * shaft_diameter, v2.y * shaft_diameter, -shaft_length});
+            output.write({v1.x * shaft_diameter, v1.y * shaft_diameter, -shaft_length});
             // 2nd cylinder cap
-            cube.emplace_back(0.0f, 0.0f, 0.0f);
-            cube.emplace_back(v2.x * shaft_diameter, v2.y * shaft_diameter, -shaft_length);
-            cube.emplace_back(v1.x * shaft_diameter, v1.y * shaft_diameter, -shaft_length);
+            output.write({0.0f, 0.0f, 0.0f});
+            output.write({v2.x * shaft_diameter, v2.y * shaft_diameter, -shaft_length});
+            output.write({v1.x * shaft_diameter, v1.y * shaft_diameter, -shaft_length});
+            v1 = v2;
+        }
+    }
+
+    i64 arrow_3d_vertex_count(Arrow_3D const& arrow, i32 const vertex_count) {
+        switch(arrow.draw_style) {
+            case Arrow_3D_Style::cone:
+                return (3 + 3 + 6 + 3) * (i64)vertex_count;
+
+            case Arrow_3D_Style::cube:
+                return 36 + (3 + 6 + 3) * (i64)vertex_count;
         }
-        return cube;
+    }
+
+    template<typename Output>
+    static void write_arrow_3d_geometry(Arrow_3D const& arrow, i32 const vertex_count, Output& output) {
+        switch(arrow.draw_style) {
+            case Arrow_3D_Style::cone:
+                generate_cone_geometry(arrow, vertex_count, output);
+                break;
+
+            case Arrow_3D_Style::cube:
+                generate_cube_geometry(arrow, vertex_count, output);
+                break;
+        }
+    }
+
+    void generate_arrow_3d_geometry(Arrow_3D const& arrow, i32 const vertex_count, Slice<math::Vec3> const vertices) {
+        Position_Output output{vertices};
+        write_arrow_3d_geometry(arrow, vertex_count, output);
+    }
+
+    Position_Dequantization generate_arrow_3d_geometry(Arrow_3D const& arrow, i32 const vertex_count, Vertex_Layout const& layout, u32 const handle_id,
+                                                       Slice<u8> const buffer) {
+        // The bounding box of the shaft and the head. The cube is placed the same way as in generate_cube_geometry.
+        f32 const shaft_radius = 0.5f * arrow.shaft_diameter;
+        f32 const head_radius = 0.5f * arrow.cap_size;
+        f32 const radius = math::max(shaft_radius, head_radius);
+        f32 const head_min = arrow.draw_style == Arrow_3D_Style::cone ? -arrow.shaft_length - arrow.cap_length : -arrow.shaft_length;
+        f32 const head_max = arrow.draw_style == Arrow_3D_Style::cone ? -arrow.shaft_length : -arrow.shaft_length + arrow.cap_size;
+        math::Vec3 const min{-radius, -radius, math::min(math::min(-arrow.shaft_length, 0.0f), head_min)};
+        math::Vec3 const max{radius, radius, math::max(0.0f, head_max)};
+        Vertex_Output output{layout, handle_id, min, max, buffer};
+        write_arrow_3d_geometry(arrow, vertex_count, output);
+        return output.get_dequantization();
     }
 
     anton::Array<math::Vec3> generate_arrow_3d_geometry(Arrow_3D const& arrow, i32 const vertex_count) {
+        anton::Array<math::Vec3> vertices(arrow_3d_vertex_count(arrow, vertex_count));
+        generate_arrow_3d_geometry(arrow, vertex_count, vertices);
+        return vertices;
+    }
+
+    [[nodiscard]] static Indexed_Geometry generate_cone_geometry_indexed(Arrow_3D const& arrow, i32 const vert_count) {
+        Array<math::Vec3> circle = generate_circle(math::Vec3{0.0f}, math::Vec3{0.0f, 0.0f, -1.0f}, 0.5f, vert_count);
+        f32 const cap_size = arrow.cap_size;
+        f32 const cap_length = arrow.cap_length;
+        f32 const shaft_length = arrow.shaft_length;
+        f32 const shaft_diameter = arrow.shaft_diameter;
+        // Layout of the vertices:
+        //  - the base of the cone (vert_count)
+        //  - the far ring of the cylinder (vert_count)
+        //  - the near ring of the cylinder (vert_count)
+        //  - the apex of the cone, the center of the base of the cone and the center of the 2nd cylinder cap
+        u32 const count = vert_count;
+        u32 const cone_base = 0;
+        u32 const far_ring = count;
+        u32 const near_ring = 2 * count;
+        u32 const apex = 3 * count;
+        u32 const cone_base_center = apex + 1;
+        u32 const near_center = apex + 2;
+        Indexed_Geometry geometry{Array<math::Vec3>{reserve, 3 * (i64)vert_count + 3}, Array<u32>{reserve, (i64)vert_count * (3 + 3 + 6 + 3)}};
+        for(i64 i = 0; i < vert_count; ++i) {
+            geometry.vertices.emplace_back(circle[i].x * cap_size, circle[i].y * cap_size, -shaft_length);
+        }
+        for(i64 i = 0; i < vert_count; ++i) {
+            geometry.vertices.emplace_back(circle[i].x * shaft_diameter, circle[i].y * shaft_diameter, -shaft_length);
+        }
+        for(i64 i = 0; i < vert_count; ++i) {
+            geometry.vertices.emplace_back(circle[i].x * shaft_diameter, circle[i].y * shaft_diameter, 0.0f);
+        }
+        geometry.vertices.emplace_back(0.0f, 0.0f, -shaft_length - cap_length);
+        geometry.vertices.emplace_back(0.0f, 0.0f, -shaft_length);
+        geometry.vertices.emplace_back(0.0f, 0.0f, 0.0f);
+
+        Array<u32>& indices = geometry.indices;
+        for(u32 i = 0; i < count; ++i) {
+            u32 const i1 = i;
+            u32 const i2 = (i + 1) % count;
+            // Cone
+            indices.emplace_back(cone_base + i1);
+            indices.emplace_back(cone_base + i2);
+            indices.emplace_back(apex);
+            // Cone base
+            indices.emplace_back(cone_base_center);
+            indices.emplace_back(cone_base + i2);
+            indices.emplace_back(cone_base + i1);
+            // We don't generate 1st cylinder cap
+            // Cylinder
+            indices.emplace_back(far_ring + i1);
+            indices.emplace_back(near_ring + i1);
+            indices.emplace_back(near_ring + i2);
+            indices.emplace_back(near_ring + i2);
+            indices.emplace_back(far_ring + i2);
+            indices.emplace_back(far_ring + i1);
+            // 2nd cylinder cap
+            indices.emplace_back(near_center);
+            indices.emplace_back(near_ring + i1);
+            indices.emplace_back(near_ring + i2);
+        }
+        return geometry;
+    }
+
+    [[nodiscard]] static Indexed_Geometry generate_cube_geometry_indexed(Arrow_3D const& arrow, i32 const vert_count) {
+        Array<math::Vec3> circle = generate_circle(math::Vec3{0.0f}, math::Vec3{0.0f, 0.0f, -1.0f}, 0.5f, vert_count);
+        f32 const shaft_length = arrow.shaft_length;
+        f32 const shaft_diameter = arrow.shaft_diameter;
+        f32 const half_size = 0.5f * arrow.cap_size;
+        math::Vec3 const offset = {0, 0, -shaft_length + half_size};
+        // Layout of the vertices:
+        //  - the corners of the cube (8)
+        //  - the near ring of the cylinder (vert_count)
+        //  - the far ring of the cylinder (vert_count)
+        //  - the center of the 1st cylinder cap
+        u32 const count = vert_count;
+        u32 const near_ring = 8;
+        u32 const far_ring = 8 + count;
+        u32 const near_center = 8 + 2 * count;
+        Indexed_Geometry geometry{Array<math::Vec3>{reserve, 9 + 2 * (i64)vert_count}, Array<u32>{reserve, 36 + (3 + 6 + 3) * (i64)vert_count}};
+        for(math::Vec3 const& corner: cube_corners) {
+            geometry.vertices.emplace_back(offset + corner * arrow.cap_size);
+        }
+        for(i64 i = 0; i < vert_count; ++i) {
+            geometry.vertices.emplace_back(circle[i].x * shaft_diameter, circle[i].y * shaft_diameter, 0.0f);
+        }
+        for(i64 i = 0; i < vert_count; ++i) {
+            geometry.vertices.emplace_back(circle[i].x * shaft_diameter, circle[i].y * shaft_diameter, -shaft_length);
+        }
+        geometry.vertices.emplace_back(0.0f, 0.0f, 0.0f);
+
+        Array<u32>& indices = geometry.indices;
+        for(u32 const index: cube_indices) {
+            indices.emplace_back(index);
+        }
+        for(u32 i = 0; i < count; ++i) {
+            u32 const i1 = i;
+            u32 const i2 = (i + 1) % count;
+            // 1st cylinder cap
+            indices.emplace_back(near_center);
+            indices.emplace_back(near_ring + i1);
+            indices.emplace_back(near_ring + i2);
+            // Cylinder
+            indices.emplace_back(far_ring + i1);
+            indices.emplace_back(near_ring + i1);
+            indices.emplace_back(near_ring + i2);
+            indices.emplace_back(near_ring + i2);
+            indices.emplace_back(far_ring + i2);
+            indices.emplace_back(far_ring + i1);
+            // 2nd cylinder cap
+            indices.emplace_back(near_center);
+            indices.emplace_back(far_ring + i2);
+            indices.emplace_back(far_ring + i1);
+        }
+        return geometry;
+    }
+
+    Indexed_Geometry generate_arrow_3d_geometry_indexed(Arrow_3D const& arrow, i32 const vertex_count) {
         switch(arrow.draw_style) {
             case Arrow_3D_Style::cone:
-                return generate_cone_geometry(arrow, vertex_count);
+                return generate_cone_geometry_indexed(arrow, vertex_count);
 
             case Arrow_3D_Style::cube:
-                return generate_cube_geometry(arrow, vertex_count);
+                return generate_cube_geometry_indexed(arrow, vertex_count);
         }
     }
 
@@ -129,13 +256,38 @@ namespace anton::gizmo {
         return transform;
     }
 
-    Optional<f32> intersect_arrow_3d(math::Ray const ray, Arrow_3D const& arrow, math::Mat4 const& gizmo_transform) {
+    Prepared_Handle prepare_arrow_3d(Arrow_3D const& arrow, math::Mat4 const& gizmo_transform) {
+        // The extent of the bounding volumes along the arrow and their largest distance from it.
+        f32 const shaft_radius = 0.5f * arrow.shaft_diameter;
+        f32 begin = 0.0f;
+        f32 end = arrow.shaft_length;
+        f32 radius = shaft_radius;
+        switch(arrow.draw_style) {
+            case Arrow_3D_Style::cone: {
+                end = math::max(end, arrow.shaft_length + arrow.cap_length);
+                radius = math::max(radius, 0.5f * arrow.cap_size);
+            } break;
+
+            case Arrow_3D_Style::cube: {
+                // Any orientation of the cube around its center fits within the sphere through its corners.
+                f32 const cube_center = arrow.shaft_length - 0.5f * arrow.cap_size;
+                f32 const cube_radius = 0.8660254f * arrow.cap_size;
+                begin = math::min(begin, cube_center - cube_radius);
+                end = math::max(end, cube_center + cube_radius);
+                radius = math::max(radius, cube_radius);
+            } break;
+        }
+
+        f32 const half_length = 0.5f * (end - begin);
+        math::Vec3 const center{0.0f, 0.0f, -(begin + half_length)};
+        return prepare_handle(gizmo_transform, center, math::sqrt(half_length * half_length + radius * radius));
+    }
+
+    Optional<f32> intersect_arrow_3d(math::Ray const ray, Arrow_3D const& arrow, Prepared_Handle const& handle) {
         Optional<f32> result = null_optional;
-        // Uniformly scaled - all axes have the same scale applied
-        f32 const scale = math::length(gizmo_transform[0]);
-        math::Vec3 const origin{gizmo_transform * math::Vec4{0.0f, 0.0f, 0.0f, 1.0f}};
-        math::Vec3 const direction_scaled{gizmo_transform * math::Vec4{0.0f, 0.0f, -1.0f, 0.0f}};
-        math::Vec3 const direction = normalize(direction_scaled);
+        f32 const scale = handle.scale;
+        math::Vec3 const origin = handle.origin;
+        math::Vec3 const direction = handle.z_axis;
         f32 const shaft_radius = 0.5f * scale * arrow.shaft_diameter;
         f32 const shaft_length = scale * arrow.shaft_length;
         Optional<Raycast_Hit> const shaft_hit = intersect_ray_cylinder(ray, origin, origin + direction * shaft_length, shaft_radius);
@@ -158,13 +310,10 @@ namespace anton::gizmo {
             } break;
 
             case Arrow_3D_Style::cube: {
-                math::Vec3 const x_axis{gizmo_transform * math::Vec4{1.0f, 0.0f, 0.0f, 0.0f}};
-                math::Vec3 const y_axis{gizmo_transform * math::Vec4{0.0f, 1.0f, 0.0f, 0.0f}};
-                math::Vec3 const z_axis{direction};
                 math::OBB cube_bounding_vol;
-                cube_bounding_vol.local_x = x_axis;
-                cube_bounding_vol.local_y = y_axis;
-                cube_bounding_vol.local_z = z_axis;
+                cube_bounding_vol.local_x = handle.x_axis;
+                cube_bounding_vol.local_y = handle.y_axis;
+                cube_bounding_vol.local_z = handle.z_axis;
                 cube_bounding_vol.halfwidths = math::Vec3{0.5f * scale * arrow.cap_size};
                 cube_bounding_vol.center = origin + scale * (arrow.shaft_length - 0.5f * arrow.cap_size) * direction;
                 Optional<Raycast_Hit> const cube_hit = intersect_ray_obb(ray, cube_bounding_vol);
@@ -176,4 +325,174 @@ namespace anton::gizmo {
 
         return result;
     }
+
+    Optional<f32> intersect_arrow_3d(math::Ray const ray, Arrow_3D const& arrow, math::Mat4 const& gizmo_transform) {
+        return intersect_arrow_3d(ray, arrow, prepare_arrow_3d(arrow, gizmo_transform));
+    }
+
+    // The number of streams of Arrow_3D_Batch::components.
+    constexpr i64 arrow_3d_batch_stream_count = 13;
+
+    enum Arrow_3D_Batch_Stream : i64 {
+        stream_origin = 0,
+        stream_direction = 3,
+        stream_x_axis = 6,
+        stream_y_axis = 9,
+        stream_scale = 12,
+    };
+
+    void prepare_arrow_3d_batch(Slice<math::Mat4 const> const gizmo_transforms, Arrow_3D_Batch& batch) {
+        // Pad to the widest supported lane count so that the last group may be loaded in full.
+        i64 const stride = (gizmo_transforms.size() + 7) & ~(i64)7;
+        batch.count = gizmo_transforms.size();
+        batch.stride = stride;
+        batch.components.resize(arrow_3d_batch_stream_count * stride);
+        f32* const components = batch.components.data();
+        for(i64 i = 0; i < batch.count; ++i) {
+            math::Mat4 const& transform = gizmo_transforms[i];
+            f32 const scale = math::length(transform[0]);
+            f32 const inv_scale = 1.0f / scale;
+            // The arrows are directed towards -z in their local space.
+            f32 const values[arrow_3d_batch_stream_count] = {transform[3][0],
+                                                             transform[3][1],
+                                                             transform[3][2],
+                                                             -transform[2][0] * inv_scale,
+                                                             -transform[2][1] * inv_scale,
+                                                             -transform[2][2] * inv_scale,
+                                                             transform[0][0] * inv_scale,
+                                                             transform[0][1] * inv_scale,
+                                                             transform[0][2] * inv_scale,
+                                                             transform[1][0] * inv_scale,
+                                                             transform[1][1] * inv_scale,
+                                                             transform[1][2] * inv_scale,
+                                                             scale};
+            for(i64 stream = 0; stream < arrow_3d_batch_stream_count; ++stream) {
+                components[stream * stride + i] = values[stream];
+            }
+        }
+
+        // The padding is never reported as hit, but must hold valid floats.
+        for(i64 stream = 0; stream < arrow_3d_batch_stream_count; ++stream) {
+            for(i64 i = batch.count; i < stride; ++i) {
+                components[stream * stride + i] = 0.0f;
+            }
+        }
+    }
+
+    [[nodiscard]] static simd::Float3 load_float3(f32 const* const components, i64 const stride, i64 const stream, i64 const index) {
+        f32 const* const first = components + stream * stride + index;
+        return {simd::load(first), simd::load(first + stride), simd::load(first + 2 * stride)};
+    }
+
+    // Arrow_3D_Lanes
+    // The parameters of an arrow broadcast to all lanes.
+    //
+    struct Arrow_3D_Lanes {
+        Arrow_3D_Style draw_style;
+        simd::Float shaft_length;
+        simd::Float shaft_radius;
+        simd::Float cap_length;
+        simd::Float cap_halfwidth;
+        simd::Float cone_offset;
+        simd::Float cone_angle_cos;
+        simd::Float cube_offset;
+    };
+
+    [[nodiscard]] static Arrow_3D_Lanes broadcast_arrow_3d(Arrow_3D const& arrow) {
+        f32 const cone_radius = 0.5f * arrow.cap_size;
+        // cos(a) = adjacent / hypotenuse
+        f32 const cone_angle_cos = arrow.cap_length * math::inv_sqrt(arrow.cap_length * arrow.cap_length + cone_radius * cone_radius);
+        return Arrow_3D_Lanes{arrow.draw_style,
+                              simd::broadcast(arrow.shaft_length),
+                              simd::broadcast(0.5f * arrow.shaft_diameter),
+                              simd::broadcast(arrow.cap_length),
+                              simd::broadcast(0.5f * arrow.cap_size),
+                              simd::broadcast(arrow.shaft_length + arrow.cap_length),
+                              simd::broadcast(cone_angle_cos),
+                              simd::broadcast(arrow.shaft_length - 0.5f * arrow.cap_size)};
+    }
+
+    // intersect_arrow_3d_lanes
+    // Intersects the ray in each lane with the bounding volumes of the arrow in the same lane. Either the rays
+    // or the arrows may be the same in all lanes.
+    //
+    // Returns:
+    // The distance along the rays to the nearest intersection points or infinity in the lanes where the ray misses.
+    //
+    [[nodiscard]] static simd::Float intersect_arrow_3d_lanes(simd::Float3 const& ray_origin, simd::Float3 const& ray_direction, Arrow_3D_Lanes const& arrow,
+                                                              simd::Float3 const& origin, simd::Float3 const& direction, simd::Float3 const& x_axis,
+                                                              simd::Float3 const& y_axis, simd::Float const scale) {
+        // Shaft. A capped cylinder from origin to origin + direction * length.
+        simd::Float distance =
+            intersect_ray_capped_cylinder(ray_origin - origin, ray_direction, direction, scale * arrow.shaft_radius, scale * arrow.shaft_length);
+        switch(arrow.draw_style) {
+            case Arrow_3D_Style::cone: {
+                // The cone expands from its vertex at the tip of the arrow towards the origin.
+                simd::Float3 const vertex_offset = ray_origin - (origin + direction * (scale * arrow.cone_offset));
+                simd::Float const height = scale * arrow.cap_length;
+                distance = simd::min(distance, solve_ray_quadric(setup_ray_cone(vertex_offset, ray_direction, -direction, arrow.cone_angle_cos, height)));
+            } break;
+
+            case Arrow_3D_Style::cube: {
+                simd::Float3 const center_offset = ray_origin - (origin + direction * (scale * arrow.cube_offset));
+                simd::Float const halfwidth = scale * arrow.cap_halfwidth;
+                simd::Float3 const halfwidths{halfwidth, halfwidth, halfwidth};
+                distance = simd::min(distance, intersect_ray_obb(center_offset, ray_direction, x_axis, y_axis, direction, halfwidths));
+            } break;
+        }
+        return distance;
+    }
+
+    Optional<Arrow_3D_Batch_Hit> intersect_arrow_3d_batch(math::Ray const ray, Arrow_3D const& arrow, Arrow_3D_Batch const& batch) {
+        simd::Float3 const ray_origin = broadcast_vec3(ray.origin);
+        simd::Float3 const ray_direction = broadcast_vec3(ray.direction);
+        simd::Float const count = simd::broadcast(static_cast<f32>(batch.count));
+        Arrow_3D_Lanes const arrow_lanes = broadcast_arrow_3d(arrow);
+
+        f32 const* const components = batch.components.data();
+        i64 const stride = batch.stride;
+        simd::Float best_distance = simd::broadcast(math::infinity);
+        simd::Float best_index = simd::broadcast(-1.0f);
+        for(i64 i = 0; i < batch.count; i += simd::lane_count) {
+            simd::Float3 const origin = load_float3(components, stride, stream_origin, i);
+            simd::Float3 const direction = load_float3(components, stride, stream_direction, i);
+            simd::Float3 const x_axis = load_float3(components, stride, stream_x_axis, i);
+            simd::Float3 const y_axis = load_float3(components, stride, stream_y_axis, i);
+            simd::Float const scale = simd::load(components + stream_scale * stride + i);
+            simd::Float const indices = simd::lane_indices(static_cast<f32>(i));
+            simd::Float const distance = intersect_arrow_3d_lanes(ray_origin, ray_direction, arrow_lanes, origin, direction, x_axis, y_axis, scale);
+            simd::Mask const closer = (indices < count) & (distance < best_distance);
+            best_distance = simd::select(closer, distance, best_distance);
+            best_index = simd::select(closer, indices, best_index);
+        }
+
+        f32 distances[simd::lane_count];
+        f32 indices[simd::lane_count];
+        simd::store(distances, best_distance);
+        simd::store(indices, best_index);
+        i64 best_lane = 0;
+        for(i64 lane = 1; lane < simd::lane_count; ++lane) {
+            if(distances[lane] < distances[best_lane] || (distances[lane] == distances[best_lane] && indices[lane] < indices[best_lane])) {
+                best_lane = lane;
+            }
+        }
+
+        if(indices[best_lane] < 0.0f) {
+            return null_optional;
+        }
+
+        return Arrow_3D_Batch_Hit{static_cast<i64>(indices[best_lane]), distances[best_lane]};
+    }
+
+    Ray_Packet_Hits intersect_arrow_3d(Ray_Packet const& packet, Arrow_3D const& arrow, Prepared_Handle const& handle) {
+        Arrow_3D_Lanes const arrow_lanes = broadcast_arrow_3d(arrow);
+        simd::Float3 const origin = broadcast_vec3(handle.origin);
+        simd::Float3 const direction = broadcast_vec3(handle.z_axis);
+        simd::Float3 const x_axis = broadcast_vec3(handle.x_axis);
+        simd::Float3 const y_axis = broadcast_vec3(handle.y_axis);
+        simd::Float const scale = simd::broadcast(handle.scale);
+        return intersect_ray_packet(packet, [&](simd::Float3 const& ray_origin, simd::Float3 const& ray_direction) {
+            return intersect_arrow_3d_lanes(ray_origin, ray_direction, arrow_lanes, origin, direction, x_axis, y_axis, scale);
+        });
+    }
 } // namespace anton::gizmo
@@ -0,0 +1,448 @@
+#include <anton/gizmo/baked_geometry.hpp>
+
+#include <anton/utility.hpp>
+#include <vertex_output.hpp>
+
+#include <stdio.h>
+
+#if defined(_WIN32)
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <Windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace anton::gizmo {
+    // "AGZB" in the native byte order of a little endian machine.
+    static constexpr u32 baked_geometry_magic = 0x425A4741;
+    static constexpr u32 baked_geometry_format_version = 1;
+    // Must be incremented whenever any of the generators changes its output so that outdated files are rejected.
+    static constexpr u32 baked_geometry_generator_version = 1;
+    static constexpr i64 baked_geometry_alignment = 16;
+
+    enum class Baked_Geometry_Kind : u32 {
+        triangle_list,
+        indexed,
+        interleaved,
+    };
+
+    struct Baked_Geometry_Header {
+        u32 magic;
+        u32 format_version;
+        u32 generator_version;
+        u32 entry_count;
+        u64 file_size;
+        u64 reserved;
+    };
+
+    struct Baked_Geometry_Entry {
+        Geometry_Key key;
+        u64 hash;
+        u32 kind;
+        u32 handle_id;
+        u32 stride;
+        u32 position_format;
+        u32 position_offset;
+        u32 normal_format;
+        u32 normal_offset;
+        u32 handle_id_format;
+        u32 handle_id_offset;
+        u32 reserved;
+        f32 dequantization_scale[3];
+        f32 dequantization_bias[3];
+        // Offsets are in bytes from the beginning of the file.
+        u64 vertex_offset;
+        u64 vertex_count;
+        u64 index_offset;
+        u64 index_count;
+    };
+
+    static_assert(sizeof(Baked_Geometry_Header) == 32, "unexpected padding in Baked_Geometry_Header");
+    static_assert(sizeof(Baked_Geometry_Entry) == 136, "unexpected padding in Baked_Geometry_Entry");
+
+    [[nodiscard]] static i64 align_up(i64 const value) {
+        return (value + baked_geometry_alignment - 1) & ~(baked_geometry_alignment - 1);
+    }
+
+    static void copy_bytes(u8* const destination, void const* const source, i64 const size) {
+        u8 const* const bytes = reinterpret_cast<u8 const*>(source);
+        for(i64 i = 0; i < size; ++i) {
+            destination[i] = bytes[i];
+        }
+    }
+
+    [[nodiscard]] static bool compare_layouts(Vertex_Layout const& lhs, Vertex_Layout const& rhs) {
+        return lhs.stride == rhs.stride && lhs.position_format == rhs.position_format && lhs.position_offset == rhs.position_offset &&
+               lhs.normal_format == rhs.normal_format && lhs.normal_offset == rhs.normal_offset && lhs.handle_id_format == rhs.handle_id_format &&
+               lhs.handle_id_offset == rhs.handle_id_offset;
+    }
+
+    [[nodiscard]] static Vertex_Layout get_layout(Baked_Geometry_Entry const& entry) {
+        Vertex_Layout layout;
+        layout.stride = entry.stride;
+        layout.position_format = static_cast<Position_Format>(entry.position_format);
+        layout.position_offset = entry.position_offset;
+        layout.normal_format = static_cast<Normal_Format>(entry.normal_format);
+        layout.normal_offset = entry.normal_offset;
+        layout.handle_id_format = static_cast<Handle_ID_Format>(entry.handle_id_format);
+        layout.handle_id_offset = entry.handle_id_offset;
+        return layout;
+    }
+
+    void Baked_Geometry_Writer::add_triangle_list(Geometry_Key const& key, Slice<math::Vec3 const> const vertices) {
+        i64 const size = vertices.size() * static_cast<i64>(sizeof(math::Vec3));
+        Entry entry{key, static_cast<u32>(Baked_Geometry_Kind::triangle_list), Vertex_Layout{}, 0, Position_Dequantization{}, vertices.size(), 0,
+                    Array<u8>(size)};
+        copy_bytes(entry.data.data(), vertices.data(), size);
+        add(ANTON_MOV(entry));
+    }
+
+    void Baked_Geometry_Writer::add_indexed(Geometry_Key const& key, Indexed_Geometry const& geometry) {
+        i64 const vertices_size = geometry.vertices.size() * static_cast<i64>(sizeof(math::Vec3));
+        i64 const indices_size = geometry.indices.size() * static_cast<i64>(sizeof(u32));
+        Entry entry{key,
+                    static_cast<u32>(Baked_Geometry_Kind::indexed),
+                    Vertex_Layout{},
+                    0,
+                    Position_Dequantization{},
+                    geometry.vertices.size(),
+                    geometry.indices.size(),
+                    Array<u8>(vertices_size + indices_size)};
+        copy_bytes(entry.data.data(), geometry.vertices.data(), vertices_size);
+        copy_bytes(entry.data.data() + vertices_size, geometry.indices.data(), indices_size);
+        add(ANTON_MOV(entry));
+    }
+
+    void Baked_Geometry_Writer::add_interleaved(Geometry_Key const& key, Vertex_Layout const& layout, u32 const handle_id,
+                                                Position_Dequantization const& dequantization, Slice<u8 const> const vertices) {
+        if(layout.stride <= 0) {
+            return;
+        }
+
+        Entry entry{key, static_cast<u32>(Baked_Geometry_Kind::interleaved), layout, handle_id, dequantization, vertices.size() / layout.stride, 0,
+                    Array<u8>(vertices.size())};
+        copy_bytes(entry.data.data(), vertices.data(), vertices.size());
+        add(ANTON_MOV(entry));
+    }
+
+    void Baked_Geometry_Writer::add(Entry&& entry) {
+        for(Entry& existing: entries) {
+            if(existing.key == entry.key && existing.kind == entry.kind && existing.handle_id == entry.handle_id &&
+               compare_layouts(existing.layout, entry.layout)) {
+                existing = ANTON_MOV(entry);
+                return;
+            }
+        }
+        entries.emplace_back(ANTON_MOV(entry));
+    }
+
+    Array<u8> Baked_Geometry_Writer::serialize() const {
+        i64 const table_size = entries.size() * static_cast<i64>(sizeof(Baked_Geometry_Entry));
+        i64 const data_offset = align_up(static_cast<i64>(sizeof(Baked_Geometry_Header)) + table_size);
+        i64 file_size = data_offset;
+        for(Entry const& entry: entries) {
+            file_size = align_up(file_size + entry.data.size());
+        }
+
+        Array<u8> file(file_size);
+        for(u8& byte: file) {
+            byte = 0;
+        }
+
+        Baked_Geometry_Header const header{baked_geometry_magic, baked_geometry_format_version, baked_geometry_generator_version,
+                                           static_cast<u32>(entries.size()), static_cast<u64>(file_size), 0};
+        copy_bytes(file.data(), &header, sizeof(Baked_Geometry_Header));
+        i64 offset = data_offset;
+        for(i64 i = 0; i < entries.size(); ++i) {
+            Entry const& entry = entries[i];
+            Vertex_Layout const& layout = entry.layout;
+            i64 const vertices_size = entry.data.size() - entry.index_count * static_cast<i64>(sizeof(u32));
+            Baked_Geometry_Entry const baked{entry.key,
+                                             hash_geometry_key(entry.key),
+                                             entry.kind,
+                                             entry.handle_id,
+                                             static_cast<u32>(layout.stride),
+                                             static_cast<u32>(layout.position_format),
+                                             static_cast<u32>(layout.position_offset),
+                                             static_cast<u32>(layout.normal_format),
+                                             static_cast<u32>(layout.normal_offset),
+                                             static_cast<u32>(layout.handle_id_format),
+                                             static_cast<u32>(layout.handle_id_offset),
+                                             0,
+                                             {entry.dequantization.scale.x, entry.dequantization.scale.y, entry.dequantization.scale.z},
+                                             {entry.dequantization.bias.x, entry.dequantization.bias.y, entry.dequantization.bias.z},
+                                             static_cast<u64>(offset),
+                                             static_cast<u64>(entry.vertex_count),
+                                             static_cast<u64>(offset + vertices_size),
+                                             static_cast<u64>(entry.index_count)};
+            copy_bytes(file.data() + sizeof(Baked_Geometry_Header) + i * sizeof(Baked_Geometry_Entry), &baked, sizeof(Baked_Geometry_Entry));
+            copy_bytes(file.data() + offset, entry.data.data(), entry.data.size());
+            offset = align_up(offset + entry.data.size());
+        }
+        return file;
+    }
+
+    bool Baked_Geometry_Writer::write(char const* const path) const {
+        Array<u8> const file = serialize();
+        FILE* const handle = fopen(path, "wb");
+        if(!handle) {
+            return false;
+        }
+
+        bool const written = fwrite(file.data(), 1, static_cast<size_t>(file.size()), handle) == static_cast<size_t>(file.size());
+        bool const closed = fclose(handle) == 0;
+        return written && closed;
+    }
+
+    [[nodiscard]] static Baked_Geometry_Header const& get_header(u8 const* const data) {
+        return *reinterpret_cast<Baked_Geometry_Header const*>(data);
+    }
+
+    [[nodiscard]] static Slice<Baked_Geometry_Entry const> get_entries(u8 const* const data) {
+        Baked_Geometry_Entry const* const first = reinterpret_cast<Baked_Geometry_Entry const*>(data + sizeof(Baked_Geometry_Header));
+        return Slice<Baked_Geometry_Entry const>{first, first + get_header(data).entry_count};
+    }
+
+    // Checks whether the range [offset, offset + count * element_size) is aligned and lies within the file.
+    [[nodiscard]] static bool validate_range(u64 const offset, u64 const count, u64 const element_size, u64 const file_size) {
+        if(offset % baked_geometry_alignment != 0 && count > 0) {
+            return false;
+        }
+
+        if(offset > file_size) {
+            return false;
+        }
+
+        return count <= (file_size - offset) / element_size;
+    }
+
+    // Checks whether every index refers to one of the vertices of the entry.
+    [[nodiscard]] static bool validate_indices(u8 const* const data, Baked_Geometry_Entry const& entry) {
+        u32 const* const indices = reinterpret_cast<u32 const*>(data + entry.index_offset);
+        for(u64 i = 0; i < entry.index_count; ++i) {
+            if(indices[i] >= entry.vertex_count) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Checks whether an attribute of the given size at offset lies within a vertex of size stride.
+    [[nodiscard]] static bool validate_attribute(u64 const offset, i64 const size, u64 const stride) {
+        return size == 0 || offset + static_cast<u64>(size) <= stride;
+    }
+
+    [[nodiscard]] static bool validate_entry(u8 const* const data, Baked_Geometry_Entry const& entry, u64 const file_size) {
+        switch(static_cast<Baked_Geometry_Kind>(entry.kind)) {
+            case Baked_Geometry_Kind::triangle_list:
+                return validate_range(entry.vertex_offset, entry.vertex_count, sizeof(math::Vec3), file_size) && entry.index_count == 0;
+
+            case Baked_Geometry_Kind::indexed:
+                // The indices directly follow the vertices and do not have to be aligned to more than 4 bytes.
+                return validate_range(entry.vertex_offset, entry.vertex_count, sizeof(math::Vec3), file_size) &&
+                       entry.index_offset == entry.vertex_offset + entry.vertex_count * sizeof(math::Vec3) &&
+                       entry.index_count <= (file_size - entry.index_offset) / sizeof(u32) && validate_indices(data, entry);
+
+            case Baked_Geometry_Kind::interleaved: {
+                if(entry.stride == 0 || !validate_range(entry.vertex_offset, entry.vertex_count, entry.stride, file_size) || entry.index_count != 0 ||
+                   entry.position_format > static_cast<u32>(Position_Format::snorm10x3_2) ||
+                   entry.normal_format > static_cast<u32>(Normal_Format::snorm16x4) || entry.handle_id_format > static_cast<u32>(Handle_ID_Format::u32)) {
+                    return false;
+                }
+
+                Vertex_Layout const layout = get_layout(entry);
+                return validate_attribute(entry.position_offset, get_size(layout.position_format), entry.stride) &&
+                       validate_attribute(entry.normal_offset, get_size(layout.normal_format), entry.stride) &&
+                       validate_attribute(entry.handle_id_offset, get_size(layout.handle_id_format), entry.stride);
+            }
+
+            default:
+                return false;
+        }
+    }
+
+    [[nodiscard]] static bool validate_file(Slice<u8 const> const data) {
+        u64 const size = static_cast<u64>(data.size());
+        if(size < sizeof(Baked_Geometry_Header) || reinterpret_cast<u64>(data.data()) % baked_geometry_alignment != 0) {
+            return false;
+        }
+
+        Baked_Geometry_Header const& header = get_header(data.data());
+        if(header.magic != baked_geometry_magic || header.format_version != baked_geometry_format_version ||
+           header.generator_version != baked_geometry_generator_version || header.file_size != size) {
+            return false;
+        }
+
+        if(header.entry_count > (size - sizeof(Baked_Geometry_Header)) / sizeof(Baked_Geometry_Entry)) {
+            return false;
+        }
+
+        for(Baked_Geometry_Entry const& entry: get_entries(data.data())) {
+            if(!validate_entry(data.data(), entry, size)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    Baked_Geometry_File::~Baked_Geometry_File() {
+        close();
+    }
+
+    bool Baked_Geometry_File::open(char const* const path) {
+        close();
+#if defined(_WIN32)
+        HANDLE const file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if(file == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+
+        LARGE_INTEGER file_size;
+        if(!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+            CloseHandle(file);
+            return false;
+        }
+
+        HANDLE const file_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if(!file_mapping) {
+            return false;
+        }
+
+        void* const view = MapViewOfFile(file_mapping, FILE_MAP_READ, 0, 0, 0);
+        // The view keeps the mapping alive.
+        CloseHandle(file_mapping);
+        if(!view) {
+            return false;
+        }
+
+        mapping = view;
+        mapping_size = file_size.QuadPart;
+#else
+        int const file = ::open(path, O_RDONLY);
+        if(file == -1) {
+            return false;
+        }
+
+        struct stat file_status;
+        if(fstat(file, &file_status) != 0 || file_status.st_size == 0) {
+            ::close(file);
+            return false;
+        }
+
+        void* const view = mmap(nullptr, static_cast<size_t>(file_status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+        // The mapping keeps the file alive.
+        ::close(file);
+        if(view == MAP_FAILED) {
+            return false;
+        }
+
+        mapping = view;
+        mapping_size = file_status.st_size;
+#endif
+
+        Slice<u8 const> const contents{static_cast<u8 const*>(mapping), static_cast<u8 const*>(mapping) + mapping_size};
+        if(!validate_file(contents)) {
+            close();
+            return false;
+        }
+
+        data = contents.data();
+        size = contents.size();
+        return true;
+    }
+
+    bool Baked_Geometry_File::load(Slice<u8 const> const contents) {
+        close();
+        if(!validate_file(contents)) {
+            return false;
+        }
+
+        data = contents.data();
+        size = contents.size();
+        return true;
+    }
+
+    void Baked_Geometry_File::close() {
+        if(mapping) {
+#if defined(_WIN32)
+            UnmapViewOfFile(mapping);
+#else
+            munmap(mapping, static_cast<size_t>(mapping_size));
+#endif
+        }
+
+        mapping = nullptr;
+        mapping_size = 0;
+        data = nullptr;
+        size = 0;
+    }
+
+    bool Baked_Geometry_File::is_open() const {
+        return data != nullptr;
+    }
+
+    [[nodiscard]] static Baked_Geometry_Entry const* find_entry(u8 const* const data, Geometry_Key const& key, Baked_Geometry_Kind const kind,
+                                                              Vertex_Layout const* const layout, u32 const handle_id) {
+        if(!data) {
+            return nullptr;
+        }
+
+        u64 const hash = hash_geometry_key(key);
+        for(Baked_Geometry_Entry const& entry: get_entries(data)) {
+            if(entry.hash != hash || entry.kind != static_cast<u32>(kind) || entry.key != key) {
+                continue;
+            }
+
+            if(layout && (!compare_layouts(get_layout(entry), *layout) || entry.handle_id != handle_id)) {
+                continue;
+            }
+
+            return &entry;
+        }
+        return nullptr;
+    }
+
+    template<typename T>
+    [[nodiscard]] static Slice<T const> get_slice(u8 const* const data, u64 const offset, u64 const count) {
+        T const* const first = reinterpret_cast<T const*>(data + offset);
+        return Slice<T const>{first, first + count};
+    }
+
+    Optional<Slice<math::Vec3 const>> Baked_Geometry_File::find_triangle_list(Geometry_Key const& key) const {
+        Baked_Geometry_Entry const* const entry = find_entry(data, key, Baked_Geometry_Kind::triangle_list, nullptr, 0);
+        if(!entry) {
+            return null_optional;
+        }
+
+        return get_slice<math::Vec3>(data, entry->vertex_offset, entry->vertex_count);
+    }
+
+    Optional<Indexed_Geometry_View> Baked_Geometry_File::find_indexed(Geometry_Key const& key) const {
+        Baked_Geometry_Entry const* const entry = find_entry(data, key, Baked_Geometry_Kind::indexed, nullptr, 0);
+        if(!entry) {
+            return null_optional;
+        }
+
+        return Indexed_Geometry_View{get_slice<math::Vec3>(data, entry->vertex_offset, entry->vertex_count),
+                                     get_slice<u32>(data, entry->index_offset, entry->index_count)};
+    }
+
+    Optional<Interleaved_Geometry_View> Baked_Geometry_File::find_interleaved(Geometry_Key const& key, Vertex_Layout const& layout,
+                                                                              u32 const handle_id) const {
+        Baked_Geometry_Entry const* const entry = find_entry(data, key, Baked_Geometry_Kind::interleaved, &layout, handle_id);
+        if(!entry) {
+            return null_optional;
+        }
+
+        Position_Dequantization const dequantization{
+            math::Vec3{entry->dequantization_scale[0], entry->dequantization_scale[1], entry->dequantization_scale[2]},
+            math::Vec3{entry->dequantization_bias[0], entry->dequantization_bias[1], entry->dequantization_bias[2]}};
+        return Interleaved_Geometry_View{get_slice<u8>(data, entry->vertex_offset, entry->vertex_count * entry->stride), layout, dequantization,
+                                         static_cast<i64>(entry->vertex_count)};
+    }
+} // namespace anton::gizmo
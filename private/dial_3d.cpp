@@ -2,48 +2,218 @@
 
 #include <intersection_tests.hpp>
 #include <utils.hpp>
+#include <vertex_output.hpp>
 
 namespace anton::gizmo {
-    Array<math::Vec3> generate_dial_3d_geometry(Dial_3D const& dial, i32 const vertex_count_major, i32 const vertex_count_minor) {
-        Array<math::Vec3> major = generate_circle(math::Vec3{0.0f}, math::Vec3{0.0f, 0.0f, -1.0f}, dial.major_radius, vertex_count_major);
-        Array<Array<math::Vec3>> torus_rings{reserve, vertex_count_major};
-        for(i64 i = 0; i < vertex_count_major; ++i) {
-            math::Vec3 const& v1 = major[i];
-            math::Vec3 const& v2 = major[(i + 1) % vertex_count_major];
-            math::Vec3 const plane_normal = math::normalize(v1 - v2);
-            Array<math::Vec3> ring = generate_circle(v2, plane_normal, dial.minor_radius, vertex_count_minor);
-            torus_rings.emplace_back(ANTON_MOV(ring));
+    // The dial is a torus around the z axis. Ring i lies at the angle theta_i = i * 2pi / vertex_count_major around the axis
+    // and vertex j of a ring at the angle phi_j = j * 2pi / vertex_count_minor around the major circle. The vertex is
+    //   (rho_j * cos(theta_i), -rho_j * sin(theta_i), z_j)
+    // where rho_j = major_radius + minor_radius * cos(phi_j) is its distance from the axis and z_j = -minor_radius * sin(phi_j).
+    // Both circles are traversed clockwise when looking in the direction of their normal, which makes the triangles CCW
+    // when looking at the dial from outside.
+
+    struct Torus_Profile_Point {
+        f32 rho;
+        f32 z;
+    };
+
+    [[nodiscard]] static Torus_Profile_Point calculate_torus_profile_point(Dial_3D const& dial, Sin_Cos const phi) {
+        return {dial.major_radius + dial.minor_radius * phi.cos, -dial.minor_radius * phi.sin};
+    }
+
+    [[nodiscard]] static math::Vec3 calculate_torus_point(Sin_Cos const theta, Torus_Profile_Point const p) {
+        return {p.rho * theta.cos, -p.rho * theta.sin, p.z};
+    }
+
+    // Quad j of row i spans the vertices j and j + 1 of the rings i and i + 1.
+    template<typename Output>
+    static void write_torus_quad(Output& output, Sin_Cos const theta_a, Sin_Cos const theta_b, Torus_Profile_Point const p1, Torus_Profile_Point const p2) {
+        math::Vec3 const r1_v1 = calculate_torus_point(theta_a, p1);
+        math::Vec3 const r1_v2 = calculate_torus_point(theta_a, p2);
+        math::Vec3 const r2_v1 = calculate_torus_point(theta_b, p1);
+        math::Vec3 const r2_v2 = calculate_torus_point(theta_b, p2);
+        // 1st triangle
+        output.write(r2_v1);
+        output.write(r2_v2);
+        output.write(r1_v2);
+        // 2nd triangle
+        output.write(r1_v1);
+        output.write(r2_v1);
+        output.write(r1_v2);
+    }
+
+    // The number of profile points that generate_torus_triangle_list evaluates only once.
+    static constexpr i64 torus_profile_capacity = 256;
+
+    template<typename Output>
+    static void generate_torus_triangle_list(Dial_3D const& dial, i32 const vertex_count_major, i32 const vertex_count_minor, Output& output) {
+        // The profile is the same for every row. If it fits in profile, it is evaluated once. Otherwise it is evaluated
+        // anew for every row from a copy of the same generator, which yields the exact same values.
+        Sin_Cos_Generator const minor_first{vertex_count_minor};
+        Torus_Profile_Point profile[torus_profile_capacity];
+        bool const cached = vertex_count_minor <= torus_profile_capacity;
+        if(cached) {
+            Sin_Cos_Generator minor = minor_first;
+            for(i64 j = 0; j < vertex_count_minor; ++j) {
+                profile[j] = calculate_torus_profile_point(dial, minor.next());
+            }
         }
 
-        Array<math::Vec3> vertices;
+        // theta_0 = 0 exactly, so that the last row closes the torus with the exact vertices of ring 0.
+        Sin_Cos const theta_first{0.0f, 1.0f};
+        Sin_Cos_Generator major{vertex_count_major, 1};
+        Sin_Cos theta_a = theta_first;
         for(i64 i = 0; i < vertex_count_major; ++i) {
-            Array<math::Vec3> const& r1 = torus_rings[i];
-            Array<math::Vec3> const& r2 = torus_rings[(i + 1) % vertex_count_major];
+            Sin_Cos const theta_b = i + 1 < vertex_count_major ? major.next() : theta_first;
+            if(cached) {
+                for(i64 j = 0; j < vertex_count_minor; ++j) {
+                    Torus_Profile_Point const p2 = profile[j + 1 < vertex_count_minor ? j + 1 : 0];
+                    write_torus_quad(output, theta_a, theta_b, profile[j], p2);
+                }
+            } else {
+                Sin_Cos_Generator minor = minor_first;
+                Torus_Profile_Point const profile_first = calculate_torus_profile_point(dial, minor.next());
+                Torus_Profile_Point p1 = profile_first;
+                for(i64 j = 0; j < vertex_count_minor; ++j) {
+                    Torus_Profile_Point const p2 = j + 1 < vertex_count_minor ? calculate_torus_profile_point(dial, minor.next()) : profile_first;
+                    write_torus_quad(output, theta_a, theta_b, p1, p2);
+                    p1 = p2;
+                }
+            }
+            theta_a = theta_b;
+        }
+    }
+
+    // Every row of quads is a strip of alternating vertices of ring i and ring i + 1 that starts and ends at vertex 0
+    // of the rings. Consecutive rows are joined by repeating the last vertex of the previous row and the first vertex
+    // of the next row. The rows have an even number of vertices, therefore the winding is preserved across the joins.
+    static void generate_torus_triangle_strip(Dial_3D const& dial, i32 const vertex_count_major, i32 const vertex_count_minor,
+                                              Slice<math::Vec3> const vertices) {
+        Sin_Cos const theta_first{0.0f, 1.0f};
+        Sin_Cos_Generator major{vertex_count_major, 1};
+        Sin_Cos theta_a = theta_first;
+        Sin_Cos theta_b = vertex_count_major > 1 ? major.next() : theta_first;
+        {
+            Sin_Cos_Generator minor{vertex_count_minor};
+            Torus_Profile_Point const profile_first = calculate_torus_profile_point(dial, minor.next());
+            Torus_Profile_Point p = profile_first;
+            for(i64 j = 0; j <= vertex_count_minor; ++j) {
+                vertices[2 * j] = calculate_torus_point(theta_a, p);
+                vertices[2 * j + 1] = calculate_torus_point(theta_b, p);
+                p = j + 1 < vertex_count_minor ? calculate_torus_profile_point(dial, minor.next()) : profile_first;
+            }
+        }
+
+        i64 const row_size = 2 * ((i64)vertex_count_minor + 1);
+        for(i64 i = 1; i < vertex_count_major; ++i) {
+            theta_a = theta_b;
+            theta_b = i + 1 < vertex_count_major ? major.next() : theta_first;
+            i64 const row = i * (row_size + 2);
+            // Degenerate triangles joining the rows
+            vertices[row - 2] = vertices[row - 3];
+            vertices[row - 1] = calculate_torus_point(theta_a, {vertices[0].x, vertices[0].z});
+            for(i64 j = 0; j <= vertex_count_minor; ++j) {
+                // Vertex j of ring 0 is the (2j)th vertex of the first row.
+                math::Vec3 const ring_0_point = vertices[2 * j];
+                Torus_Profile_Point const p{ring_0_point.x, ring_0_point.z};
+                vertices[row + 2 * j] = calculate_torus_point(theta_a, p);
+                vertices[row + 2 * j + 1] = calculate_torus_point(theta_b, p);
+            }
+        }
+    }
+
+    i64 dial_3d_vertex_count(i32 const vertex_count_major, i32 const vertex_count_minor, Primitive_Topology const topology) {
+        switch(topology) {
+            case Primitive_Topology::triangle_list:
+                return 6 * (i64)vertex_count_major * vertex_count_minor;
+
+            case Primitive_Topology::triangle_strip:
+                return 2 * (i64)vertex_count_major * (vertex_count_minor + 1) + 2 * ((i64)vertex_count_major - 1);
+        }
+    }
+
+    void generate_dial_3d_geometry(Dial_3D const& dial, i32 const vertex_count_major, i32 const vertex_count_minor, Slice<math::Vec3> const vertices,
+                                   Primitive_Topology const topology) {
+        switch(topology) {
+            case Primitive_Topology::triangle_list: {
+                Position_Output output{vertices};
+                generate_torus_triangle_list(dial, vertex_count_major, vertex_count_minor, output);
+            } break;
+
+            case Primitive_Topology::triangle_strip:
+                generate_torus_triangle_strip(dial, vertex_count_major, vertex_count_minor, vertices);
+                break;
+        }
+    }
+
+    Position_Dequantization generate_dial_3d_geometry(Dial_3D const& dial, i32 const vertex_count_major, i32 const vertex_count_minor,
+                                                      Vertex_Layout const& layout, u32 const handle_id, Slice<u8> const buffer) {
+        f32 const radius = dial.major_radius + dial.minor_radius;
+        math::Vec3 const min{-radius, -radius, -dial.minor_radius};
+        math::Vec3 const max{radius, radius, dial.minor_radius};
+        Vertex_Output output{layout, handle_id, min, max, buffer};
+        generate_torus_triangle_list(dial, vertex_count_major, vertex_count_minor, output);
+        return output.get_dequantization();
+    }
+
+    Array<math::Vec3> generate_dial_3d_geometry(Dial_3D const& dial, i32 const vertex_count_major, i32 const vertex_count_minor,
+                                                Primitive_Topology const topology) {
+        Array<math::Vec3> vertices(dial_3d_vertex_count(vertex_count_major, vertex_count_minor, topology));
+        generate_dial_3d_geometry(dial, vertex_count_major, vertex_count_minor, vertices, topology);
+        return vertices;
+    }
+
+    Indexed_Geometry generate_dial_3d_geometry_indexed(Dial_3D const& dial, i32 const vertex_count_major, i32 const vertex_count_minor) {
+        Indexed_Geometry geometry{Array<math::Vec3>{reserve, (i64)vertex_count_major * vertex_count_minor},
+                                  Array<u32>{reserve, 6 * (i64)vertex_count_major * vertex_count_minor}};
+        // Ring 0
+        Sin_Cos_Generator minor{vertex_count_minor};
+        for(i64 j = 0; j < vertex_count_minor; ++j) {
+            geometry.vertices.emplace_back(calculate_torus_point(Sin_Cos{0.0f, 1.0f}, calculate_torus_profile_point(dial, minor.next())));
+        }
+
+        Sin_Cos_Generator major{vertex_count_major, 1};
+        for(i64 i = 1; i < vertex_count_major; ++i) {
+            Sin_Cos const theta = major.next();
             for(i64 j = 0; j < vertex_count_minor; ++j) {
-                math::Vec3 const& r1_v1 = r1[j];
-                math::Vec3 const& r1_v2 = r1[(j + 1) % vertex_count_minor];
-                math::Vec3 const& r2_v1 = r2[j];
-                math::Vec3 const& r2_v2 = r2[(j + 1) % vertex_count_minor];
+                math::Vec3 const& ring_0_point = geometry.vertices[j];
+                geometry.vertices.emplace_back(calculate_torus_point(theta, Torus_Profile_Point{ring_0_point.x, ring_0_point.z}));
+            }
+        }
+
+        u32 const count_major = vertex_count_major;
+        u32 const count_minor = vertex_count_minor;
+        for(u32 i = 0; i < count_major; ++i) {
+            u32 const r1 = i * count_minor;
+            u32 const r2 = ((i + 1) % count_major) * count_minor;
+            for(u32 j = 0; j < count_minor; ++j) {
+                u32 const j1 = j;
+                u32 const j2 = (j + 1) % count_minor;
                 // 1st triangle
-                vertices.emplace_back(r2_v1);
-                vertices.emplace_back(r2_v2);
-                vertices.emplace_back(r1_v2);
+                geometry.indices.emplace_back(r2 + j1);
+                geometry.indices.emplace_back(r2 + j2);
+                geometry.indices.emplace_back(r1 + j2);
                 // 2nd triangle
-                vertices.emplace_back(r1_v1);
-                vertices.emplace_back(r2_v1);
-                vertices.emplace_back(r1_v2);
+                geometry.indices.emplace_back(r1 + j1);
+                geometry.indices.emplace_back(r2 + j1);
+                geometry.indices.emplace_back(r1 + j2);
             }
         }
-        return vertices;
+        return geometry;
     }
 
-    Optional<f32> intersect_dial_3d(math::Ray const ray, Dial_3D const& dial, math::Mat4 const& world_transform) {
-        math::Vec3 const origin{world_transform * math::Vec4{0.0f}};
-        math::Vec3 const v1{world_transform * math::Vec4{0.0f, 0.0f, -dial.minor_radius, 1.0f}};
-        math::Vec3 const v2{world_transform * math::Vec4{0.0f, 0.0f, dial.minor_radius, 1.0f}};
-        f32 const scale = math::length(v2 - v1) / (2 * dial.minor_radius);
-        f32 const r_large = scale * (dial.major_radius + dial.minor_radius);
-        f32 const r_small = scale * (dial.major_radius - dial.minor_radius);
+    Prepared_Handle prepare_dial_3d(Dial_3D const& dial, math::Mat4 const& world_transform) {
+        // The sphere through the rims of the outer cylinder.
+        f32 const outer_radius = dial.major_radius + dial.minor_radius;
+        return prepare_handle(world_transform, math::Vec3{0.0f}, math::sqrt(outer_radius * outer_radius + dial.minor_radius * dial.minor_radius));
+    }
+
+    [[nodiscard]] static Optional<f32> intersect_dial_3d_cylinders(math::Ray const ray, Dial_3D const& dial, Prepared_Handle const& handle) {
+        math::Vec3 const offset = handle.z_axis * (handle.scale * dial.minor_radius);
+        math::Vec3 const v1 = handle.origin + offset;
+        math::Vec3 const v2 = handle.origin - offset;
+        f32 const r_large = handle.scale * (dial.major_radius + dial.minor_radius);
+        f32 const r_small = handle.scale * (dial.major_radius - dial.minor_radius);
         Optional<f32> result = null_optional;
         Optional<Raycast_Hit> const large_hit = intersect_ray_cylinder(ray, v1, v2, r_large);
         if(large_hit) {
@@ -66,4 +236,67 @@ namespace anton::gizmo {
 
         return result;
     }
+
+    [[nodiscard]] static Optional<f32> intersect_dial_3d_torus(math::Ray const ray, Dial_3D const& dial, Prepared_Handle const& handle) {
+        // The quartic of intersect_ray_torus assumes a normalized direction. The distance is scaled back to the units
+        // of the direction of ray like those of the cylinder tests.
+        f32 const direction_length = math::length(ray.direction);
+        if(direction_length <= 0.0f) {
+            return null_optional;
+        }
+
+        math::Ray const normalized_ray{ray.origin, ray.direction / direction_length};
+        Optional<Raycast_Hit> const hit =
+            intersect_ray_torus(normalized_ray, handle.origin, handle.z_axis, handle.scale * dial.major_radius, handle.scale * dial.minor_radius);
+        if(hit) {
+            return hit->distance / direction_length;
+        } else {
+            return null_optional;
+        }
+    }
+
+    Optional<f32> intersect_dial_3d(math::Ray const ray, Dial_3D const& dial, Prepared_Handle const& handle) {
+        switch(dial.bounds) {
+            case Dial_3D_Bounds::torus:
+                return intersect_dial_3d_torus(ray, dial, handle);
+            case Dial_3D_Bounds::cylinders:
+                return intersect_dial_3d_cylinders(ray, dial, handle);
+        }
+    }
+
+    Ray_Packet_Hits intersect_dial_3d(Ray_Packet const& packet, Dial_3D const& dial, Prepared_Handle const& handle) {
+        if(dial.bounds == Dial_3D_Bounds::torus) {
+            // The quartic is solved one ray at a time.
+            return intersect_ray_packet_serial(packet, [&dial, &handle](math::Ray const& ray) {
+                Optional<f32> const hit = intersect_dial_3d_torus(ray, dial, handle);
+                return hit ? *hit : math::infinity;
+            });
+        }
+
+        simd::Float3 const axis = broadcast_vec3(handle.z_axis);
+        // The cylinders extend from v1 = origin + axis * minor towards -axis.
+        simd::Float3 const v1 = broadcast_vec3(handle.origin + handle.z_axis * (handle.scale * dial.minor_radius));
+        simd::Float3 const cylinder_axis = -axis;
+        simd::Float const height = simd::broadcast(2.0f * handle.scale * dial.minor_radius);
+        f32 const r_small = handle.scale * (dial.major_radius - dial.minor_radius);
+        simd::Float const large_radius = simd::broadcast(handle.scale * (dial.major_radius + dial.minor_radius));
+        simd::Float const small_radius = simd::broadcast(r_small);
+        simd::Float const infinity = simd::broadcast(math::infinity);
+        bool const has_cutout = !math::is_almost_zero(r_small, 0.001f);
+        return intersect_ray_packet(packet, [&](simd::Float3 const& ray_origin, simd::Float3 const& ray_direction) {
+            simd::Float3 const offset = ray_origin - v1;
+            simd::Float result = intersect_ray_capped_cylinder(offset, ray_direction, cylinder_axis, large_radius, height);
+            if(has_cutout) {
+                // Rays that hit the cutout no farther than the larger cylinder miss. Rays that miss both remain at infinity.
+                simd::Float const cutout = intersect_ray_capped_cylinder(offset, ray_direction, cylinder_axis, small_radius, height);
+                result = simd::select(cutout <= result, infinity, result);
+                result = simd::min(result, solve_ray_quadric(setup_ray_cylinder(offset, ray_direction, cylinder_axis, small_radius, height)));
+            }
+            return result;
+        });
+    }
+
+    Optional<f32> intersect_dial_3d(math::Ray const ray, Dial_3D const& dial, math::Mat4 const& world_transform) {
+        return intersect_dial_3d(ray, dial, prepare_dial_3d(dial, world_transform));
+    }
 } // namespace anton::gizmo
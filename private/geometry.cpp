@@ -0,0 +1,26 @@
+#include <anton/gizmo/geometry.hpp>
+
+#include <vertex_output.hpp>
+
+namespace anton::gizmo {
+    Vertex_Layout make_vertex_layout(Position_Format const position_format, Normal_Format const normal_format, Handle_ID_Format const handle_id_format) {
+        Vertex_Layout layout;
+        layout.position_format = position_format;
+        layout.position_offset = 0;
+        layout.normal_format = normal_format;
+        layout.normal_offset = layout.position_offset + get_size(position_format);
+        layout.handle_id_format = handle_id_format;
+        layout.handle_id_offset = layout.normal_offset + get_size(normal_format);
+        i64 const size = layout.handle_id_offset + get_size(handle_id_format);
+        layout.stride = (size + 3) & ~(i64)3;
+        return layout;
+    }
+
+    Array<u16> narrow_indices_u16(Indexed_Geometry const& geometry) {
+        Array<u16> indices{reserve, geometry.indices.size()};
+        for(u32 const index: geometry.indices) {
+            indices.emplace_back(static_cast<u16>(index));
+        }
+        return indices;
+    }
+} // namespace anton::gizmo
@@ -0,0 +1,226 @@
+#include <anton/gizmo/geometry_cache.hpp>
+
+#include <anton/gizmo/shapes.hpp>
+#include <anton/utility.hpp>
+
+namespace anton::gizmo {
+    struct Geometry_Cache_Entry {
+        // Either points to storage or to baked geometry.
+        Slice<math::Vec3 const> vertices;
+        // Empty for baked geometry.
+        Array<math::Vec3> storage;
+        // The number of Shared_Geometry handles plus 1 while the entry is held by the cache.
+        i64 reference_count;
+    };
+
+    static void acquire(Geometry_Cache_Entry* const entry) {
+        if(entry) {
+            entry->reference_count += 1;
+        }
+    }
+
+    static void release(Geometry_Cache_Entry* const entry) {
+        if(entry) {
+            entry->reference_count -= 1;
+            if(entry->reference_count == 0) {
+                delete entry;
+            }
+        }
+    }
+
+    Shared_Geometry::Shared_Geometry(Geometry_Cache_Entry* const entry): entry(entry) {
+        acquire(entry);
+    }
+
+    Shared_Geometry::Shared_Geometry(Shared_Geometry const& other): entry(other.entry) {
+        acquire(entry);
+    }
+
+    Shared_Geometry::Shared_Geometry(Shared_Geometry&& other): entry(other.entry) {
+        other.entry = nullptr;
+    }
+
+    Shared_Geometry& Shared_Geometry::operator=(Shared_Geometry const& other) {
+        acquire(other.entry);
+        release(entry);
+        entry = other.entry;
+        return *this;
+    }
+
+    Shared_Geometry& Shared_Geometry::operator=(Shared_Geometry&& other) {
+        if(this != &other) {
+            release(entry);
+            entry = other.entry;
+            other.entry = nullptr;
+        }
+        return *this;
+    }
+
+    Shared_Geometry::~Shared_Geometry() {
+        release(entry);
+    }
+
+    Slice<math::Vec3 const> Shared_Geometry::get_vertices() const {
+        if(entry) {
+            return entry->vertices;
+        } else {
+            return Slice<math::Vec3 const>{};
+        }
+    }
+
+    Shared_Geometry::operator bool() const {
+        return entry != nullptr;
+    }
+
+    [[nodiscard]] static Geometry_Cache_Entry* create_entry(Array<math::Vec3>&& vertices) {
+        Geometry_Cache_Entry* const entry = new Geometry_Cache_Entry{Slice<math::Vec3 const>{}, ANTON_MOV(vertices), 1};
+        math::Vec3 const* const data = entry->storage.data();
+        entry->vertices = Slice<math::Vec3 const>{data, data + entry->storage.size()};
+        return entry;
+    }
+
+    [[nodiscard]] static i64 calculate_memory_usage(Geometry_Cache_Entry const* const entry) {
+        return entry->storage.size() * static_cast<i64>(sizeof(math::Vec3));
+    }
+
+    Geometry_Cache::Geometry_Cache(i64 const memory_budget): memory_budget(memory_budget) {}
+
+    Geometry_Cache::~Geometry_Cache() {
+        clear();
+    }
+
+    Shared_Geometry Geometry_Cache::get_arrow_3d(Arrow_3D const& arrow, i32 const vertex_count) {
+        Geometry_Key const key = make_arrow_3d_key(arrow, vertex_count);
+        u64 const hash = hash_geometry_key(key);
+        if(Entry* const entry = find(key, hash)) {
+            return Shared_Geometry{entry->geometry};
+        }
+
+        if(Geometry_Cache_Entry* const baked = load_baked(key)) {
+            return insert(key, hash, baked);
+        }
+
+        return insert(key, hash, create_entry(generate_arrow_3d_geometry(arrow, vertex_count)));
+    }
+
+    Shared_Geometry Geometry_Cache::get_dial_3d(Dial_3D const& dial, i32 const vertex_count_major, i32 const vertex_count_minor,
+                                                Primitive_Topology const topology) {
+        Geometry_Key const key = make_dial_3d_key(dial, vertex_count_major, vertex_count_minor, topology);
+        u64 const hash = hash_geometry_key(key);
+        if(Entry* const entry = find(key, hash)) {
+            return Shared_Geometry{entry->geometry};
+        }
+
+        if(Geometry_Cache_Entry* const baked = load_baked(key)) {
+            return insert(key, hash, baked);
+        }
+
+        return insert(key, hash, create_entry(generate_dial_3d_geometry(dial, vertex_count_major, vertex_count_minor, topology)));
+    }
+
+    Shared_Geometry Geometry_Cache::get_icosphere(i64 const level) {
+        Geometry_Key const key = make_icosphere_key(level);
+        u64 const hash = hash_geometry_key(key);
+        if(Entry* const entry = find(key, hash)) {
+            return Shared_Geometry{entry->geometry};
+        }
+
+        if(Geometry_Cache_Entry* const baked = load_baked(key)) {
+            return insert(key, hash, baked);
+        }
+
+        return insert(key, hash, create_entry(generate_icosphere(level)));
+    }
+
+    void Geometry_Cache::set_baked_geometry(Baked_Geometry_File const* const file) {
+        baked_geometry = file;
+    }
+
+    void Geometry_Cache::set_memory_budget(i64 const new_memory_budget) {
+        memory_budget = new_memory_budget;
+        evict();
+    }
+
+    void Geometry_Cache::clear() {
+        for(Entry& entry: entries) {
+            release(entry.geometry);
+        }
+        entries.clear();
+        memory_usage = 0;
+    }
+
+    Geometry_Cache_Statistics Geometry_Cache::get_statistics() const {
+        return {hits, misses, baked_loads, evictions, entries.size(), memory_usage};
+    }
+
+    void Geometry_Cache::reset_statistics() {
+        hits = 0;
+        misses = 0;
+        baked_loads = 0;
+        evictions = 0;
+    }
+
+    Geometry_Cache::Entry* Geometry_Cache::find(Geometry_Key const& key, u64 const hash) {
+        // The cache holds a handful of entries, therefore a linear scan over the hashes is sufficient.
+        for(Entry& entry: entries) {
+            if(entry.hash == hash && entry.key == key) {
+                use_counter += 1;
+                entry.last_use = use_counter;
+                hits += 1;
+                return &entry;
+            }
+        }
+
+        misses += 1;
+        return nullptr;
+    }
+
+    Geometry_Cache_Entry* Geometry_Cache::load_baked(Geometry_Key const& key) {
+        if(!baked_geometry) {
+            return nullptr;
+        }
+
+        Optional<Slice<math::Vec3 const>> const vertices = baked_geometry->find_triangle_list(key);
+        if(!vertices) {
+            return nullptr;
+        }
+
+        baked_loads += 1;
+        return new Geometry_Cache_Entry{*vertices, Array<math::Vec3>{}, 1};
+    }
+
+    Shared_Geometry Geometry_Cache::insert(Geometry_Key const& key, u64 const hash, Geometry_Cache_Entry* const geometry) {
+        use_counter += 1;
+        entries.emplace_back(Entry{key, hash, use_counter, geometry});
+        memory_usage += calculate_memory_usage(geometry);
+        Shared_Geometry handle{geometry};
+        evict();
+        return handle;
+    }
+
+    void Geometry_Cache::evict() {
+        while(memory_usage > memory_budget && entries.size() > 1) {
+            // Find the least recently used entry. The most recently used one has the largest last_use and is never chosen
+            // because there are at least 2 entries.
+            i64 oldest = 0;
+            for(i64 i = 1; i < entries.size(); ++i) {
+                if(entries[i].last_use < entries[oldest].last_use) {
+                    oldest = i;
+                }
+            }
+
+            remove(oldest);
+            evictions += 1;
+        }
+    }
+
+    void Geometry_Cache::remove(i64 const index) {
+        Entry const entry = entries[index];
+        memory_usage -= calculate_memory_usage(entry.geometry);
+        release(entry.geometry);
+        if(index != entries.size() - 1) {
+            entries[index] = entries[entries.size() - 1];
+        }
+        entries.pop_back();
+    }
+} // namespace anton::gizmo
@@ -0,0 +1,49 @@
+#include <anton/gizmo/geometry_key.hpp>
+
+#include <utils.hpp>
+
+namespace anton::gizmo {
+    enum class Geometry_Kind : u32 {
+        arrow_3d,
+        dial_3d,
+        icosphere,
+    };
+
+    Geometry_Key make_arrow_3d_key(Arrow_3D const& arrow, i32 const vertex_count) {
+        return {{static_cast<u32>(Geometry_Kind::arrow_3d), static_cast<u32>(arrow.draw_style), float_bits(arrow.cap_size), float_bits(arrow.cap_length),
+                 float_bits(arrow.shaft_length), float_bits(arrow.shaft_diameter), static_cast<u32>(vertex_count), 0}};
+    }
+
+    Geometry_Key make_dial_3d_key(Dial_3D const& dial, i32 const vertex_count_major, i32 const vertex_count_minor, Primitive_Topology const topology) {
+        return {{static_cast<u32>(Geometry_Kind::dial_3d), static_cast<u32>(topology), float_bits(dial.major_radius), float_bits(dial.minor_radius),
+                 static_cast<u32>(vertex_count_major), static_cast<u32>(vertex_count_minor), 0, 0}};
+    }
+
+    Geometry_Key make_icosphere_key(i64 const subdivision_level) {
+        return {{static_cast<u32>(Geometry_Kind::icosphere), static_cast<u32>(subdivision_level), static_cast<u32>(subdivision_level >> 32), 0, 0, 0, 0, 0}};
+    }
+
+    u64 hash_geometry_key(Geometry_Key const& key) {
+        u64 hash = 14695981039346656037ULL;
+        for(u32 const word: key.words) {
+            for(i32 byte = 0; byte < 4; ++byte) {
+                hash ^= (word >> (8 * byte)) & 0xFF;
+                hash *= 1099511628211ULL;
+            }
+        }
+        return hash;
+    }
+
+    bool operator==(Geometry_Key const& lhs, Geometry_Key const& rhs) {
+        for(i32 i = 0; i < 8; ++i) {
+            if(lhs.words[i] != rhs.words[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool operator!=(Geometry_Key const& lhs, Geometry_Key const& rhs) {
+        return !(lhs == rhs);
+    }
+} // namespace anton::gizmo
@@ -0,0 +1,117 @@
+#include <anton/gizmo/gizmo_builder.hpp>
+
+#include <anton/gizmo/shapes.hpp>
+#include <utils.hpp>
+#include <vertex_output.hpp>
+
+namespace anton::gizmo {
+    static void transform_vertices(Slice<math::Vec3> const vertices, i32 const axis, f32 const scale, math::Vec3 const& offset) {
+        for(math::Vec3& vertex: vertices) {
+            vertex = rotate_towards_axis(axis, vertex * scale) + offset;
+        }
+    }
+
+    [[nodiscard]] static Gizmo_Handle get_axis_handle(i32 const axis) {
+        return static_cast<Gizmo_Handle>(static_cast<u32>(Gizmo_Handle::axis_x) + axis);
+    }
+
+    [[nodiscard]] static Gizmo_Handle get_plane_handle(i32 const axis) {
+        return static_cast<Gizmo_Handle>(static_cast<u32>(Gizmo_Handle::plane_yz) + axis);
+    }
+
+    Gizmo_Builder::Gizmo_Builder(Vertex_Layout const& layout): layout(layout) {}
+
+    Slice<math::Vec3> Gizmo_Builder::begin_handle(Gizmo_Handle const handle, i64 const vertex_count) {
+        i64 const first_vertex = positions.size();
+        positions.resize(first_vertex + vertex_count);
+        draw_ranges.emplace_back(Gizmo_Draw_Range{handle, 0, first_vertex, vertex_count});
+        math::Vec3* const first = positions.data() + first_vertex;
+        return Slice<math::Vec3>{first, first + vertex_count};
+    }
+
+    Gizmo_Geometry Gizmo_Builder::finish(u32 const base_handle_id) {
+        // All handles are quantized within the bounding box of the whole gizmo so that they share the dequantization.
+        math::Vec3 min{0.0f};
+        math::Vec3 max{0.0f};
+        for(math::Vec3 const& position: positions) {
+            for(i32 i = 0; i < 3; ++i) {
+                min[i] = math::min(min[i], position[i]);
+                max[i] = math::max(max[i], position[i]);
+            }
+        }
+
+        i64 const vertex_count = positions.size();
+        Gizmo_Geometry geometry{Array<u8>(vertex_count * layout.stride), layout, calculate_position_dequantization(layout.position_format, min, max),
+                                vertex_count, Array<Gizmo_Draw_Range>{reserve, draw_ranges.size()}};
+        for(Gizmo_Draw_Range range: draw_ranges) {
+            range.handle_id = base_handle_id + static_cast<u32>(range.handle);
+            u8* const first_byte = geometry.vertices.data() + range.first_vertex * layout.stride;
+            Vertex_Output output{layout, range.handle_id, min, max, Slice<u8>{first_byte, first_byte + range.vertex_count * layout.stride}};
+            for(i64 i = 0; i < range.vertex_count; ++i) {
+                output.write(positions[range.first_vertex + i]);
+            }
+            geometry.draw_ranges.emplace_back(range);
+        }
+
+        positions.clear();
+        draw_ranges.clear();
+        return geometry;
+    }
+
+    Gizmo_Geometry Gizmo_Builder::build_translate(Translate_Gizmo const& gizmo, u32 const base_handle_id) {
+        i64 const arrow_vertex_count = arrow_3d_vertex_count(gizmo.arrow, gizmo.arrow_vertex_count);
+        for(i32 axis = 0; axis < 3; ++axis) {
+            Slice<math::Vec3> const vertices = begin_handle(get_axis_handle(axis), arrow_vertex_count);
+            generate_arrow_3d_geometry(gizmo.arrow, gizmo.arrow_vertex_count, vertices);
+            transform_vertices(vertices, axis, 1.0f, math::Vec3{0.0f});
+        }
+
+        for(i32 axis = 0; axis < 3; ++axis) {
+            // The plane is spanned by the 2 axes other than its normal.
+            math::Vec3 offset{gizmo.plane_offset};
+            offset[axis] = 0.0f;
+            Slice<math::Vec3> const vertices = begin_handle(get_plane_handle(axis), square_vertex_count());
+            generate_square(vertices);
+            transform_vertices(vertices, axis, gizmo.plane_size, offset);
+        }
+
+        Slice<math::Vec3> const center = begin_handle(Gizmo_Handle::center, cube_vertex_count());
+        generate_cube(center);
+        for(math::Vec3& vertex: center) {
+            vertex *= gizmo.center_size;
+        }
+        return finish(base_handle_id);
+    }
+
+    Gizmo_Geometry Gizmo_Builder::build_rotate(Rotate_Gizmo const& gizmo, u32 const base_handle_id) {
+        i64 const dial_vertex_count = dial_3d_vertex_count(gizmo.dial_vertex_count_major, gizmo.dial_vertex_count_minor);
+        for(i32 axis = 0; axis < 3; ++axis) {
+            Slice<math::Vec3> const vertices = begin_handle(get_axis_handle(axis), dial_vertex_count);
+            generate_dial_3d_geometry(gizmo.dial, gizmo.dial_vertex_count_major, gizmo.dial_vertex_count_minor, vertices);
+            transform_vertices(vertices, axis, 1.0f, math::Vec3{0.0f});
+        }
+
+        Slice<math::Vec3> const trackball = begin_handle(Gizmo_Handle::center, icosphere_vertex_count(gizmo.trackball_subdivision_level));
+        generate_icosphere(gizmo.trackball_subdivision_level, trackball);
+        for(math::Vec3& vertex: trackball) {
+            vertex *= gizmo.trackball_radius;
+        }
+        return finish(base_handle_id);
+    }
+
+    Gizmo_Geometry Gizmo_Builder::build_scale(Scale_Gizmo const& gizmo, u32 const base_handle_id) {
+        i64 const arrow_vertex_count = arrow_3d_vertex_count(gizmo.arrow, gizmo.arrow_vertex_count);
+        for(i32 axis = 0; axis < 3; ++axis) {
+            Slice<math::Vec3> const vertices = begin_handle(get_axis_handle(axis), arrow_vertex_count);
+            generate_arrow_3d_geometry(gizmo.arrow, gizmo.arrow_vertex_count, vertices);
+            transform_vertices(vertices, axis, 1.0f, math::Vec3{0.0f});
+        }
+
+        Slice<math::Vec3> const center = begin_handle(Gizmo_Handle::center, cube_vertex_count());
+        generate_cube(center);
+        for(math::Vec3& vertex: center) {
+            vertex *= gizmo.center_size;
+        }
+        return finish(base_handle_id);
+    }
+} // namespace anton::gizmo
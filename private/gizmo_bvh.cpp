@@ -0,0 +1,220 @@
+#include <anton/gizmo/gizmo_bvh.hpp>
+
+#include <anton/math/math.hpp>
+
+#include <intersection_tests.hpp>
+
+namespace anton::gizmo {
+    // The maximum number of gizmos in a leaf.
+    constexpr i64 max_leaf_size = 4;
+    // Nodes are split at the median, hence the depth of the hierarchy is at most log2(gizmo count).
+    constexpr i64 max_traversal_stack_size = 64;
+
+    // select_nth
+    // Reorders indices in [first, last) so that the element at nth is the element that would be there if the indices
+    // were sorted by the coordinate along axis of the bounding centers of the gizmos they refer to. No element before nth
+    // has a greater coordinate and no element after nth has a smaller coordinate.
+    //
+    static void select_nth(Slice<Prepared_Gizmo const> const gizmos, i64* const indices, i64 first, i64 last, i64 const nth, i32 const axis) {
+        while(last - first > 1) {
+            f32 const pivot = gizmos[indices[first + (last - first) / 2]].bounding_center[axis];
+            // Partition into elements less than, equal to and greater than the pivot, so that repeated coordinates terminate.
+            i64 less_end = first;
+            i64 greater_begin = last;
+            i64 i = first;
+            while(i < greater_begin) {
+                f32 const value = gizmos[indices[i]].bounding_center[axis];
+                if(value < pivot) {
+                    i64 const index = indices[i];
+                    indices[i] = indices[less_end];
+                    indices[less_end] = index;
+                    less_end += 1;
+                    i += 1;
+                } else if(value > pivot) {
+                    greater_begin -= 1;
+                    i64 const index = indices[i];
+                    indices[i] = indices[greater_begin];
+                    indices[greater_begin] = index;
+                } else {
+                    i += 1;
+                }
+            }
+
+            if(nth < less_end) {
+                last = less_end;
+            } else if(nth >= greater_begin) {
+                first = greater_begin;
+            } else {
+                return;
+            }
+        }
+    }
+
+    void Gizmo_BVH::build(Slice<Prepared_Gizmo const> const gizmos) {
+        nodes.clear();
+        instances.clear();
+        leaves.clear();
+        if(gizmos.size() == 0) {
+            return;
+        }
+
+        instances.resize(gizmos.size());
+        leaves.resize(gizmos.size());
+        for(i64 i = 0; i < gizmos.size(); ++i) {
+            instances[i] = i;
+        }
+
+        nodes.emplace_back(Node{math::Vec3{0.0f}, math::Vec3{0.0f}, 0, gizmos.size(), -1});
+        build_node(gizmos, 0);
+    }
+
+    void Gizmo_BVH::build_node(Slice<Prepared_Gizmo const> const gizmos, i64 const node) {
+        i64 const first = nodes[node].first;
+        i64 const count = nodes[node].count;
+        if(count <= max_leaf_size) {
+            for(i64 i = first; i < first + count; ++i) {
+                leaves[instances[i]] = node;
+            }
+            fit_leaf(gizmos, node);
+            return;
+        }
+
+        // Split at the median along the axis of the largest extent of the bounding centers.
+        math::Vec3 min{math::infinity};
+        math::Vec3 max{-math::infinity};
+        for(i64 i = first; i < first + count; ++i) {
+            math::Vec3 const& center = gizmos[instances[i]].bounding_center;
+            for(i32 j = 0; j < 3; ++j) {
+                min[j] = math::min(min[j], center[j]);
+                max[j] = math::max(max[j], center[j]);
+            }
+        }
+
+        math::Vec3 const extent = max - min;
+        i32 axis = 0;
+        if(extent[1] > extent[axis]) {
+            axis = 1;
+        }
+        if(extent[2] > extent[axis]) {
+            axis = 2;
+        }
+
+        i64 const middle = first + count / 2;
+        select_nth(gizmos, instances.data(), first, first + count, middle, axis);
+        i64 const left = nodes.size();
+        nodes.emplace_back(Node{math::Vec3{0.0f}, math::Vec3{0.0f}, first, middle - first, node});
+        nodes.emplace_back(Node{math::Vec3{0.0f}, math::Vec3{0.0f}, middle, first + count - middle, node});
+        nodes[node].first = left;
+        nodes[node].count = 0;
+        build_node(gizmos, left);
+        build_node(gizmos, left + 1);
+        fit_inner(node);
+    }
+
+    void Gizmo_BVH::fit_leaf(Slice<Prepared_Gizmo const> const gizmos, i64 const node) {
+        Node& leaf = nodes[node];
+        leaf.min = math::Vec3{math::infinity};
+        leaf.max = math::Vec3{-math::infinity};
+        for(i64 i = leaf.first; i < leaf.first + leaf.count; ++i) {
+            Prepared_Gizmo const& gizmo = gizmos[instances[i]];
+            for(i32 j = 0; j < 3; ++j) {
+                leaf.min[j] = math::min(leaf.min[j], gizmo.bounding_center[j] - gizmo.bounding_radius);
+                leaf.max[j] = math::max(leaf.max[j], gizmo.bounding_center[j] + gizmo.bounding_radius);
+            }
+        }
+    }
+
+    void Gizmo_BVH::fit_inner(i64 const node) {
+        Node& inner = nodes[node];
+        Node const& left = nodes[inner.first];
+        Node const& right = nodes[inner.first + 1];
+        for(i32 j = 0; j < 3; ++j) {
+            inner.min[j] = math::min(left.min[j], right.min[j]);
+            inner.max[j] = math::max(left.max[j], right.max[j]);
+        }
+    }
+
+    void Gizmo_BVH::refit(Slice<Prepared_Gizmo const> const gizmos) {
+        for(i64 node = nodes.size() - 1; node >= 0; --node) {
+            if(nodes[node].count > 0) {
+                fit_leaf(gizmos, node);
+            } else {
+                fit_inner(node);
+            }
+        }
+    }
+
+    void Gizmo_BVH::refit(Slice<Prepared_Gizmo const> const gizmos, Slice<i64 const> const changed_indices) {
+        for(i64 const index: changed_indices) {
+            i64 node = leaves[index];
+            fit_leaf(gizmos, node);
+            node = nodes[node].parent;
+            while(node != -1) {
+                fit_inner(node);
+                node = nodes[node].parent;
+            }
+        }
+    }
+
+    Optional<Gizmo_Instance_Pick> Gizmo_BVH::pick(math::Ray const& ray, Slice<Prepared_Gizmo const> const gizmos, u32 const base_handle_id) const {
+        if(nodes.size() == 0) {
+            return null_optional;
+        }
+
+        Ray_Slabs<math::Vec3> const slabs = make_ray_slabs(ray.origin, ray.direction);
+        f32 const root_distance = intersect_ray_slabs(slabs, nodes[0].min, nodes[0].max);
+        if(root_distance == math::infinity) {
+            return null_optional;
+        }
+
+        struct Stack_Entry {
+            i64 node;
+            f32 distance;
+        };
+
+        Stack_Entry stack[max_traversal_stack_size];
+        i64 stack_size = 0;
+        stack[stack_size++] = Stack_Entry{0, root_distance};
+        Optional<Gizmo_Instance_Pick> result = null_optional;
+        while(stack_size > 0) {
+            Stack_Entry const entry = stack[--stack_size];
+            if(result && entry.distance > result->pick.distance) {
+                continue;
+            }
+
+            Node const& node = nodes[entry.node];
+            if(node.count > 0) {
+                for(i64 i = node.first; i < node.first + node.count; ++i) {
+                    i64 const instance = instances[i];
+                    Optional<Gizmo_Pick> const hit = pick_gizmo(ray, gizmos[instance], base_handle_id);
+                    if(hit && (!result || hit->distance < result->pick.distance)) {
+                        result = Gizmo_Instance_Pick{instance, *hit};
+                    }
+                }
+                continue;
+            }
+
+            Node const& left = nodes[node.first];
+            Node const& right = nodes[node.first + 1];
+            f32 const left_distance = intersect_ray_slabs(slabs, left.min, left.max);
+            f32 const right_distance = intersect_ray_slabs(slabs, right.min, right.max);
+            bool const left_hit = left_distance != math::infinity;
+            bool const right_hit = right_distance != math::infinity;
+            // Push the farther child first so that the nearer child is visited first.
+            if(left_hit && right_hit) {
+                if(left_distance < right_distance) {
+                    stack[stack_size++] = Stack_Entry{node.first + 1, right_distance};
+                    stack[stack_size++] = Stack_Entry{node.first, left_distance};
+                } else {
+                    stack[stack_size++] = Stack_Entry{node.first, left_distance};
+                    stack[stack_size++] = Stack_Entry{node.first + 1, right_distance};
+                }
+            } else if(left_hit) {
+                stack[stack_size++] = Stack_Entry{node.first, left_distance};
+            } else if(right_hit) {
+                stack[stack_size++] = Stack_Entry{node.first + 1, right_distance};
+            }
+        }
+        return result;
+    }
+} // namespace anton::gizmo
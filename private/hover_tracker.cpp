@@ -0,0 +1,242 @@
+#include <anton/gizmo/hover_tracker.hpp>
+
+#include <anton/math/math.hpp>
+#include <utils.hpp>
+
+namespace anton::gizmo {
+    // The fraction of the reach of a bounding sphere by which the bound on the distance of a ray from the remembered ray
+    // must be below the clearance. Absorbs the rounding errors of the bound and of the clearance.
+    constexpr f32 clearance_tolerance = 1e-5f;
+
+    [[nodiscard]] static u64 hash_word(u64 hash, u32 const word) {
+        for(i32 byte = 0; byte < 4; ++byte) {
+            hash ^= (word >> (8 * byte)) & 0xFF;
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    [[nodiscard]] static u64 hash_transform(u64 hash, math::Mat4 const& transform) {
+        for(i64 column = 0; column < 4; ++column) {
+            for(i64 row = 0; row < 4; ++row) {
+                hash = hash_word(hash, float_bits(transform[column][row]));
+            }
+        }
+        return hash;
+    }
+
+    [[nodiscard]] static u64 hash_arrow(u64 hash, Arrow_3D const& arrow) {
+        hash = hash_word(hash, static_cast<u32>(arrow.draw_style));
+        hash = hash_word(hash, float_bits(arrow.cap_size));
+        hash = hash_word(hash, float_bits(arrow.cap_length));
+        hash = hash_word(hash, float_bits(arrow.shaft_length));
+        return hash_word(hash, float_bits(arrow.shaft_diameter));
+    }
+
+    // hash_gizmo
+    // Hashes the parameters of a gizmo that affect picking. The first word distinguishes the kinds of the gizmos.
+    //
+    [[nodiscard]] static u64 hash_gizmo(Translate_Gizmo const& gizmo, math::Mat4 const& gizmo_transform) {
+        u64 hash = hash_word(14695981039346656037ULL, 0);
+        hash = hash_arrow(hash, gizmo.arrow);
+        hash = hash_word(hash, float_bits(gizmo.plane_size));
+        hash = hash_word(hash, float_bits(gizmo.plane_offset));
+        hash = hash_word(hash, float_bits(gizmo.center_size));
+        return hash_transform(hash, gizmo_transform);
+    }
+
+    [[nodiscard]] static u64 hash_gizmo(Rotate_Gizmo const& gizmo, math::Mat4 const& gizmo_transform) {
+        u64 hash = hash_word(14695981039346656037ULL, 1);
+        hash = hash_word(hash, float_bits(gizmo.dial.major_radius));
+        hash = hash_word(hash, float_bits(gizmo.dial.minor_radius));
+        hash = hash_word(hash, static_cast<u32>(gizmo.dial.bounds));
+        hash = hash_word(hash, float_bits(gizmo.trackball_radius));
+        return hash_transform(hash, gizmo_transform);
+    }
+
+    [[nodiscard]] static u64 hash_gizmo(Scale_Gizmo const& gizmo, math::Mat4 const& gizmo_transform) {
+        u64 hash = hash_word(14695981039346656037ULL, 2);
+        hash = hash_arrow(hash, gizmo.arrow);
+        hash = hash_word(hash, float_bits(gizmo.center_size));
+        return hash_transform(hash, gizmo_transform);
+    }
+
+    // calculate_clearance
+    // Calculates the distance from the half-line of the ray to the surface of the sphere. The direction of the ray
+    // must be normalized.
+    //
+    // Returns:
+    // The distance, which is not positive if the ray intersects the sphere.
+    //
+    [[nodiscard]] static f32 calculate_clearance(math::Ray const& ray, math::Vec3 const& center, f32 const radius) {
+        math::Vec3 const to_center = center - ray.origin;
+        f32 const projection = math::dot(to_center, ray.direction);
+        f32 const distance_squared = math::length_squared(to_center);
+        if(projection <= 0.0f) {
+            return math::sqrt(distance_squared) - radius;
+        }
+
+        return math::sqrt(math::max(distance_squared - projection * projection, 0.0f)) - radius;
+    }
+
+    // calculate_reach
+    // Calculates the greatest distance from the origin of the ray to a point of the sphere.
+    //
+    [[nodiscard]] static f32 calculate_reach(math::Ray const& ray, math::Vec3 const& center, f32 const radius) {
+        return math::length(center - ray.origin) + radius;
+    }
+
+    // is_still_cleared
+    // Checks whether a ray that has moved from the remembered ray still misses a sphere the remembered ray has missed.
+    // A point of the moved ray at distance t from its origin is at most origin_drift + t * direction_drift away
+    // from a point of the remembered ray. The moved ray may reach the sphere only for t up to reach + origin_drift.
+    //
+    [[nodiscard]] static bool is_still_cleared(f32 const clearance, f32 const reach, f32 const origin_drift, f32 const direction_drift) {
+        if(clearance <= 0.0f) {
+            return false;
+        }
+
+        f32 const drift = origin_drift + (reach + origin_drift) * direction_drift;
+        return drift < clearance - clearance_tolerance * reach;
+    }
+
+    Optional<Gizmo_Pick> Hover_Tracker::pick(math::Ray const& ray, Translate_Gizmo const& gizmo, math::Mat4 const& gizmo_transform, u32 const base_handle_id) {
+        u64 const hash = hash_gizmo(gizmo, gizmo_transform);
+        if(!has_prepared || hash != prepared_hash) {
+            prepared = prepare_gizmo(gizmo, gizmo_transform);
+            prepared_hash = hash;
+            has_prepared = true;
+        }
+        return pick(ray, prepared, hash, base_handle_id);
+    }
+
+    Optional<Gizmo_Pick> Hover_Tracker::pick(math::Ray const& ray, Rotate_Gizmo const& gizmo, math::Mat4 const& gizmo_transform, u32 const base_handle_id) {
+        u64 const hash = hash_gizmo(gizmo, gizmo_transform);
+        if(!has_prepared || hash != prepared_hash) {
+            prepared = prepare_gizmo(gizmo, gizmo_transform);
+            prepared_hash = hash;
+            has_prepared = true;
+        }
+        return pick(ray, prepared, hash, base_handle_id);
+    }
+
+    Optional<Gizmo_Pick> Hover_Tracker::pick(math::Ray const& ray, Scale_Gizmo const& gizmo, math::Mat4 const& gizmo_transform, u32 const base_handle_id) {
+        u64 const hash = hash_gizmo(gizmo, gizmo_transform);
+        if(!has_prepared || hash != prepared_hash) {
+            prepared = prepare_gizmo(gizmo, gizmo_transform);
+            prepared_hash = hash;
+            has_prepared = true;
+        }
+        return pick(ray, prepared, hash, base_handle_id);
+    }
+
+    Optional<Gizmo_Pick> Hover_Tracker::pick(math::Ray const& new_ray, Prepared_Gizmo const& gizmo, u64 const new_gizmo_hash, u32 const base_handle_id) {
+        counters.queries += 1;
+        if(!valid || new_gizmo_hash != gizmo_hash) {
+            return pick_full(new_ray, gizmo, new_gizmo_hash, base_handle_id);
+        }
+
+        f32 const origin_drift = math::length(new_ray.origin - ray.origin);
+        f32 const direction_drift = math::length(new_ray.direction - ray.direction);
+        i64 handle_count = 0;
+        for(Gizmo_Handle_Shape const shape: gizmo.shapes) {
+            handle_count += shape != Gizmo_Handle_Shape::none;
+        }
+
+        if(is_still_cleared(gizmo_clearance, gizmo_reach, origin_drift, direction_drift)) {
+            counters.avoided_full_tests += 1;
+            counters.skipped_handles += handle_count;
+            winner = -1;
+            return null_optional;
+        }
+
+        // The remembered ray has missed the whole gizmo, but the new ray might not.
+        if(gizmo_clearance > 0.0f) {
+            return pick_full(new_ray, gizmo, new_gizmo_hash, base_handle_id);
+        }
+
+        // Every handle the remembered ray has missed must still be missed. Otherwise the handles to verify
+        // are no longer known and the whole gizmo is tested.
+        bool verify[gizmo_handle_count] = {};
+        for(i64 i = 0; i < gizmo_handle_count; ++i) {
+            if(gizmo.shapes[i] == Gizmo_Handle_Shape::none) {
+                continue;
+            }
+
+            if(clearances[i] > 0.0f) {
+                if(!is_still_cleared(clearances[i], reaches[i], origin_drift, direction_drift)) {
+                    return pick_full(new_ray, gizmo, new_gizmo_hash, base_handle_id);
+                }
+            } else {
+                verify[i] = true;
+            }
+        }
+
+        counters.avoided_full_tests += 1;
+        Optional<Gizmo_Pick> result = null_optional;
+        // Test the previous winner first. Its hit most likely remains the nearest and lets the neighbours
+        // that lie entirely beyond it be skipped.
+        if(winner >= 0 && verify[winner]) {
+            verify[winner] = false;
+            counters.verified_handles += 1;
+            handle_count -= 1;
+            Gizmo_Handle const handle = static_cast<Gizmo_Handle>(winner);
+            Optional<f32> const hit = intersect_gizmo_handle(new_ray, gizmo, handle);
+            if(hit) {
+                result = Gizmo_Pick{handle, base_handle_id + static_cast<u32>(handle), *hit};
+            }
+        }
+
+        for(i64 i = 0; i < gizmo_handle_count; ++i) {
+            if(!verify[i]) {
+                continue;
+            }
+
+            // Every hit lies within the bounding sphere of its handle, hence no closer than the nearest point of the sphere.
+            Prepared_Handle const& prepared_handle = gizmo.handles[i];
+            if(result && math::length(prepared_handle.bounding_center - new_ray.origin) - prepared_handle.bounding_radius > result->distance) {
+                continue;
+            }
+
+            counters.verified_handles += 1;
+            handle_count -= 1;
+            Gizmo_Handle const handle = static_cast<Gizmo_Handle>(i);
+            Optional<f32> const hit = intersect_gizmo_handle(new_ray, gizmo, handle);
+            if(hit && (!result || *hit < result->distance)) {
+                result = Gizmo_Pick{handle, base_handle_id + static_cast<u32>(handle), *hit};
+            }
+        }
+        counters.skipped_handles += handle_count;
+        winner = result ? static_cast<i64>(result->handle) : -1;
+        return result;
+    }
+
+    Optional<Gizmo_Pick> Hover_Tracker::pick_full(math::Ray const& new_ray, Prepared_Gizmo const& gizmo, u64 const new_gizmo_hash, u32 const base_handle_id) {
+        counters.full_tests += 1;
+        valid = true;
+        gizmo_hash = new_gizmo_hash;
+        ray = new_ray;
+        gizmo_clearance = calculate_clearance(ray, gizmo.bounding_center, gizmo.bounding_radius);
+        gizmo_reach = calculate_reach(ray, gizmo.bounding_center, gizmo.bounding_radius);
+        for(i64 i = 0; i < gizmo_handle_count; ++i) {
+            Prepared_Handle const& handle = gizmo.handles[i];
+            clearances[i] = calculate_clearance(ray, handle.bounding_center, handle.bounding_radius);
+            reaches[i] = calculate_reach(ray, handle.bounding_center, handle.bounding_radius);
+        }
+        Optional<Gizmo_Pick> const result = pick_gizmo(ray, gizmo, base_handle_id);
+        winner = result ? static_cast<i64>(result->handle) : -1;
+        return result;
+    }
+
+    void Hover_Tracker::reset() {
+        valid = false;
+    }
+
+    Hover_Tracker_Counters const& Hover_Tracker::get_counters() const {
+        return counters;
+    }
+
+    void Hover_Tracker::reset_counters() {
+        counters = Hover_Tracker_Counters{};
+    }
+} // namespace anton::gizmo
@@ -0,0 +1,50 @@
+#include <anton/gizmo/instancing.hpp>
+
+#include <anton/math/vec4.hpp>
+#include <utils.hpp>
+
+namespace anton::gizmo {
+    i64 gizmo_instance_count(i64 const gizmo_count) {
+        return 3 * gizmo_count;
+    }
+
+    Gizmo_Instance_Stream generate_gizmo_instances(Slice<math::Mat4 const> const world_transforms, Slice<i32 const> const highlighted_axes) {
+        i64 const instance_count = gizmo_instance_count(world_transforms.size());
+        Gizmo_Instance_Stream stream{Array<f32>(12 * instance_count), Array<u8>(instance_count), Array<u8>(instance_count)};
+        generate_gizmo_instances(world_transforms, highlighted_axes, stream.transforms, stream.axis_ids, stream.colour_indices);
+        return stream;
+    }
+
+    void generate_gizmo_instances(Slice<math::Mat4 const> const world_transforms, Slice<i32 const> const highlighted_axes, Slice<f32> const transforms,
+                                  Slice<u8> const axis_ids, Slice<u8> const colour_indices) {
+        f32* transform = transforms.data();
+        u8* axis_id = axis_ids.data();
+        u8* colour_index = colour_indices.data();
+        for(i64 i = 0; i < world_transforms.size(); ++i) {
+            math::Mat4 const& world = world_transforms[i];
+            i32 const highlighted_axis = highlighted_axes.size() > 0 ? highlighted_axes[i] : -1;
+            for(i32 axis = 0; axis < 3; ++axis) {
+                // The instance transform is world * rotation. The rotation only mixes the first 3 columns of world.
+                math::Vec4 columns[3];
+                for(i32 c = 0; c < 3; ++c) {
+                    f32 const* const r = axis_rotations[axis][c];
+                    columns[c] = world[0] * r[0] + world[1] * r[1] + world[2] * r[2];
+                }
+
+                // Store the top 3 rows in row-major order.
+                for(i32 row = 0; row < 3; ++row) {
+                    transform[0] = columns[0][row];
+                    transform[1] = columns[1][row];
+                    transform[2] = columns[2][row];
+                    transform[3] = world[3][row];
+                    transform += 4;
+                }
+
+                *axis_id = static_cast<u8>(axis);
+                *colour_index = axis == highlighted_axis ? highlight_colour_index : static_cast<u8>(axis);
+                axis_id += 1;
+                colour_index += 1;
+            }
+        }
+    }
+} // namespace anton::gizmo
@@ -4,7 +4,9 @@
 #include <anton/math/transform.hpp>
 #include <anton/math/vec3.hpp>
 #include <anton/math/vec4.hpp>
+#include <anton/gizmo/ray_packet.hpp>
 #include <anton/optional.hpp>
+#include <simd.hpp>
 
 namespace anton::gizmo {
     class Raycast_Hit {
@@ -27,246 +29,577 @@ namespace anton::gizmo {
         }
     }
 
-    inline Optional<Raycast_Hit> intersect_ray_sphere(math::Ray const ray, math::Vec3 const origin, f32 const radius) {
-        math::Vec3 const ray_origin = ray.origin - origin;
-        // a = dot(ray.direction, ray.direction) which is always 1
-        f32 const b = 2.0f * math::dot(ray_origin, ray.direction);
-        f32 const c = math::dot(ray_origin, ray_origin) - radius * radius;
-        f32 const delta = b * b - 4.0f * c;
-        if(delta < 0.0f) {
+    // Ray_Quadric
+    // The intersection of a ray with a quadric surface. The ray crosses the surface at the roots t of
+    // a * t^2 + b * t + c = 0. A root is a hit if the height of the hit point h = h0 + t * dh lies within [0, h_max],
+    // which clips the infinite surface to the part that belongs to the shape.
+    //
+    // The setup functions below produce the quadric of each shape and solve_ray_quadric finds the nearest hit.
+    // All of them are templated on the float type, so that the same code tests a single shape with f32 and math::Vec3
+    // or several shapes at once with simd::Float and simd::Float3.
+    //
+    template<typename Float>
+    struct Ray_Quadric {
+        Float a;
+        Float b;
+        Float c;
+        Float h0;
+        Float dh;
+        Float h_max;
+    };
+
+    // setup_ray_sphere
+    //
+    // Parameters:
+    //    offset - the origin of the ray relative to the center of the sphere.
+    // direction - the direction of the ray.
+    //    radius - the radius of the sphere.
+    //
+    template<typename Float, typename Vector>
+    [[nodiscard]] Ray_Quadric<Float> setup_ray_sphere(Vector const& offset, Vector const& direction, Float const radius) {
+        Float const zero = simd::splat<Float>(0.0f);
+        Float const a = dot(direction, direction);
+        Float const b = simd::splat<Float>(2.0f) * dot(offset, direction);
+        Float const c = dot(offset, offset) - radius * radius;
+        // The whole sphere is hit, the height is always 0.
+        return {a, b, c, zero, zero, zero};
+    }
+
+    // setup_ray_cylinder
+    // The side of a cylinder extending from its base along axis.
+    //
+    // Parameters:
+    //    offset - the origin of the ray relative to the center of the base of the cylinder.
+    // direction - the direction of the ray.
+    //      axis - the normalized axis of the cylinder.
+    //    radius - the radius of the cylinder.
+    //    height - the height of the cylinder.
+    //
+    template<typename Float, typename Vector>
+    [[nodiscard]] Ray_Quadric<Float> setup_ray_cylinder(Vector const& offset, Vector const& direction, Vector const& axis, Float const radius,
+                                                        Float const height) {
+        Float const direction_dot_axis = dot(direction, axis);
+        Float const offset_dot_axis = dot(offset, axis);
+        Float const a = dot(direction, direction) - direction_dot_axis * direction_dot_axis;
+        Float const b = simd::splat<Float>(2.0f) * (dot(offset, direction) - offset_dot_axis * direction_dot_axis);
+        Float const c = dot(offset, offset) - offset_dot_axis * offset_dot_axis - radius * radius;
+        return {a, b, c, offset_dot_axis, direction_dot_axis, height};
+    }
+
+    // setup_ray_cone
+    // The side of a cone expanding from its vertex along axis.
+    //
+    // Parameters:
+    //    offset - the origin of the ray relative to the vertex of the cone.
+    // direction - the direction of the ray.
+    //      axis - the normalized axis of the cone.
+    // angle_cos - the cosine of the angle between the axis and the side of the cone.
+    //    height - the height of the cone.
+    //
+    template<typename Float, typename Vector>
+    [[nodiscard]] Ray_Quadric<Float> setup_ray_cone(Vector const& offset, Vector const& direction, Vector const& axis, Float const angle_cos,
+                                                    Float const height) {
+        // We use the equation '<|P|, axis> = angle_cos' where 'P = t * direction + offset' and solve for t.
+        Float const cos_squared = angle_cos * angle_cos;
+        Float const direction_dot_axis = dot(direction, axis);
+        Float const offset_dot_axis = dot(offset, axis);
+        Float const a = direction_dot_axis * direction_dot_axis - cos_squared * dot(direction, direction);
+        Float const b = simd::splat<Float>(2.0f) * (direction_dot_axis * offset_dot_axis - cos_squared * dot(direction, offset));
+        Float const c = offset_dot_axis * offset_dot_axis - cos_squared * dot(offset, offset);
+        return {a, b, c, offset_dot_axis, direction_dot_axis, height};
+    }
+
+    // solve_ray_quadric
+    // Finds the nearest non-negative root of the quadric whose height lies within [0, h_max]. When a is 0, the equation
+    // is linear (the ray is parallel to the side of a cone) and its single root is used instead.
+    //
+    // Returns:
+    // The distance along the ray to the nearest hit or infinity if there is none.
+    //
+    template<typename Float>
+    [[nodiscard]] Float solve_ray_quadric(Ray_Quadric<Float> const& quadric) {
+        using Mask = typename simd::Mask_Type<Float>::type;
+        Float const zero = simd::splat<Float>(0.0f);
+        Float const epsilon = simd::splat<Float>(math::epsilon);
+        // The operands of & are computed into locals, because Mask is bool for f32 and & of bools with a call
+        // on its right-hand side trips -Wbitwise-instead-of-logical.
+        Mask const quadratic = simd::abs(quadric.a) > epsilon;
+        Mask const not_quadratic = simd::abs(quadric.a) <= epsilon;
+        Mask const has_linear_term = simd::abs(quadric.b) > epsilon;
+        Mask const linear = not_quadratic & has_linear_term;
+        Float const delta = quadric.b * quadric.b - simd::splat<Float>(4.0f) * quadric.a * quadric.c;
+        Float const delta_sqrt = simd::sqrt(simd::max(delta, zero));
+        Float const inv_2a = simd::splat<Float>(0.5f) / quadric.a;
+        Float const linear_t = (zero - quadric.c) / quadric.b;
+        Float const t1 = simd::select(quadratic, (zero - quadric.b - delta_sqrt) * inv_2a, linear_t);
+        Float const t2 = simd::select(quadratic, (zero - quadric.b + delta_sqrt) * inv_2a, linear_t);
+        Mask const solvable = (quadratic & (delta >= zero)) | linear;
+        Float const h1 = quadric.h0 + t1 * quadric.dh;
+        Float const h2 = quadric.h0 + t2 * quadric.dh;
+        Mask const valid1 = solvable & (t1 >= zero) & (h1 >= zero) & (h1 <= quadric.h_max);
+        Mask const valid2 = solvable & (t2 >= zero) & (h2 >= zero) & (h2 <= quadric.h_max);
+        Float const infinity = simd::splat<Float>(math::infinity);
+        return simd::min(simd::select(valid1, t1, infinity), simd::select(valid2, t2, infinity));
+    }
+
+    // intersect_ray_disc
+    //
+    // Parameters:
+    //               offset - the origin of the ray relative to the center of the disc.
+    //            direction - the direction of the ray.
+    //               normal - the normal of the disc.
+    // direction_dot_normal - dot(direction, normal).
+    //       radius_squared - the squared radius of the disc.
+    //
+    // Returns:
+    // The distance along the ray to the hit or infinity if the ray misses the disc.
+    //
+    template<typename Float, typename Vector>
+    [[nodiscard]] Float intersect_ray_disc(Vector const& offset, Vector const& direction, Vector const& normal, Float const direction_dot_normal,
+                                           Float const radius_squared) {
+        Float const zero = simd::splat<Float>(0.0f);
+        Float const t = (zero - dot(offset, normal)) / direction_dot_normal;
+        Vector const point = offset + direction * t;
+        using Mask = typename simd::Mask_Type<Float>::type;
+        Mask const not_parallel = simd::abs(direction_dot_normal) > simd::splat<Float>(math::epsilon);
+        Mask const in_front = t >= zero;
+        Mask const inside = dot(point, point) <= radius_squared;
+        Mask const valid = not_parallel & in_front & inside;
+        return simd::select(valid, t, simd::splat<Float>(math::infinity));
+    }
+
+    [[nodiscard]] inline Optional<Raycast_Hit> make_raycast_hit(math::Ray const ray, f32 const distance) {
+        if(distance == math::infinity) {
             return null_optional;
         }
 
-        Optional<Raycast_Hit> result = null_optional;
-        f32 const delta_sqrt = math::sqrt(delta);
-        f32 const t1 = 0.5f * (-b - delta_sqrt);
-        f32 const t2 = 0.5f * (-b + delta_sqrt);
-        if(t1 < t2 && t1 >= 0.0f) {
-            Raycast_Hit hit;
-            hit.distance = t1;
-            hit.hit_point = ray.origin + t1 * ray.direction;
-            result = hit;
-        } else if(t2 < t1 && t2 >= 0.0f) {
-            Raycast_Hit hit;
-            hit.distance = t1;
-            hit.hit_point = ray.origin + t1 * ray.direction;
-            result = hit;
-        }
-        return result;
+        Raycast_Hit hit;
+        hit.distance = distance;
+        hit.hit_point = ray.origin + ray.direction * distance;
+        return hit;
+    }
+
+    inline Optional<Raycast_Hit> intersect_ray_sphere(math::Ray const ray, math::Vec3 const origin, f32 const radius) {
+        return make_raycast_hit(ray, solve_ray_quadric(setup_ray_sphere(ray.origin - origin, ray.direction, radius)));
     }
 
     // direction is the vector which defines where the cone is expanding
     inline Optional<Raycast_Hit> intersect_ray_cone(math::Ray const ray, math::Vec3 const vertex, math::Vec3 const direction, f32 const angle_cos,
                                                     f32 const height) {
-        Optional<Raycast_Hit> result = null_optional;
-        // We use the equation '<|P|, direction> = angle_cos' where 'P = t * ray.direction + ray.origin - vertex' and solve for t.
-        math::Vec3 const ray_origin = ray.origin - vertex;
-        f32 const cos_squared = angle_cos * angle_cos;
-        f32 const a = math::dot(ray.direction, direction) * math::dot(ray.direction, direction) - cos_squared;
-        f32 const b = 2.0f * math::dot(ray.direction, direction) * math::dot(ray_origin, direction) - 2.0f * cos_squared * math::dot(ray.direction, ray_origin);
-        f32 const c = math::dot(ray_origin, direction) * math::dot(ray_origin, direction) - cos_squared * math::dot(ray_origin, ray_origin);
-        if(a > math::epsilon || a < -math::epsilon) {
-            f32 const delta = b * b - 4.0f * a * c;
-            if(delta >= 0.0f) {
-                f32 const delta_sqrt = math::sqrt(delta);
-                f32 const t1 = 0.5f * (-b - delta_sqrt) / a;
-                math::Vec3 const t1v = ray_origin + ray.direction * t1;
-                if(f32 const point_height = dot(direction, t1v); t1 >= 0.0f && point_height >= 0 && point_height <= height) {
-                    Raycast_Hit hit;
-                    hit.distance = t1;
-                    hit.hit_point = t1v + vertex;
-                    result = hit;
-                }
-
-                f32 const t2 = 0.5f * (-b + delta_sqrt) / a;
-                math::Vec3 const t2v = ray_origin + ray.direction * t2;
-                if(f32 const point_height = dot(direction, t2v);
-                   t2 >= 0.0f && point_height >= 0 && point_height <= height && (!result || t2 < result->distance)) {
-                    Raycast_Hit hit;
-                    hit.distance = t2;
-                    hit.hit_point = t2v + vertex;
-                    result = hit;
-                }
+        return make_raycast_hit(ray, solve_ray_quadric(setup_ray_cone(ray.origin - vertex, ray.direction, direction, angle_cos, height)));
+    }
+
+    // intersect_ray_capped_cylinder
+    // The side and both caps of a cylinder extending from its base along axis.
+    // The parameters are those of setup_ray_cylinder.
+    //
+    // Returns:
+    // The distance along the ray to the nearest hit or infinity if the ray misses the cylinder.
+    //
+    template<typename Float, typename Vector>
+    [[nodiscard]] Float intersect_ray_capped_cylinder(Vector const& offset, Vector const& direction, Vector const& axis, Float const radius,
+                                                      Float const height) {
+        Float const direction_dot_axis = dot(direction, axis);
+        Float const radius_squared = radius * radius;
+        Float distance = solve_ray_quadric(setup_ray_cylinder(offset, direction, axis, radius, height));
+        distance = simd::min(distance, intersect_ray_disc(offset, direction, axis, direction_dot_axis, radius_squared));
+        distance = simd::min(distance, intersect_ray_disc(offset - axis * height, direction, axis, direction_dot_axis, radius_squared));
+        return distance;
+    }
+
+    inline Optional<Raycast_Hit> intersect_ray_cylinder_uncapped(math::Ray const ray, math::Vec3 const vertex1, math::Vec3 const vertex2, f32 const radius) {
+        math::Vec3 const axis = vertex2 - vertex1;
+        f32 const height = math::length(axis);
+        math::Vec3 const cylinder_normal = axis / height;
+        return make_raycast_hit(ray, solve_ray_quadric(setup_ray_cylinder(ray.origin - vertex1, ray.direction, cylinder_normal, radius, height)));
+    }
+
+    inline Optional<Raycast_Hit> intersect_ray_cylinder(math::Ray const ray, math::Vec3 const vertex1, math::Vec3 const vertex2, f32 const radius) {
+        math::Vec3 const axis = vertex2 - vertex1;
+        f32 const height = math::length(axis);
+        math::Vec3 const cylinder_normal = axis / height;
+        return make_raycast_hit(ray, intersect_ray_capped_cylinder(ray.origin - vertex1, ray.direction, cylinder_normal, radius, height));
+    }
+
+    // intersect_ray_triangle
+    // Moller-Trumbore test of a ray against the triangle v0, v0 + edge1, v0 + edge2. Both sides of the triangle are hit.
+    // Degenerate triangles, including the padding of partially filled groups of triangles, produce infinities or NaNs
+    // that fail the comparisons, so they are never hit.
+    //
+    // Parameters:
+    //       u, v - receive the barycentric weights of v0 + edge1 and v0 + edge2 at the hit point.
+    //              The weight of v0 is 1 - u - v.
+    //
+    // Returns:
+    // The distance along the ray to the hit or infinity if the ray misses the triangle.
+    //
+    template<typename Float, typename Vector>
+    [[nodiscard]] Float intersect_ray_triangle(Vector const& origin, Vector const& direction, Vector const& v0, Vector const& edge1, Vector const& edge2,
+                                               Float& u, Float& v) {
+        Float const zero = simd::splat<Float>(0.0f);
+        Float const one = simd::splat<Float>(1.0f);
+        Vector const p = cross(direction, edge2);
+        Float const inv_determinant = one / dot(edge1, p);
+        Vector const s = origin - v0;
+        u = dot(s, p) * inv_determinant;
+        Vector const q = cross(s, edge1);
+        v = dot(direction, q) * inv_determinant;
+        Float const distance = dot(edge2, q) * inv_determinant;
+        typename simd::Mask_Type<Float>::type const hit = (u >= zero) & (v >= zero) & (u + v <= one) & (distance >= zero);
+        return simd::select(hit, distance, simd::splat<Float>(math::infinity));
+    }
+
+    inline Optional<Raycast_Hit> intersect_ray_triangle(math::Ray const ray, math::Vec3 const a, math::Vec3 const b, math::Vec3 const c) {
+        f32 u;
+        f32 v;
+        Optional<Raycast_Hit> hit = make_raycast_hit(ray, intersect_ray_triangle(ray.origin, ray.direction, a, b - a, c - a, u, v));
+        if(hit) {
+            hit->barycentric_coordinates = math::Vec3{1.0f - u - v, u, v};
+        }
+        return hit;
+    }
+
+    // Ray_Slabs
+    // A ray prepared for slab tests against boxes whose edges are parallel to the axes of the space of the ray.
+    // The reciprocal of the direction is calculated once, so that the ray may be tested against any number of such boxes
+    // without divisions.
+    //
+    template<typename Vector>
+    struct Ray_Slabs {
+        Vector origin;
+        // 1 / direction. Components of the direction that are 0 yield infinities.
+        Vector inv_direction;
+    };
+
+    // make_ray_slabs
+    // Prepares a ray for slab tests against axis aligned boxes.
+    //
+    template<typename Vector>
+    [[nodiscard]] Ray_Slabs<Vector> make_ray_slabs(Vector const& origin, Vector const& direction) {
+        using Float = decltype(direction.x);
+        Float const one = simd::splat<Float>(1.0f);
+        return {origin, Vector{one / direction.x, one / direction.y, one / direction.z}};
+    }
+
+    // make_ray_slabs
+    // Prepares a ray for slab tests against boxes oriented along the given axes. The ray is transformed to the space
+    // of the boxes with three dot products per vector.
+    //
+    // Parameters:
+    //                  offset - the origin of the ray relative to the origin of the space of the boxes.
+    //               direction - the direction of the ray.
+    // x_axis, y_axis, z_axis - the normalized axes of the boxes.
+    //
+    template<typename Vector>
+    [[nodiscard]] Ray_Slabs<Vector> make_ray_slabs(Vector const& offset, Vector const& direction, Vector const& x_axis, Vector const& y_axis,
+                                                   Vector const& z_axis) {
+        Vector const local_origin{dot(offset, x_axis), dot(offset, y_axis), dot(offset, z_axis)};
+        Vector const local_direction{dot(direction, x_axis), dot(direction, y_axis), dot(direction, z_axis)};
+        return make_ray_slabs(local_origin, local_direction);
+    }
+
+    // clip_ray_slab
+    // Clips [t_min, t_max] to the part of the ray between the planes at min and max along one axis.
+    //
+    // A ray parallel to the planes that starts on one of them yields 0 * infinity = NaN for that plane and an infinity
+    // for the other one. simd::min and simd::max return their second operand if either is NaN, hence every distance is
+    // clipped against t_min and t_max separately, so that a NaN leaves them unchanged instead of letting the infinity
+    // of the other plane through.
+    //
+    template<typename Float>
+    void clip_ray_slab(Float const origin, Float const inv_direction, Float const min, Float const max, Float& t_min, Float& t_max) {
+        Float const t1 = (min - origin) * inv_direction;
+        Float const t2 = (max - origin) * inv_direction;
+        t_min = simd::min(simd::max(t1, t_min), simd::max(t2, t_min));
+        t_max = simd::max(simd::min(t1, t_max), simd::min(t2, t_max));
+    }
+
+    // intersect_ray_slabs
+    // Branchless slab test of a prepared ray against an axis aligned box in the space of the ray. Boxes with no extent
+    // along some axes, e.g. the bounds of a single flat triangle, are hit as well.
+    //
+    // Returns:
+    // The distance along the ray at which it enters the box, 0 if the ray starts inside the box,
+    // or infinity if the ray misses the box.
+    //
+    template<typename Vector>
+    [[nodiscard]] auto intersect_ray_slabs(Ray_Slabs<Vector> const& ray, Vector const& box_min, Vector const& box_max) -> decltype(ray.origin.x) {
+        using Float = decltype(ray.origin.x);
+        Float t_min = simd::splat<Float>(0.0f);
+        Float t_max = simd::splat<Float>(math::infinity);
+        clip_ray_slab(ray.origin.x, ray.inv_direction.x, box_min.x, box_max.x, t_min, t_max);
+        clip_ray_slab(ray.origin.y, ray.inv_direction.y, box_min.y, box_max.y, t_min, t_max);
+        clip_ray_slab(ray.origin.z, ray.inv_direction.z, box_min.z, box_max.z, t_min, t_max);
+        return simd::select(t_min <= t_max, t_min, simd::splat<Float>(math::infinity));
+    }
+
+    // intersect_ray_obb
+    // Slab test of a ray against an oriented box.
+    //
+    // Parameters:
+    //                  offset - the origin of the ray relative to the center of the box.
+    //               direction - the direction of the ray.
+    // x_axis, y_axis, z_axis - the normalized axes of the box.
+    //              halfwidths - half of the extents of the box along its axes.
+    //
+    // Returns:
+    // The distance along the ray at which it enters the box, 0 if the ray starts inside the box,
+    // or infinity if the ray misses the box.
+    //
+    template<typename Vector>
+    [[nodiscard]] auto intersect_ray_obb(Vector const& offset, Vector const& direction, Vector const& x_axis, Vector const& y_axis, Vector const& z_axis,
+                                         Vector const& halfwidths) -> decltype(offset.x) {
+        Ray_Slabs<Vector> const ray = make_ray_slabs(offset, direction, x_axis, y_axis, z_axis);
+        return intersect_ray_slabs(ray, -halfwidths, halfwidths);
+    }
+
+    inline Optional<Raycast_Hit> intersect_ray_obb(math::Ray const ray, math::OBB const& obb) {
+        return make_raycast_hit(ray, intersect_ray_obb(ray.origin - obb.center, ray.direction, obb.local_x, obb.local_y, obb.local_z, obb.halfwidths));
+    }
+
+    // Polynomials of the torus test. coefficients[i] is the coefficient of t^i. The torus test evaluates them in double
+    // precision, since the coefficients of the quartic nearly cancel out close to the surface of a thin torus.
+
+    [[nodiscard]] inline f64 evaluate_polynomial(f64 const* const coefficients, i64 const degree, f64 const t) {
+        f64 value = coefficients[degree];
+        for(i64 i = degree - 1; i >= 0; --i) {
+            value = value * t + coefficients[i];
+        }
+        return value;
+    }
+
+    // find_monotonic_root
+    // Finds the root of a polynomial within [a, b] where the polynomial is monotonic and f(a) and f(b) have opposite signs.
+    // Newton steps that leave the bracket are replaced by bisection.
+    //
+    [[nodiscard]] inline f64 find_monotonic_root(f64 const* const coefficients, f64 const* const derivative, i64 const degree, f64 a, f64 b) {
+        bool const increasing = evaluate_polynomial(coefficients, degree, a) < 0.0;
+        f64 t = 0.5 * (a + b);
+        for(i32 iteration = 0; iteration < 64; ++iteration) {
+            f64 const value = evaluate_polynomial(coefficients, degree, t);
+            if(value == 0.0) {
+                return t;
             }
-        } else {
-            // Ray is parallel to the cone boundary
-            if(b > math::epsilon || b < -math::epsilon) {
-                f32 const t = -c / b;
-                f32 const point_height = dot(ray_origin + ray.direction * t, direction);
-                if(t >= 0 && point_height <= height && point_height >= 0.0f) {
-                    Raycast_Hit hit;
-                    hit.distance = t;
-                    hit.hit_point = ray.origin + ray.direction * t;
-                    result = hit;
-                }
+
+            if((value < 0.0) == increasing) {
+                a = t;
             } else {
-                // Ray is on the boundary of the infinite cone
-                f32 const o = math::dot(ray_origin, direction);
-                if(o <= height && o >= 0.0f) {
-                    // Origin lies on the cone's coundary
-                    Raycast_Hit hit;
-                    hit.distance = 0.0f;
-                    hit.hit_point = ray.origin;
-                    result = hit;
-                } else if(f32 const t = -dot(ray_origin, ray.direction); t >= 0.0f) {
-                    Raycast_Hit hit;
-                    hit.distance = t;
-                    hit.hit_point = ray.origin + ray.direction * t;
-                    result = hit;
-                }
+                b = t;
             }
-        }
 
-        // if(Optional<Raycast_Hit> const hit = intersect_ray_plane({ray_origin, ray.direction}, direction, height);
-        //    hit.holds_value() && (!result || hit->distance < result->distance) &&
-        //    (length_squared(hit->hit_point - dot(hit->hit_point, direction) * direction) * angle_cos_square <= height * height)) {
-        //     result = hit;
-        // }
+            f64 const slope = evaluate_polynomial(derivative, degree - 1, t);
+            f64 next = slope != 0.0 ? t - value / slope : a;
+            if(!(next > a && next < b)) {
+                next = 0.5 * (a + b);
+            }
 
-        return result;
+            f64 const step = next > t ? next - t : t - next;
+            t = next;
+            if(step <= 1e-9 * (1.0 + (t > 0.0 ? t : -t))) {
+                break;
+            }
+        }
+        return t;
     }
 
-    inline Optional<Raycast_Hit> intersect_ray_obb(math::Ray ray, math::OBB obb) {
-        math::Mat4 rotation = math::Mat4(math::Vec4{obb.local_x, 0}, math::Vec4{obb.local_y, 0}, math::Vec4{obb.local_z, 0}, math::Vec4{0, 0, 0, 1});
-        // Center OBB at 0
-        math::Mat4 obb_space = rotation * math::translate(-obb.center);
-        math::Vec4 ray_dir = rotation * math::Vec4(ray.direction, 0);
-        math::Vec4 ray_origin = obb_space * math::Vec4(ray.origin, 1);
-        // AABB slab test
-        f32 tmin = -math::infinity;
-        f32 tmax = math::infinity;
-        for(int i = 0; i < 3; ++i) {
-            f32 tx1 = (obb.halfwidths[i] - ray_origin[i]) / ray_dir[i];
-            f32 tx2 = (-obb.halfwidths[i] - ray_origin[i]) / ray_dir[i];
-            tmax = math::min(tmax, math::max(tx1, tx2));
-            tmin = math::max(tmin, math::min(tx1, tx2));
+    // find_critical_points
+    // Finds the points within (a, b) where the derivative of a polynomial of degree 3 or 4 changes its sign.
+    // The derivative is split into monotonic segments at the points where its own derivative changes its sign.
+    //
+    // Returns:
+    // The number of points written to points in increasing order. At most degree - 1.
+    //
+    inline i64 find_critical_points(f64 const* const coefficients, i64 const degree, f64 const a, f64 const b, f64* const points) {
+        f64 derivative[4];
+        for(i64 i = 1; i <= degree; ++i) {
+            derivative[i - 1] = static_cast<f64>(i) * coefficients[i];
         }
 
-        if(tmax >= 0 && tmax >= tmin) {
-            Raycast_Hit out;
-            out.distance = tmax;
-            out.hit_point = ray.origin + ray.direction * tmax;
-            return out;
+        f64 bounds[5];
+        i64 bound_count = 0;
+        bounds[bound_count++] = a;
+        if(degree == 3) {
+            // The derivative is a quadratic with the minimum or maximum at its vertex.
+            f64 const vertex = -derivative[1] / (2.0 * derivative[2]);
+            if(vertex > a && vertex < b) {
+                bounds[bound_count++] = vertex;
+            }
         } else {
-            return null_optional;
+            bound_count += find_critical_points(derivative, degree - 1, a, b, bounds + 1);
         }
+        bounds[bound_count++] = b;
+
+        f64 second_derivative[3];
+        for(i64 i = 1; i < degree; ++i) {
+            second_derivative[i - 1] = static_cast<f64>(i) * derivative[i];
+        }
+
+        i64 count = 0;
+        for(i64 i = 0; i + 1 < bound_count; ++i) {
+            f64 const left = evaluate_polynomial(derivative, degree - 1, bounds[i]);
+            f64 const right = evaluate_polynomial(derivative, degree - 1, bounds[i + 1]);
+            if((left < 0.0) != (right < 0.0)) {
+                points[count++] = find_monotonic_root(derivative, second_derivative, degree - 1, bounds[i], bounds[i + 1]);
+            }
+        }
+        return count;
     }
 
-    inline Optional<Raycast_Hit> intersect_ray_cylinder(math::Ray const ray, math::Vec3 const vertex1, math::Vec3 const vertex2, f32 const radius) {
-        Optional<Raycast_Hit> result = null_optional;
-
-        f32 const radius_squared = radius * radius;
-        math::Vec3 const ray_origin = ray.origin - vertex1;
-        math::Vec3 const vert2 = vertex2 - vertex1;
-        math::Vec3 const cylinder_normal = normalize(vert2);
-        f32 const ray_dir_prim_len = dot(ray.direction, cylinder_normal);
-        f32 const a = length_squared(ray.direction) - ray_dir_prim_len * ray_dir_prim_len;
-        f32 const ray_origin_prim_len = dot(ray_origin, cylinder_normal);
-        f32 const b = 2.0f * dot(ray_origin, ray.direction) - 2.0f * ray_origin_prim_len * ray_dir_prim_len;
-        f32 const c = length_squared(ray_origin) - ray_origin_prim_len * ray_origin_prim_len - radius_squared;
-        f32 const cap2_plane_dist = dot(vert2, -cylinder_normal);
-        if(a > math::epsilon || a < -math::epsilon) {
-            f32 const delta = b * b - 4 * a * c;
-            if(delta >= 0.0f) {
-                f32 const delta_sqrt = math::sqrt(delta);
-                f32 const t1 = 0.5f * (-b - delta_sqrt) / a;
-                math::Vec3 const t1v = ray_origin + ray.direction * t1;
-                if(t1 >= 0.0f && dot(t1v, cylinder_normal) >= 0 && dot(t1v, -cylinder_normal) >= cap2_plane_dist) {
-                    Raycast_Hit hit;
-                    hit.distance = t1;
-                    hit.hit_point = t1v + vertex1;
-                    result = hit;
-                }
-
-                f32 const t2 = 0.5f * (-b + delta_sqrt) / a;
-                math::Vec3 const t2v = ray_origin + ray.direction * t2;
-                if(t2 >= 0.0f && (!result || t2 < t1) && dot(t2v, cylinder_normal) >= 0 && dot(t2v, -cylinder_normal) >= cap2_plane_dist) {
-                    Raycast_Hit hit;
-                    hit.distance = t2;
-                    hit.hit_point = t2v + vertex1;
-                    result = hit;
-                }
+    // intersect_ray_torus
+    // Exact test of a ray against a torus. The ray is first clipped to the slab |h| <= minor_radius around the plane
+    // of the torus and to the cylinder of radius major_radius + minor_radius around the axis, which rejects most rays.
+    // The remaining part of the ray is searched for the first root of the quartic of the torus.
+    //
+    // Parameters:
+    //             ray - the ray to test. The direction must be normalized.
+    //          center - the center of the torus.
+    //            axis - the normalized axis of the torus.
+    //    major_radius - the distance of the center of the tube from the axis.
+    //    minor_radius - the radius of the tube.
+    //
+    // Returns:
+    // The nearest hit, the origin of the ray if it starts inside the torus, or null_optional if the ray misses the torus.
+    //
+    inline Optional<Raycast_Hit> intersect_ray_torus(math::Ray const ray, math::Vec3 const center, math::Vec3 const axis, f32 const major_radius,
+                                                     f32 const minor_radius) {
+        math::Vec3 const offset = ray.origin - center;
+        f32 const offset_h = math::dot(offset, axis);
+        f32 const direction_h = math::dot(ray.direction, axis);
+        f32 t_min = 0.0f;
+        f32 t_max = math::infinity;
+        // Slab.
+        if(math::abs(direction_h) > math::epsilon) {
+            f32 const t1 = (minor_radius - offset_h) / direction_h;
+            f32 const t2 = (-minor_radius - offset_h) / direction_h;
+            t_min = math::max(t_min, math::min(t1, t2));
+            t_max = math::min(t_max, math::max(t1, t2));
+        } else if(math::abs(offset_h) > minor_radius) {
+            return null_optional;
+        }
+
+        if(t_min > t_max) {
+            return null_optional;
+        }
+
+        // Bounding cylinder.
+        f32 const outer_radius = major_radius + minor_radius;
+        math::Vec3 const offset_radial = offset - axis * offset_h;
+        math::Vec3 const direction_radial = ray.direction - axis * direction_h;
+        f32 const a = math::dot(direction_radial, direction_radial);
+        f32 const b = math::dot(offset_radial, direction_radial);
+        f32 const c = math::dot(offset_radial, offset_radial) - outer_radius * outer_radius;
+        if(a > math::epsilon) {
+            f32 const discriminant = b * b - a * c;
+            if(discriminant < 0.0f) {
+                return null_optional;
             }
-        } else {
-            // Ray is parallel to the cylinder
-            if(length_squared(ray_origin - ray_origin_prim_len * cylinder_normal) == radius_squared && dot(ray_origin, cylinder_normal) >= 0 &&
-               dot(ray_origin, -cylinder_normal) >= cap2_plane_dist) {
-                // Ray origin lies on the cylinder boundary
-                Raycast_Hit hit;
-                hit.distance = 0.0f;
-                hit.hit_point = ray.origin;
-                result = hit;
+
+            f32 const root = math::sqrt(discriminant);
+            t_min = math::max(t_min, (-b - root) / a);
+            t_max = math::min(t_max, (-b + root) / a);
+            if(t_min > t_max) {
+                return null_optional;
             }
+        } else if(c > 0.0f) {
+            return null_optional;
+        }
+
+        // The quartic (|p|^2 + R^2 - r^2)^2 - 4R^2 * |p_radial|^2 with p = o + s * d and |d| = 1 in the distance s along
+        // the ray from the start of the clipped part, which keeps the coefficients small.
+        f64 const o_h = static_cast<f64>(offset_h) + static_cast<f64>(t_min) * direction_h;
+        f64 const o_x = static_cast<f64>(offset_radial.x) + static_cast<f64>(t_min) * direction_radial.x;
+        f64 const o_y = static_cast<f64>(offset_radial.y) + static_cast<f64>(t_min) * direction_radial.y;
+        f64 const o_z = static_cast<f64>(offset_radial.z) + static_cast<f64>(t_min) * direction_radial.z;
+        f64 const d_h = direction_h;
+        f64 const d_x = direction_radial.x;
+        f64 const d_y = direction_radial.y;
+        f64 const d_z = direction_radial.z;
+        f64 const radial_squared = o_x * o_x + o_y * o_y + o_z * o_z;
+        f64 const radial_dot = o_x * d_x + o_y * d_y + o_z * d_z;
+        f64 const direction_radial_squared = d_x * d_x + d_y * d_y + d_z * d_z;
+        f64 const major_squared = static_cast<f64>(major_radius) * major_radius;
+        f64 const minor_squared = static_cast<f64>(minor_radius) * minor_radius;
+        f64 const n = radial_dot + o_h * d_h;
+        f64 const k = radial_squared + o_h * o_h + major_squared - minor_squared;
+        f64 const coefficients[5] = {k * k - 4.0 * major_squared * radial_squared, 4.0 * n * k - 8.0 * major_squared * radial_dot,
+                                     4.0 * n * n + 2.0 * k - 4.0 * major_squared * direction_radial_squared, 4.0 * n, 1.0};
+        f64 const length = static_cast<f64>(t_max) - t_min;
+        if(coefficients[0] <= 0.0) {
+            // The clipped part starts inside the torus.
+            return make_raycast_hit(ray, t_min);
         }
 
-        // Cap 1
-        {
-            f32 const plane_distance = math::dot(vertex1, cylinder_normal);
-            auto res = intersect_ray_plane(ray, cylinder_normal, plane_distance);
-            if(res && length_squared(res->hit_point - vertex1) <= radius_squared && (!result || res->distance < result->distance)) {
-                result = res;
+        // The polynomial is positive outside of the torus. The first root lies in the first monotonic segment
+        // whose end is not positive.
+        f64 points[5];
+        i64 point_count = 0;
+        points[point_count++] = 0.0;
+        point_count += find_critical_points(coefficients, 4, 0.0, length, points + 1);
+        points[point_count++] = length;
+        f64 derivative[4];
+        for(i64 i = 1; i <= 4; ++i) {
+            derivative[i - 1] = static_cast<f64>(i) * coefficients[i];
+        }
+
+        for(i64 i = 1; i < point_count; ++i) {
+            if(evaluate_polynomial(coefficients, 4, points[i]) <= 0.0) {
+                f64 const s = find_monotonic_root(coefficients, derivative, 4, points[i - 1], points[i]);
+                return make_raycast_hit(ray, t_min + static_cast<f32>(s));
             }
         }
+        return null_optional;
+    }
 
-        // Cap 2
-        {
-            f32 const plane_distance = math::dot(vertex2, cylinder_normal);
-            auto res = intersect_ray_plane(ray, cylinder_normal, plane_distance);
-            if(res && length_squared(res->hit_point - vertex2) <= radius_squared && (!result || res->distance < result->distance)) {
-                result = res;
+    // find_nearest_ray
+    // Sets the distances past the count of the packet to infinity and finds the nearest hit of the packet.
+    //
+    inline void find_nearest_ray(Ray_Packet const& packet, Ray_Packet_Hits& hits) {
+        hits.nearest_ray = -1;
+        hits.nearest_distance = math::infinity;
+        for(i64 i = 0; i < max_ray_packet_size; ++i) {
+            if(i >= packet.count) {
+                hits.distances[i] = math::infinity;
+            } else if(hits.distances[i] < hits.nearest_distance) {
+                hits.nearest_ray = i;
+                hits.nearest_distance = hits.distances[i];
             }
         }
+    }
 
-        return result;
+    // intersect_ray_packet
+    // Runs kernel(origin, direction) for groups of simd::lane_count rays of the packet. kernel returns the distances along
+    // the rays to the hits or infinity for the rays that miss.
+    //
+    template<typename Kernel>
+    [[nodiscard]] Ray_Packet_Hits intersect_ray_packet(Ray_Packet const& packet, Kernel const& kernel) {
+        Ray_Packet_Hits hits;
+        // The packet is padded to max_ray_packet_size, which is a multiple of the lane count.
+        for(i64 i = 0; i < packet.count; i += simd::lane_count) {
+            simd::Float3 const origin{simd::load(packet.origin_x + i), simd::load(packet.origin_y + i), simd::load(packet.origin_z + i)};
+            simd::Float3 const direction{simd::load(packet.direction_x + i), simd::load(packet.direction_y + i), simd::load(packet.direction_z + i)};
+            simd::store(hits.distances + i, kernel(origin, direction));
+        }
+        find_nearest_ray(packet, hits);
+        return hits;
     }
 
-    inline Optional<Raycast_Hit> intersect_ray_cylinder_uncapped(math::Ray const ray, math::Vec3 const vertex1, math::Vec3 const vertex2, f32 const radius) {
-        Optional<Raycast_Hit> result = null_optional;
-
-        f32 const radius_squared = radius * radius;
-        math::Vec3 const ray_origin = ray.origin - vertex1;
-        math::Vec3 const vert2 = vertex2 - vertex1;
-        math::Vec3 const cylinder_normal = normalize(vert2);
-        f32 const ray_dir_prim_len = dot(ray.direction, cylinder_normal);
-        f32 const a = length_squared(ray.direction) - ray_dir_prim_len * ray_dir_prim_len;
-        f32 const ray_origin_prim_len = dot(ray_origin, cylinder_normal);
-        f32 const b = 2.0f * dot(ray_origin, ray.direction) - 2.0f * ray_origin_prim_len * ray_dir_prim_len;
-        f32 const c = length_squared(ray_origin) - ray_origin_prim_len * ray_origin_prim_len - radius_squared;
-        f32 const cap2_plane_dist = dot(vert2, -cylinder_normal);
-        if(a > math::epsilon || a < -math::epsilon) {
-            f32 const delta = b * b - 4 * a * c;
-            if(delta >= 0.0f) {
-                f32 const delta_sqrt = math::sqrt(delta);
-                f32 const t1 = 0.5f * (-b - delta_sqrt) / a;
-                math::Vec3 const t1v = ray_origin + ray.direction * t1;
-                if(t1 >= 0.0f && dot(t1v, cylinder_normal) >= 0 && dot(t1v, -cylinder_normal) >= cap2_plane_dist) {
-                    Raycast_Hit hit;
-                    hit.distance = t1;
-                    hit.hit_point = t1v + vertex1;
-                    result = hit;
-                }
-
-                f32 const t2 = 0.5f * (-b + delta_sqrt) / a;
-                math::Vec3 const t2v = ray_origin + ray.direction * t2;
-                if(t2 >= 0.0f && (!result || t2 < t1) && dot(t2v, cylinder_normal) >= 0 && dot(t2v, -cylinder_normal) >= cap2_plane_dist) {
-                    Raycast_Hit hit;
-                    hit.distance = t2;
-                    hit.hit_point = t2v + vertex1;
-                    result = hit;
-                }
-            }
-        } else {
-            // Ray is parallel to the cylinder
-            if(length_squared(ray_origin - ray_origin_prim_len * cylinder_normal) == radius_squared && dot(ray_origin, cylinder_normal) >= 0 &&
-               dot(ray_origin, -cylinder_normal) >= cap2_plane_dist) {
-                // Ray origin lies on the cylinder boundary
-                Raycast_Hit hit;
-                hit.distance = 0.0f;
-                hit.hit_point = ray.origin;
-                result = hit;
-            }
+    // intersect_ray_packet_serial
+    // Runs kernel(ray) for every ray of the packet. kernel returns the distance along the ray to the hit or infinity
+    // if the ray misses.
+    //
+    template<typename Kernel>
+    [[nodiscard]] Ray_Packet_Hits intersect_ray_packet_serial(Ray_Packet const& packet, Kernel const& kernel) {
+        Ray_Packet_Hits hits;
+        for(i64 i = 0; i < packet.count; ++i) {
+            math::Ray const ray{math::Vec3{packet.origin_x[i], packet.origin_y[i], packet.origin_z[i]},
+                                math::Vec3{packet.direction_x[i], packet.direction_y[i], packet.direction_z[i]}};
+            hits.distances[i] = kernel(ray);
         }
+        find_nearest_ray(packet, hits);
+        return hits;
+    }
 
-        return result;
+    [[nodiscard]] inline simd::Float3 broadcast_vec3(math::Vec3 const& vector) {
+        return {simd::broadcast(vector.x), simd::broadcast(vector.y), simd::broadcast(vector.z)};
     }
 } // namespace anton::gizmo
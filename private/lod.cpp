@@ -0,0 +1,151 @@
+#include <anton/gizmo/lod.hpp>
+
+#include <anton/gizmo/shapes.hpp>
+#include <anton/math/vec4.hpp>
+
+namespace anton::gizmo {
+    // The largest distance between a circle of radius and a regular polygon with vertex_count vertices inscribed in it.
+    [[nodiscard]] static f32 calculate_polygon_error(f32 const radius, i32 const vertex_count) {
+        return radius * (1.0f - math::cos(math::pi / static_cast<f32>(vertex_count)));
+    }
+
+    [[nodiscard]] static Slice<math::Vec3> get_level_vertices(LOD_Chain& chain, LOD_Level const& level) {
+        math::Vec3* const first = chain.vertices.data() + level.first_vertex;
+        return Slice<math::Vec3>{first, first + level.vertex_count};
+    }
+
+    // Allocates the vertices of all levels after the vertex counts of the levels have been filled in.
+    static void allocate_levels(LOD_Chain& chain) {
+        i64 vertex_count = 0;
+        for(LOD_Level& level: chain.levels) {
+            level.first_vertex = vertex_count;
+            vertex_count += level.vertex_count;
+        }
+        chain.vertices.resize(vertex_count);
+    }
+
+    static void calculate_bounding_radius(LOD_Chain& chain) {
+        f32 radius_squared = 0.0f;
+        for(math::Vec3 const& vertex: chain.vertices) {
+            radius_squared = math::max(radius_squared, math::length_squared(vertex));
+        }
+        chain.bounding_radius = math::sqrt(radius_squared);
+    }
+
+    [[nodiscard]] static i32 halve_vertex_count(i32 const vertex_count) {
+        return math::max(vertex_count / 2, 3);
+    }
+
+    LOD_Chain generate_arrow_3d_lod_chain(Arrow_3D const& arrow, i32 const vertex_count, i32 const level_count) {
+        LOD_Chain chain{Array<math::Vec3>{}, Array<LOD_Level>{reserve, level_count}, 0.0f};
+        Array<i32> level_vertex_counts{reserve, level_count};
+        // The cube of the cube style is exact, only the shaft and the cone are tessellated.
+        f32 const radius = 0.5f * (arrow.draw_style == Arrow_3D_Style::cone ? math::max(arrow.cap_size, arrow.shaft_diameter) : arrow.shaft_diameter);
+        i32 count = vertex_count;
+        for(i32 i = 0; i < level_count; ++i) {
+            if(i > 0) {
+                i32 const next = halve_vertex_count(count);
+                if(next == count) {
+                    break;
+                }
+
+                count = next;
+            }
+
+            chain.levels.emplace_back(LOD_Level{0, arrow_3d_vertex_count(arrow, count), calculate_polygon_error(radius, count)});
+            level_vertex_counts.emplace_back(count);
+        }
+
+        allocate_levels(chain);
+        for(i64 i = 0; i < chain.levels.size(); ++i) {
+            generate_arrow_3d_geometry(arrow, level_vertex_counts[i], get_level_vertices(chain, chain.levels[i]));
+        }
+        calculate_bounding_radius(chain);
+        return chain;
+    }
+
+    LOD_Chain generate_dial_3d_lod_chain(Dial_3D const& dial, i32 const vertex_count_major, i32 const vertex_count_minor, i32 const level_count,
+                                         Primitive_Topology const topology) {
+        LOD_Chain chain{Array<math::Vec3>{}, Array<LOD_Level>{reserve, level_count}, 0.0f};
+        Array<i32> level_vertex_counts{reserve, 2 * level_count};
+        i32 count_major = vertex_count_major;
+        i32 count_minor = vertex_count_minor;
+        for(i32 i = 0; i < level_count; ++i) {
+            if(i > 0) {
+                i32 const next_major = halve_vertex_count(count_major);
+                i32 const next_minor = halve_vertex_count(count_minor);
+                if(next_major == count_major && next_minor == count_minor) {
+                    break;
+                }
+
+                count_major = next_major;
+                count_minor = next_minor;
+            }
+
+            f32 const error =
+                calculate_polygon_error(dial.major_radius + dial.minor_radius, count_major) + calculate_polygon_error(dial.minor_radius, count_minor);
+            chain.levels.emplace_back(LOD_Level{0, dial_3d_vertex_count(count_major, count_minor, topology), error});
+            level_vertex_counts.emplace_back(count_major);
+            level_vertex_counts.emplace_back(count_minor);
+        }
+
+        allocate_levels(chain);
+        for(i64 i = 0; i < chain.levels.size(); ++i) {
+            generate_dial_3d_geometry(dial, level_vertex_counts[2 * i], level_vertex_counts[2 * i + 1], get_level_vertices(chain, chain.levels[i]), topology);
+        }
+        calculate_bounding_radius(chain);
+        return chain;
+    }
+
+    LOD_Chain generate_icosphere_lod_chain(i64 const subdivision_level, i32 const level_count) {
+        LOD_Chain chain{Array<math::Vec3>{}, Array<LOD_Level>{reserve, level_count}, 0.0f};
+        for(i64 level = subdivision_level; level >= 0 && chain.levels.size() < level_count; --level) {
+            chain.levels.emplace_back(LOD_Level{0, icosphere_vertex_count(level), 0.0f});
+        }
+
+        allocate_levels(chain);
+        for(i64 i = 0; i < chain.levels.size(); ++i) {
+            LOD_Level& level = chain.levels[i];
+            Slice<math::Vec3> const vertices = get_level_vertices(chain, level);
+            generate_icosphere(subdivision_level - i, vertices);
+            // The triangles are not equal, therefore the error is the largest distance from the plane of any triangle to the sphere.
+            f32 min_distance = 1.0f;
+            for(i64 v = 0; v < vertices.size(); v += 3) {
+                math::Vec3 const normal = math::normalize(math::cross(vertices[v + 1] - vertices[v], vertices[v + 2] - vertices[v]));
+                min_distance = math::min(min_distance, math::abs(math::dot(normal, vertices[v])));
+            }
+            level.error = 1.0f - min_distance;
+        }
+        calculate_bounding_radius(chain);
+        return chain;
+    }
+
+    f32 calculate_screen_radius(f32 const bounding_radius, math::Mat4 const& world_transform, math::Mat4 const& view_transform,
+                                math::Mat4 const& projection_matrix, math::Vec2 const viewport_size) {
+        f32 const scale = math::length(world_transform[0]);
+        f32 const radius = scale * bounding_radius;
+        math::Vec4 const origin_view = view_transform * (world_transform * math::Vec4{0.0f, 0.0f, 0.0f, 1.0f});
+        math::Vec4 const origin_clip = projection_matrix * origin_view;
+        // w is the distance along the view direction for perspective projections and 1 for orthographic projections.
+        // For perspective projections clamping it to the radius bounds the result by the size of the viewport
+        // when the camera is inside the sphere.
+        bool const perspective = projection_matrix[3][3] == 0.0f;
+        f32 const w = perspective ? math::max(origin_clip.w, radius) : origin_clip.w;
+        return 0.5f * viewport_size.y * projection_matrix[1][1] * radius / w;
+    }
+
+    i64 select_lod_level(LOD_Chain const& chain, f32 const screen_radius, f32 const max_error) {
+        // An empty chain has no bounding radius to divide by.
+        if(chain.levels.size() == 0 || chain.bounding_radius <= 0.0f) {
+            return 0;
+        }
+
+        f32 const pixels_per_unit = screen_radius / chain.bounding_radius;
+        for(i64 i = chain.levels.size() - 1; i > 0; --i) {
+            if(chain.levels[i].error * pixels_per_unit <= max_error) {
+                return i;
+            }
+        }
+        return 0;
+    }
+} // namespace anton::gizmo
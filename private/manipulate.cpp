@@ -1,227 +1,423 @@
 #include <anton/gizmo/manipulate.hpp>
 
 #include <intersection_tests.hpp>
+#include <simd.hpp>
 #include <utils.hpp>
 
 namespace anton::gizmo {
     math::Vec3 translate_along_line(math::Mat4 const inverse_parent_transform, math::Ray const ray, math::Vec3 const axis, math::Vec3 const origin,
                                     math::Ray const initial_ray, math::Vec3 const initial_position, f32 const snap) {
-        math::Vec3 const point_on_axis = origin + axis * math::dot(ray.origin - origin, axis);
-        math::Vec3 const plane_normal = math::normalize(ray.origin - point_on_axis);
-        f32 const plane_distance = math::dot(origin, plane_normal);
-        // Calculate cursor offset that we'll use to prevent the center of the object from snapping to the cursor
-        auto const initial_res = intersect_ray_plane(initial_ray, plane_normal, plane_distance);
-        if(!initial_res) {
-            return initial_position;
-        }
-
-        auto const res = intersect_ray_plane(ray, plane_normal, plane_distance);
-        if(res) {
-            math::Vec3 const delta = res->hit_point - initial_res->hit_point;
-            f32 delta_length = math::dot(delta, axis);
-            if(snap != 0.0f) {
-                delta_length = math::round_to_nearest(delta_length, snap);
-            }
-            math::Vec3 const delta_snap = delta_length * axis;
-            math::Vec3 const local_delta{inverse_parent_transform * math::Vec4{delta_snap, 0.0f}};
-            return initial_position + local_delta;
-        } else {
-            return initial_position;
-        }
+        Manipulation_Session session =
+            Manipulation_Session::translate_along_line(inverse_parent_transform, axis, origin, initial_ray, initial_position, snap);
+        return session.update(ray).vector;
     }
 
     math::Vec3 translate_along_plane(math::Mat4 const inverse_parent_transform, math::Ray const ray, math::Vec3 const first_axis, math::Vec3 const second_axis,
                                      math::Vec3 const origin, math::Ray const initial_ray, math::Vec3 const initial_position, f32 const snap) {
-        // The axes are NOT necessarily perpendicular
-        math::Vec3 const plane_normal = math::normalize(math::cross(first_axis, second_axis));
-        f32 const plane_distance = math::dot(origin, plane_normal);
+        Manipulation_Session session =
+            Manipulation_Session::translate_along_plane(inverse_parent_transform, first_axis, second_axis, origin, initial_ray, initial_position, snap);
+        return session.update(ray).vector;
+    }
+
+    math::Vec3 scale_along_line(math::Ray const ray, math::Vec3 const axis_world, math::Vec3 const axis_local, math::Vec3 const origin,
+                                math::Ray const initial_ray, math::Vec3 const initial_scale, f32 const snap) {
+        Manipulation_Session session = Manipulation_Session::scale_along_line(axis_world, axis_local, origin, initial_ray, initial_scale, snap);
+        return session.update(ray).vector;
+    }
+
+    math::Vec3 scale_along_plane(math::Ray const ray, math::Vec3 const first_axis_world, math::Vec3 const first_axis_local, math::Vec3 const second_axis_world,
+                                 math::Vec3 const second_axis_local, math::Vec3 const origin, math::Ray const initial_ray, math::Vec3 const initial_scale,
+                                 f32 const snap) {
+        Manipulation_Session session = Manipulation_Session::scale_along_plane(first_axis_world, first_axis_local, second_axis_world, second_axis_local,
+                                                                               origin, initial_ray, initial_scale, snap);
+        return session.update(ray).vector;
+    }
+
+    math::Vec3 scale_uniform_along_line(math::Ray const ray, math::Vec3 const axis, math::Vec3 const origin, math::Ray const initial_ray,
+                                        math::Vec3 const initial_scale, f32 const snap) {
+        Manipulation_Session session = Manipulation_Session::scale_uniform_along_line(axis, origin, initial_ray, initial_scale, snap);
+        return session.update(ray).vector;
+    }
+
+    math::Vec3 scale_uniform_along_plane(math::Ray const ray, math::Vec3 const first_axis, math::Vec3 const second_axis, math::Vec3 const origin,
+                                         math::Ray const initial_ray, math::Vec3 const initial_scale, f32 const snap) {
+        Manipulation_Session session = Manipulation_Session::scale_uniform_along_plane(first_axis, second_axis, origin, initial_ray, initial_scale, snap);
+        return session.update(ray).vector;
+    }
+
+    math::Quat orient_turn(math::Ray const ray, math::Vec3 const axis, math::Vec3 const origin, math::Ray const initial_ray,
+                           math::Quat const initial_orientation, f32 const snap) {
+        Manipulation_Session session = Manipulation_Session::orient_turn(axis, origin, initial_ray, initial_orientation, snap);
+        return session.update(ray).orientation;
+    }
+
+    math::Quat orient_trackball(math::Ray const ray, math::Vec3 const first_axis, math::Vec3 const second_axis, math::Vec3 const origin,
+                                math::Ray const initial_ray, math::Quat const initial_orientation, f32 const snap) {
+        Manipulation_Session session = Manipulation_Session::orient_trackball(first_axis, second_axis, origin, initial_ray, initial_orientation, snap);
+        return session.update(ray).orientation;
+    }
+
+    Manipulation_Session::Manipulation_Session(Mode const mode, math::Vec3 const origin, math::Ray const initial_ray, f32 const snap)
+        : mode(mode), snap(snap), origin(origin), initial_ray(initial_ray), axis(), first_axis(), second_axis(), plane_normal(), plane_distance(0.0f),
+          plane_ray_origin(), has_plane(false), initial_hit(null_optional), first_dual(), second_dual(), parent_first_axis(), parent_second_axis(), initial_vector(),
+          scaled_axis(), scaled_weight(1.0f), scaled_axis_weight(0.0f), initial_orientation() {}
+
+    void Manipulation_Session::set_plane(math::Vec3 const normal) {
+        plane_normal = normal;
+        plane_distance = math::dot(origin, plane_normal);
+        has_plane = true;
         // Calculate cursor offset that we'll use to prevent the center of the object from snapping to the cursor
         auto const initial_res = intersect_ray_plane(initial_ray, plane_normal, plane_distance);
-        if(!initial_res) {
-            return initial_position;
-        }
-
-        auto res = intersect_ray_plane(ray, plane_normal, plane_distance);
-        if(res) {
-            math::Vec3 const point = res->hit_point - initial_res->hit_point;
-            math::Mat4 const transform{math::Vec4{first_axis, 0.0f}, math::Vec4{second_axis, 0.0f}, math::Vec4{plane_normal, 0.0f},
-                                       math::Vec4{0.0f, 0.0f, 0.0f, 1.0f}};
-            math::Mat4 const inv_transform = math::inverse(transform);
-            math::Vec3 const transformed_point{inv_transform * math::Vec4{point, 1.0f}};
-            f32 first_factor = transformed_point.x;
-            f32 second_factor = transformed_point.y;
-            if(snap != 0.0f) {
-                first_factor = math::round_to_nearest(first_factor, snap);
-                second_factor = math::round_to_nearest(second_factor, snap);
-            }
-            math::Vec3 const delta = first_factor * first_axis + second_factor * second_axis;
-            math::Vec3 const local_delta{inverse_parent_transform * math::Vec4{delta, 0.0f}};
-            return initial_position + local_delta;
+        if(initial_res) {
+            initial_hit = initial_res->hit_point;
         } else {
-            return initial_position;
+            initial_hit = null_optional;
         }
     }
 
-    math::Vec3 scale_along_line(math::Ray const ray, math::Vec3 const axis_world, math::Vec3 const axis_local, math::Vec3 const origin,
-                                math::Ray const initial_ray, math::Vec3 const initial_scale, f32 const snap) {
-        math::Vec3 const point_on_axis = origin + axis_world * math::dot(ray.origin - origin, axis_world);
-        math::Vec3 const plane_normal = math::normalize(ray.origin - point_on_axis);
-        f32 const plane_distance = math::dot(origin, plane_normal);
-        auto const initial_res = intersect_ray_plane(initial_ray, plane_normal, plane_distance);
-        if(!initial_res) {
-            return initial_scale;
+    void Manipulation_Session::set_line_plane(math::Vec3 const ray_origin) {
+        math::Vec3 const point_on_axis = origin + axis * math::dot(ray_origin - origin, axis);
+        plane_ray_origin = ray_origin;
+        set_plane(math::normalize(ray_origin - point_on_axis));
+    }
+
+    Manipulation_Session Manipulation_Session::translate_along_line(math::Mat4 const& inverse_parent_transform, math::Vec3 const axis, math::Vec3 const origin,
+                                                                    math::Ray const initial_ray, math::Vec3 const initial_position, f32 const snap) {
+        Manipulation_Session session(Mode::translate_along_line, origin, initial_ray, snap);
+        session.axis = axis;
+        session.parent_first_axis = math::Vec3{inverse_parent_transform * math::Vec4{axis, 0.0f}};
+        session.initial_vector = initial_position;
+        return session;
+    }
+
+    Manipulation_Session Manipulation_Session::translate_along_plane(math::Mat4 const& inverse_parent_transform, math::Vec3 const first_axis,
+                                                                     math::Vec3 const second_axis, math::Vec3 const origin, math::Ray const initial_ray,
+                                                                     math::Vec3 const initial_position, f32 const snap) {
+        Manipulation_Session session(Mode::translate_along_plane, origin, initial_ray, snap);
+        session.first_axis = first_axis;
+        session.second_axis = second_axis;
+        // The axes are NOT necessarily perpendicular
+        session.set_plane(math::normalize(math::cross(first_axis, second_axis)));
+        // The rows of the inverse of the basis (first_axis, second_axis, plane_normal).
+        math::Vec3 const first_cross = math::cross(second_axis, session.plane_normal);
+        math::Vec3 const second_cross = math::cross(session.plane_normal, first_axis);
+        session.first_dual = first_cross / math::dot(first_axis, first_cross);
+        session.second_dual = second_cross / math::dot(second_axis, second_cross);
+        session.parent_first_axis = math::Vec3{inverse_parent_transform * math::Vec4{first_axis, 0.0f}};
+        session.parent_second_axis = math::Vec3{inverse_parent_transform * math::Vec4{second_axis, 0.0f}};
+        session.initial_vector = initial_position;
+        return session;
+    }
+
+    Manipulation_Session Manipulation_Session::scale_along_line(math::Vec3 const axis_world, math::Vec3 const axis_local, math::Vec3 const origin,
+                                                                math::Ray const initial_ray, math::Vec3 const initial_scale, f32 const snap) {
+        Manipulation_Session session(Mode::scale_along_line, origin, initial_ray, snap);
+        session.axis = axis_world;
+        session.initial_vector = initial_scale;
+        // Only the scale along axis changes. The rest of the scale should not be changed.
+        session.scaled_axis = axis_local;
+        session.scaled_weight = 0.0f;
+        session.scaled_axis_weight = 1.0f;
+        return session;
+    }
+
+    Manipulation_Session Manipulation_Session::scale_along_plane(math::Vec3 const first_axis_world, math::Vec3 const first_axis_local,
+                                                                 math::Vec3 const second_axis_world, math::Vec3 const second_axis_local,
+                                                                 math::Vec3 const origin, math::Ray const initial_ray, math::Vec3 const initial_scale,
+                                                                 f32 const snap) {
+        Manipulation_Session session(Mode::scale_along_plane, origin, initial_ray, snap);
+        // The axes are NOT necessarily perpendicular
+        session.set_plane(math::normalize(math::cross(first_axis_world, second_axis_world)));
+        session.initial_vector = initial_scale;
+        // The scale that is not in the plane defined by the local axes should not be modified.
+        session.scaled_axis = math::normalize(math::cross(first_axis_local, second_axis_local));
+        session.scaled_weight = 1.0f;
+        session.scaled_axis_weight = -1.0f;
+        return session;
+    }
+
+    Manipulation_Session Manipulation_Session::scale_uniform_along_line(math::Vec3 const axis, math::Vec3 const origin, math::Ray const initial_ray,
+                                                                        math::Vec3 const initial_scale, f32 const snap) {
+        Manipulation_Session session(Mode::scale_along_line, origin, initial_ray, snap);
+        session.axis = axis;
+        session.initial_vector = initial_scale;
+        return session;
+    }
+
+    Manipulation_Session Manipulation_Session::scale_uniform_along_plane(math::Vec3 const first_axis, math::Vec3 const second_axis, math::Vec3 const origin,
+                                                                         math::Ray const initial_ray, math::Vec3 const initial_scale, f32 const snap) {
+        Manipulation_Session session(Mode::scale_along_plane, origin, initial_ray, snap);
+        session.set_plane(math::normalize(math::cross(first_axis, second_axis)));
+        session.initial_vector = initial_scale;
+        return session;
+    }
+
+    Manipulation_Session Manipulation_Session::orient_turn(math::Vec3 const axis, math::Vec3 const origin, math::Ray const initial_ray,
+                                                           math::Quat const initial_orientation, f32 const snap) {
+        Manipulation_Session session(Mode::orient_turn, origin, initial_ray, snap);
+        session.set_plane(axis);
+        session.initial_orientation = initial_orientation;
+        return session;
+    }
+
+    Manipulation_Session Manipulation_Session::orient_trackball(math::Vec3 const first_axis, math::Vec3 const second_axis, math::Vec3 const origin,
+                                                                math::Ray const initial_ray, math::Quat const initial_orientation, f32 const snap) {
+        Manipulation_Session session(Mode::orient_trackball, origin, initial_ray, snap);
+        session.set_plane(math::normalize(math::cross(first_axis, second_axis)));
+        session.initial_orientation = initial_orientation;
+        return session;
+    }
+
+    Optional<math::Vec3> Manipulation_Session::intersect_plane(math::Ray const& ray) {
+        // The plane of the line modes faces the origin of the ray.
+        bool const line_mode = mode == Mode::translate_along_line || mode == Mode::scale_along_line;
+        if(line_mode && (!has_plane || ray.origin != plane_ray_origin)) {
+            set_line_plane(ray.origin);
         }
 
-        if(auto res = intersect_ray_plane(ray, plane_normal, plane_distance)) {
-            f32 const offset_line_length = math::dot(initial_res->hit_point - origin, axis_world);
-            f32 const hit_line_length = math::dot(res->hit_point - origin, axis_world);
-            f32 factor = hit_line_length / offset_line_length;
-            if(snap != 0.0f) {
-                factor = math::round_to_nearest(factor, snap);
-            }
+        if(!initial_hit) {
+            return null_optional;
+        }
 
-            // Find out how much scale is along axis
-            math::Vec3 const scale_along_axis = math::dot(initial_scale, axis_local) * axis_local;
-            // The rest of the scale should not be changed
-            math::Vec3 const remaining_scale = initial_scale - scale_along_axis;
-            return factor * scale_along_axis + remaining_scale;
-        } else {
-            return initial_scale;
+        auto const res = intersect_ray_plane(ray, plane_normal, plane_distance);
+        if(!res) {
+            return null_optional;
         }
+        return res->hit_point;
     }
 
-    math::Vec3 scale_along_plane(math::Ray const ray, math::Vec3 const first_axis_world, math::Vec3 const first_axis_local, math::Vec3 const second_axis_world,
-                                 math::Vec3 const second_axis_local, math::Vec3 const origin, math::Ray const initial_ray, math::Vec3 const initial_scale,
-                                 f32 const snap) {
-        // The axes are NOT necessarily perpendicular
-        math::Vec3 const plane_normal = math::normalize(math::cross(first_axis_world, second_axis_world));
-        f32 const plane_distance = math::dot(origin, plane_normal);
-        auto const initial_res = intersect_ray_plane(initial_ray, plane_normal, plane_distance);
-        if(!initial_res) {
-            return initial_scale;
-        }
-
-        if(auto res = intersect_ray_plane(ray, plane_normal, plane_distance)) {
-            math::Vec3 const origin_offset = initial_res->hit_point - origin;
-            math::Vec3 const origin_hit = res->hit_point - origin;
-            f32 const origin_offset_length = math::length(origin_offset);
-            f32 const origin_hit_length = math::length(origin_hit);
-            f32 const sign = math::dot(origin_offset, origin_hit) >= 0 ? 1 : -1;
-            f32 factor = sign * origin_hit_length / origin_offset_length;
-            if(snap != 0.0f) {
-                factor = math::round_to_nearest(factor, snap);
-            }
-            // Find out how much scale is not in the plane defined
-            // by the local axes and should not be modified.
-            math::Vec3 const plane_normal_local = math::normalize(math::cross(first_axis_local, second_axis_local));
-            math::Vec3 const remaining_scale = math::dot(initial_scale, plane_normal_local) * plane_normal_local;
-            // The rest of the scale should not be changed
-            math::Vec3 const scale_in_plane = initial_scale - remaining_scale;
-            return factor * scale_in_plane + remaining_scale;
+    math::Vec2 Manipulation_Session::calculate_translation_factors(math::Vec3 const hit) const {
+        math::Vec3 const point = hit - *initial_hit;
+        math::Vec2 factors{0.0f, 0.0f};
+        if(mode == Mode::translate_along_line) {
+            factors.x = math::dot(point, axis);
         } else {
-            return initial_scale;
+            factors.x = math::dot(point, first_dual);
+            factors.y = math::dot(point, second_dual);
         }
+
+        if(snap != 0.0f) {
+            factors.x = math::round_to_nearest(factors.x, snap);
+            factors.y = math::round_to_nearest(factors.y, snap);
+        }
+        return factors;
     }
 
-    math::Vec3 scale_uniform_along_line(math::Ray const ray, math::Vec3 const axis, math::Vec3 const origin, math::Ray const initial_ray,
-                                        math::Vec3 const initial_scale, f32 const snap) {
-        math::Vec3 const point_on_axis = origin + axis * math::dot(ray.origin - origin, axis);
-        math::Vec3 const plane_normal = math::normalize(ray.origin - point_on_axis);
-        f32 const plane_distance = math::dot(origin, plane_normal);
-        auto const initial_res = intersect_ray_plane(initial_ray, plane_normal, plane_distance);
-        if(!initial_res) {
-            return initial_scale;
+    Manipulation_Delta Manipulation_Session::update_delta(math::Ray const& ray) {
+        Manipulation_Delta delta{math::Vec3{0.0f}, 1.0f, math::Quat{}};
+        Optional<math::Vec3> const intersection = intersect_plane(ray);
+        if(!intersection) {
+            return delta;
         }
 
-        if(auto res = intersect_ray_plane(ray, plane_normal, plane_distance)) {
-            f32 const offset_line_length = math::dot(initial_res->hit_point - origin, axis);
-            f32 const hit_line_length = math::dot(res->hit_point - origin, axis);
-            f32 factor = hit_line_length / offset_line_length;
-            if(snap != 0.0f) {
-                factor = math::round_to_nearest(factor, snap);
-            }
-            return factor * initial_scale;
-        } else {
-            return initial_scale;
+        math::Vec3 const hit = *intersection;
+        switch(mode) {
+            case Mode::translate_along_line: {
+                math::Vec2 const factors = calculate_translation_factors(hit);
+                delta.translation = factors.x * axis;
+            } break;
+
+            case Mode::translate_along_plane: {
+                math::Vec2 const factors = calculate_translation_factors(hit);
+                delta.translation = factors.x * first_axis + factors.y * second_axis;
+            } break;
+
+            case Mode::scale_along_line: {
+                f32 const offset_line_length = math::dot(*initial_hit - origin, axis);
+                f32 const hit_line_length = math::dot(hit - origin, axis);
+                f32 factor = hit_line_length / offset_line_length;
+                if(snap != 0.0f) {
+                    factor = math::round_to_nearest(factor, snap);
+                }
+                delta.scale_factor = factor;
+            } break;
+
+            case Mode::scale_along_plane: {
+                math::Vec3 const origin_offset = *initial_hit - origin;
+                math::Vec3 const origin_hit = hit - origin;
+                f32 const origin_offset_length = math::length(origin_offset);
+                f32 const origin_hit_length = math::length(origin_hit);
+                f32 const sign = math::dot(origin_offset, origin_hit) >= 0 ? 1 : -1;
+                f32 factor = sign * origin_hit_length / origin_offset_length;
+                if(snap != 0.0f) {
+                    factor = math::round_to_nearest(factor, snap);
+                }
+                delta.scale_factor = factor;
+            } break;
+
+            case Mode::orient_turn: {
+                math::Vec3 const start = math::normalize(*initial_hit - origin);
+                math::Vec3 const target = math::normalize(hit - origin);
+                math::Quat const orientation_delta = math::orient_towards(start, target);
+                if(snap == 0.0f) {
+                    delta.rotation = orientation_delta;
+                } else {
+                    math::Axis_Angle const axis_angle = math::to_axis_angle(orientation_delta);
+                    f32 const new_angle = math::round_to_nearest(axis_angle.angle, snap);
+                    delta.rotation = math::Quat::from_axis_angle(axis_angle.axis, new_angle);
+                }
+            } break;
+
+            case Mode::orient_trackball: {
+                math::Vec3 const offset = hit - *initial_hit;
+                f32 const offset_len = math::length(offset);
+                if(math::is_almost_zero(offset_len, 0.0001f)) {
+                    return delta;
+                }
+
+                math::Vec3 const offset_norm = offset / offset_len;
+                math::Vec3 const rotation_axis = math::cross(plane_normal, offset_norm);
+                delta.rotation = math::Quat::from_axis_angle(rotation_axis, offset_len);
+            } break;
         }
+        return delta;
     }
 
-    math::Vec3 scale_uniform_along_plane(math::Ray const ray, math::Vec3 const first_axis, math::Vec3 const second_axis, math::Vec3 const origin,
-                                         math::Ray const initial_ray, math::Vec3 const initial_scale, f32 const snap) {
-        math::Vec3 const plane_normal = math::normalize(math::cross(first_axis, second_axis));
-        f32 const plane_distance = math::dot(origin, plane_normal);
-        auto const initial_res = intersect_ray_plane(initial_ray, plane_normal, plane_distance);
-        if(!initial_res) {
-            return initial_scale;
-        }
-
-        if(auto res = intersect_ray_plane(ray, plane_normal, plane_distance)) {
-            math::Vec3 const origin_offset = initial_res->hit_point - origin;
-            math::Vec3 const origin_hit = res->hit_point - origin;
-            f32 const origin_offset_length = math::length(origin_offset);
-            f32 const origin_hit_length = math::length(origin_hit);
-            f32 const sign = math::dot(origin_offset, origin_hit) >= 0 ? 1 : -1;
-            f32 factor = sign * origin_hit_length / origin_offset_length;
-            if(snap != 0.0f) {
-                factor = math::round_to_nearest(factor, snap);
-            }
-            return factor * initial_scale;
-        } else {
-            return initial_scale;
+    Manipulation_Result Manipulation_Session::update(math::Ray const& ray) {
+        Manipulation_Result result{initial_vector, initial_orientation};
+        switch(mode) {
+            case Mode::translate_along_line:
+            case Mode::translate_along_plane: {
+                // The axes have been transformed to the parent space when the session has been created.
+                Optional<math::Vec3> const hit = intersect_plane(ray);
+                if(hit) {
+                    math::Vec2 const factors = calculate_translation_factors(*hit);
+                    result.vector = initial_vector + factors.x * parent_first_axis + factors.y * parent_second_axis;
+                }
+            } break;
+
+            case Mode::scale_along_line:
+            case Mode::scale_along_plane: {
+                Manipulation_Delta const delta = update_delta(ray);
+                math::Vec3 const scaled_part =
+                    initial_vector * scaled_weight + math::dot(initial_vector, scaled_axis) * scaled_axis * scaled_axis_weight;
+                result.vector = initial_vector + (delta.scale_factor - 1.0f) * scaled_part;
+            } break;
+
+            case Mode::orient_turn:
+            case Mode::orient_trackball: {
+                Manipulation_Delta const delta = update_delta(ray);
+                result.orientation = delta.rotation * initial_orientation;
+            } break;
         }
+        return result;
     }
 
-    math::Quat orient_turn(math::Ray const ray, math::Vec3 const axis, math::Vec3 const origin, math::Ray const initial_ray,
-                           math::Quat const initial_orientation, f32 const snap) {
-        math::Vec3 const plane_normal = axis;
-        f32 const plane_distance = math::dot(origin, plane_normal);
-        // Calculate cursor offset
-        auto const offset_res = intersect_ray_plane(initial_ray, plane_normal, plane_distance);
-        if(!offset_res) {
-            return initial_orientation;
-        }
-
-        math::Vec3 const offset = offset_res->hit_point;
-        if(auto res = intersect_ray_plane(ray, plane_normal, plane_distance)) {
-            math::Vec3 const start = math::normalize(offset - origin);
-            math::Vec3 const target = math::normalize(res->hit_point - origin);
-            math::Quat const orientation_delta = math::orient_towards(start, target);
-            if(snap == 0.0f) {
-                return orientation_delta * initial_orientation;
-            } else {
-                math::Axis_Angle const axis_angle = math::to_axis_angle(orientation_delta);
-                f32 const new_angle = math::round_to_nearest(axis_angle.angle, snap);
-                math::Quat const new_orientation = math::Quat::from_axis_angle(axis_angle.axis, new_angle);
-                return new_orientation * initial_orientation;
+    // The number of objects of a batch processed by a single task. A multiple of the lane count.
+    constexpr i64 manipulation_task_size = 4096;
+
+    struct Manipulation_Batch_Task {
+        Manipulation_Batch const* batch;
+        Manipulation_Delta delta;
+        // Whether all arrays of the inverse parent transforms are set.
+        bool has_parent_transforms;
+        math::Vec3 scaled_axis;
+        f32 scaled_weight;
+        f32 scaled_axis_weight;
+    };
+
+    template<typename T>
+    static void translate_lanes(Manipulation_Batch_Task const& task, i64 const index) {
+        Manipulation_Batch const& batch = *task.batch;
+        math::Vec3 const& translation = task.delta.translation;
+        T delta[3] = {simd::splat<T>(translation.x), simd::splat<T>(translation.y), simd::splat<T>(translation.z)};
+        if(task.has_parent_transforms) {
+            T local_delta[3];
+            for(i64 row = 0; row < 3; ++row) {
+                local_delta[row] = simd::load<T>(batch.inverse_parent_transforms[0][row] + index) * delta[0] +
+                                   simd::load<T>(batch.inverse_parent_transforms[1][row] + index) * delta[1] +
+                                   simd::load<T>(batch.inverse_parent_transforms[2][row] + index) * delta[2];
+            }
+            for(i64 row = 0; row < 3; ++row) {
+                delta[row] = local_delta[row];
             }
-        } else {
-            return initial_orientation;
+        }
+
+        for(i64 component = 0; component < 3; ++component) {
+            simd::store(batch.vectors[component] + index, simd::load<T>(batch.initial_vectors[component] + index) + delta[component]);
         }
     }
 
-    math::Quat orient_trackball(math::Ray const ray, math::Vec3 const first_axis, math::Vec3 const second_axis, math::Vec3 const origin,
-                                math::Ray const initial_ray, math::Quat const initial_orientation, f32 const snap) {
-        math::Vec3 const plane_normal = math::normalize(math::cross(first_axis, second_axis));
-        f32 const plane_distance = math::dot(origin, plane_normal);
-        // Calculate cursor offset
-        auto const offset_res = intersect_ray_plane(initial_ray, plane_normal, plane_distance);
-        if(!offset_res) {
-            return initial_orientation;
-        }
-
-        if(auto res = intersect_ray_plane(ray, plane_normal, plane_distance)) {
-            math::Vec3 const delta = res->hit_point - offset_res->hit_point;
-            f32 const delta_len = math::length(delta);
-            if(math::is_almost_zero(delta_len, 0.0001f)) {
-                return initial_orientation;
+    template<typename T>
+    static void scale_lanes(Manipulation_Batch_Task const& task, i64 const index) {
+        Manipulation_Batch const& batch = *task.batch;
+        T const scale[3] = {simd::load<T>(batch.initial_vectors[0] + index), simd::load<T>(batch.initial_vectors[1] + index),
+                            simd::load<T>(batch.initial_vectors[2] + index)};
+        T const axis[3] = {simd::splat<T>(task.scaled_axis.x), simd::splat<T>(task.scaled_axis.y), simd::splat<T>(task.scaled_axis.z)};
+        T const along_axis = (scale[0] * axis[0] + scale[1] * axis[1] + scale[2] * axis[2]) * simd::splat<T>(task.scaled_axis_weight);
+        T const weight = simd::splat<T>(task.scaled_weight);
+        T const factor = simd::splat<T>(task.delta.scale_factor - 1.0f);
+        for(i64 component = 0; component < 3; ++component) {
+            T const scaled_part = scale[component] * weight + along_axis * axis[component];
+            simd::store(batch.vectors[component] + index, scale[component] + factor * scaled_part);
+        }
+    }
+
+    template<typename T>
+    static void orient_lanes(Manipulation_Batch_Task const& task, i64 const index) {
+        Manipulation_Batch const& batch = *task.batch;
+        math::Quat const& rotation = task.delta.rotation;
+        T const x = simd::splat<T>(rotation.x);
+        T const y = simd::splat<T>(rotation.y);
+        T const z = simd::splat<T>(rotation.z);
+        T const w = simd::splat<T>(rotation.w);
+        T const qx = simd::load<T>(batch.initial_orientations[0] + index);
+        T const qy = simd::load<T>(batch.initial_orientations[1] + index);
+        T const qz = simd::load<T>(batch.initial_orientations[2] + index);
+        T const qw = simd::load<T>(batch.initial_orientations[3] + index);
+        simd::store(batch.orientations[0] + index, w * qx + x * qw + y * qz - z * qy);
+        simd::store(batch.orientations[1] + index, w * qy - x * qz + y * qw + z * qx);
+        simd::store(batch.orientations[2] + index, w * qz + x * qy - y * qx + z * qw);
+        simd::store(batch.orientations[3] + index, w * qw - x * qx - y * qy - z * qz);
+    }
+
+    // execute_batch_task
+    // Processes the objects of a single task lane_count at a time and the remainder one at a time.
+    //
+    template<void (*apply_lanes)(Manipulation_Batch_Task const&, i64), void (*apply_single)(Manipulation_Batch_Task const&, i64)>
+    static void execute_batch_task(void* const data, i64 const task_index) {
+        Manipulation_Batch_Task const& task = *static_cast<Manipulation_Batch_Task const*>(data);
+        i64 const first = task_index * manipulation_task_size;
+        i64 const last = math::min(first + manipulation_task_size, task.batch->count);
+        i64 i = first;
+        for(; i + simd::lane_count <= last; i += simd::lane_count) {
+            apply_lanes(task, i);
+        }
+
+        for(; i < last; ++i) {
+            apply_single(task, i);
+        }
+    }
+
+    void Manipulation_Session::update_batch(math::Ray const& ray, Manipulation_Batch const& batch, Task_Executor* const executor) {
+        Manipulation_Batch_Task task;
+        task.batch = &batch;
+        task.delta = update_delta(ray);
+        task.has_parent_transforms = true;
+        for(i64 column = 0; column < 3; ++column) {
+            for(i64 row = 0; row < 3; ++row) {
+                task.has_parent_transforms = task.has_parent_transforms && batch.inverse_parent_transforms[column][row];
             }
+        }
+        task.scaled_axis = scaled_axis;
+        task.scaled_weight = scaled_weight;
+        task.scaled_axis_weight = scaled_axis_weight;
+        i64 const task_count = (batch.count + manipulation_task_size - 1) / manipulation_task_size;
+        switch(mode) {
+            case Mode::translate_along_line:
+            case Mode::translate_along_plane: {
+                execute_tasks(executor, task_count, execute_batch_task<translate_lanes<simd::Float>, translate_lanes<f32>>, &task);
+            } break;
 
-            math::Vec3 const delta_norm = delta / delta_len;
-            math::Vec3 const axis = math::cross(plane_normal, delta_norm);
-            math::Quat const orientation_delta = math::Quat::from_axis_angle(axis, delta_len);
-            return orientation_delta * initial_orientation;
-        } else {
-            return initial_orientation;
+            case Mode::scale_along_line:
+            case Mode::scale_along_plane: {
+                execute_tasks(executor, task_count, execute_batch_task<scale_lanes<simd::Float>, scale_lanes<f32>>, &task);
+            } break;
+
+            case Mode::orient_turn:
+            case Mode::orient_trackball: {
+                execute_tasks(executor, task_count, execute_batch_task<orient_lanes<simd::Float>, orient_lanes<f32>>, &task);
+            } break;
         }
     }
 } // namespace anton::gizmo
@@ -0,0 +1,336 @@
+#include <anton/gizmo/mesh_bvh.hpp>
+
+#include <intersection_tests.hpp>
+#include <simd.hpp>
+
+namespace anton::gizmo {
+    // The maximum number of triangles in a leaf.
+    constexpr i64 max_leaf_size = simd::lane_count > 4 ? simd::lane_count : 4;
+    // The number of floats of a group of triangles. See Mesh_BVH::groups.
+    constexpr i64 group_size = 9 * simd::lane_count;
+    // Nodes are split at the median, hence the depth of the hierarchy is at most log2(triangle count).
+    constexpr i64 max_traversal_stack_size = 64;
+
+    struct Mesh_BVH::Build_Triangle {
+        math::Vec3 v0;
+        math::Vec3 v1;
+        math::Vec3 v2;
+        math::Vec3 centroid;
+        i64 index;
+    };
+
+    // is_degenerate
+    // Checks whether a triangle has no area, e.g. the triangles joining the parts of a strip. Such triangles can never
+    // be hit and are left out of the hierarchy.
+    //
+    [[nodiscard]] static bool is_degenerate(math::Vec3 const& v0, math::Vec3 const& v1, math::Vec3 const& v2) {
+        math::Vec3 const normal = math::cross(v1 - v0, v2 - v0);
+        return normal.x == 0.0f && normal.y == 0.0f && normal.z == 0.0f;
+    }
+
+    // select_nth
+    // Reorders triangles in [first, last) so that the triangle at nth is the triangle that would be there if they were
+    // sorted by the coordinate of their centroids along axis. No triangle before nth has a greater coordinate and no
+    // triangle after nth has a smaller coordinate.
+    //
+    template<typename Triangle>
+    static void select_nth(Triangle* const triangles, i64 first, i64 last, i64 const nth, i32 const axis) {
+        while(last - first > 1) {
+            f32 const pivot = triangles[first + (last - first) / 2].centroid[axis];
+            // Partition into triangles less than, equal to and greater than the pivot, so that repeated coordinates terminate.
+            i64 less_end = first;
+            i64 greater_begin = last;
+            i64 i = first;
+            while(i < greater_begin) {
+                f32 const value = triangles[i].centroid[axis];
+                if(value < pivot) {
+                    Triangle const triangle = triangles[i];
+                    triangles[i] = triangles[less_end];
+                    triangles[less_end] = triangle;
+                    less_end += 1;
+                    i += 1;
+                } else if(value > pivot) {
+                    greater_begin -= 1;
+                    Triangle const triangle = triangles[i];
+                    triangles[i] = triangles[greater_begin];
+                    triangles[greater_begin] = triangle;
+                } else {
+                    i += 1;
+                }
+            }
+
+            if(nth < less_end) {
+                last = less_end;
+            } else if(nth >= greater_begin) {
+                first = greater_begin;
+            } else {
+                return;
+            }
+        }
+    }
+
+    // store_group_lane
+    // Writes the first vertex and the edges of a triangle to a lane of a group of triangles.
+    //
+    static void store_group_lane(f32* const group, i64 const lane, math::Vec3 const& v0, math::Vec3 const& v1, math::Vec3 const& v2) {
+        math::Vec3 const edge1 = v1 - v0;
+        math::Vec3 const edge2 = v2 - v0;
+        f32 const components[9] = {v0.x, v0.y, v0.z, edge1.x, edge1.y, edge1.z, edge2.x, edge2.y, edge2.z};
+        for(i64 i = 0; i < 9; ++i) {
+            group[i * simd::lane_count + lane] = components[i];
+        }
+    }
+
+    void Mesh_BVH::build(Slice<math::Vec3 const> const vertices, Primitive_Topology const topology) {
+        Array<Build_Triangle> triangles;
+        auto const add_triangle = [&triangles](math::Vec3 const& v0, math::Vec3 const& v1, math::Vec3 const& v2, i64 const index) {
+            if(!is_degenerate(v0, v1, v2)) {
+                triangles.emplace_back(Build_Triangle{v0, v1, v2, (v0 + v1 + v2) / 3.0f, index});
+            }
+        };
+
+        switch(topology) {
+            case Primitive_Topology::triangle_list: {
+                for(i64 i = 0; i + 2 < vertices.size(); i += 3) {
+                    add_triangle(vertices[i], vertices[i + 1], vertices[i + 2], i / 3);
+                }
+            } break;
+
+            case Primitive_Topology::triangle_strip: {
+                for(i64 i = 0; i + 2 < vertices.size(); ++i) {
+                    add_triangle(vertices[i], vertices[i + 1], vertices[i + 2], i);
+                }
+            } break;
+        }
+        build_hierarchy(triangles);
+    }
+
+    void Mesh_BVH::build(Slice<math::Vec3 const> const vertices, Slice<u32 const> const indices) {
+        Array<Build_Triangle> triangles;
+        for(i64 i = 0; i + 2 < indices.size(); i += 3) {
+            math::Vec3 const& v0 = vertices[indices[i]];
+            math::Vec3 const& v1 = vertices[indices[i + 1]];
+            math::Vec3 const& v2 = vertices[indices[i + 2]];
+            if(!is_degenerate(v0, v1, v2)) {
+                triangles.emplace_back(Build_Triangle{v0, v1, v2, (v0 + v1 + v2) / 3.0f, i / 3});
+            }
+        }
+        build_hierarchy(triangles);
+    }
+
+    void Mesh_BVH::build(Indexed_Geometry const& geometry) {
+        build(Slice<math::Vec3 const>{geometry.vertices.data(), geometry.vertices.data() + geometry.vertices.size()},
+              Slice<u32 const>{geometry.indices.data(), geometry.indices.data() + geometry.indices.size()});
+    }
+
+    void Mesh_BVH::build_hierarchy(Array<Build_Triangle>& triangles) {
+        nodes.clear();
+        groups.clear();
+        triangle_indices.clear();
+        if(triangles.size() == 0) {
+            return;
+        }
+
+        nodes.emplace_back(Node{math::Vec3{0.0f}, math::Vec3{0.0f}, 0, 0});
+        build_node(triangles, 0, 0, triangles.size());
+    }
+
+    void Mesh_BVH::build_node(Array<Build_Triangle>& triangles, i64 const node, i64 const first, i64 const count) {
+        math::Vec3 min{math::infinity};
+        math::Vec3 max{-math::infinity};
+        math::Vec3 centroid_min{math::infinity};
+        math::Vec3 centroid_max{-math::infinity};
+        for(i64 i = first; i < first + count; ++i) {
+            Build_Triangle const& triangle = triangles[i];
+            for(i32 j = 0; j < 3; ++j) {
+                min[j] = math::min(min[j], math::min(triangle.v0[j], math::min(triangle.v1[j], triangle.v2[j])));
+                max[j] = math::max(max[j], math::max(triangle.v0[j], math::max(triangle.v1[j], triangle.v2[j])));
+                centroid_min[j] = math::min(centroid_min[j], triangle.centroid[j]);
+                centroid_max[j] = math::max(centroid_max[j], triangle.centroid[j]);
+            }
+        }
+        nodes[node].min = min;
+        nodes[node].max = max;
+
+        if(count <= max_leaf_size) {
+            i64 const group_count = (count + simd::lane_count - 1) / simd::lane_count;
+            i64 const first_group = groups.size() / group_size;
+            // Unused lanes are left zeroed, i.e. degenerate.
+            groups.resize(groups.size() + group_count * group_size, 0.0f);
+            triangle_indices.resize(triangle_indices.size() + group_count * simd::lane_count, -1);
+            for(i64 i = 0; i < count; ++i) {
+                i64 const group = first_group + i / simd::lane_count;
+                i64 const lane = i % simd::lane_count;
+                Build_Triangle const& triangle = triangles[first + i];
+                store_group_lane(groups.data() + group * group_size, lane, triangle.v0, triangle.v1, triangle.v2);
+                triangle_indices[group * simd::lane_count + lane] = triangle.index;
+            }
+            nodes[node].first = static_cast<u32>(first_group);
+            nodes[node].count = static_cast<u32>(group_count);
+            return;
+        }
+
+        // Split at the median along the axis of the largest extent of the centroids.
+        math::Vec3 const extent = centroid_max - centroid_min;
+        i32 axis = 0;
+        if(extent[1] > extent[axis]) {
+            axis = 1;
+        }
+        if(extent[2] > extent[axis]) {
+            axis = 2;
+        }
+
+        i64 const middle = first + count / 2;
+        select_nth(triangles.data(), first, first + count, middle, axis);
+        i64 const left = nodes.size();
+        nodes.emplace_back(Node{math::Vec3{0.0f}, math::Vec3{0.0f}, 0, 0});
+        nodes.emplace_back(Node{math::Vec3{0.0f}, math::Vec3{0.0f}, 0, 0});
+        nodes[node].first = static_cast<u32>(left);
+        nodes[node].count = 0;
+        build_node(triangles, left, first, middle - first);
+        build_node(triangles, left + 1, middle, first + count - middle);
+    }
+
+    Optional<Mesh_Hit> Mesh_BVH::intersect(math::Ray const& ray, f32 const max_distance) const {
+        if(nodes.size() == 0) {
+            return null_optional;
+        }
+
+        Ray_Slabs<math::Vec3> const slabs = make_ray_slabs(ray.origin, ray.direction);
+        f32 const root_distance = intersect_ray_slabs(slabs, nodes[0].min, nodes[0].max);
+        if(root_distance >= max_distance) {
+            return null_optional;
+        }
+
+        struct Stack_Entry {
+            i64 node;
+            f32 distance;
+        };
+
+        Stack_Entry stack[max_traversal_stack_size];
+        i64 stack_size = 0;
+        stack[stack_size++] = Stack_Entry{0, root_distance};
+        simd::Float3 const origin = broadcast_vec3(ray.origin);
+        simd::Float3 const direction = broadcast_vec3(ray.direction);
+        f32 nearest_distance = max_distance;
+        i64 nearest_lane = -1;
+        f32 nearest_u = 0.0f;
+        f32 nearest_v = 0.0f;
+        while(stack_size > 0) {
+            Stack_Entry const entry = stack[--stack_size];
+            if(entry.distance >= nearest_distance) {
+                continue;
+            }
+
+            Node const& node = nodes[entry.node];
+            if(node.count > 0) {
+                for(i64 group = node.first; group < node.first + node.count; ++group) {
+                    f32 const* const streams = groups.data() + group * group_size;
+                    auto const load_stream = [streams](i64 const stream) {
+                        return simd::load(streams + stream * simd::lane_count);
+                    };
+                    simd::Float3 const v0{load_stream(0), load_stream(1), load_stream(2)};
+                    simd::Float3 const edge1{load_stream(3), load_stream(4), load_stream(5)};
+                    simd::Float3 const edge2{load_stream(6), load_stream(7), load_stream(8)};
+                    simd::Float u;
+                    simd::Float v;
+                    simd::Float const distance = intersect_ray_triangle(origin, direction, v0, edge1, edge2, u, v);
+                    f32 distances[simd::lane_count];
+                    f32 us[simd::lane_count];
+                    f32 vs[simd::lane_count];
+                    simd::store(distances, distance);
+                    simd::store(us, u);
+                    simd::store(vs, v);
+                    for(i64 lane = 0; lane < simd::lane_count; ++lane) {
+                        if(distances[lane] < nearest_distance) {
+                            nearest_distance = distances[lane];
+                            nearest_lane = group * simd::lane_count + lane;
+                            nearest_u = us[lane];
+                            nearest_v = vs[lane];
+                        }
+                    }
+                }
+                continue;
+            }
+
+            f32 const left_distance = intersect_ray_slabs(slabs, nodes[node.first].min, nodes[node.first].max);
+            f32 const right_distance = intersect_ray_slabs(slabs, nodes[node.first + 1].min, nodes[node.first + 1].max);
+            // Push the farther child first so that the nearer child is visited first. Missed children have infinite distances.
+            i64 const near_child = left_distance <= right_distance ? node.first : node.first + 1;
+            i64 const far_child = left_distance <= right_distance ? node.first + 1 : node.first;
+            f32 const near_distance = math::min(left_distance, right_distance);
+            f32 const far_distance = math::max(left_distance, right_distance);
+            if(far_distance < nearest_distance) {
+                stack[stack_size++] = Stack_Entry{far_child, far_distance};
+            }
+            if(near_distance < nearest_distance) {
+                stack[stack_size++] = Stack_Entry{near_child, near_distance};
+            }
+        }
+
+        if(nearest_lane == -1) {
+            return null_optional;
+        }
+
+        return Mesh_Hit{nearest_distance, triangle_indices[nearest_lane], math::Vec3{1.0f - nearest_u - nearest_v, nearest_u, nearest_v}};
+    }
+
+    Optional<Mesh_Hit> Mesh_BVH::intersect(math::Ray const& ray, Prepared_Handle const& handle, f32 const max_distance) const {
+        // Transform the ray to the local space of the handle, whose -z axis is handle.z_axis. Scaling the direction
+        // by the inverse scale along with the origin preserves the distances along the ray.
+        f32 const inverse_scale = 1.0f / handle.scale;
+        math::Vec3 const offset = ray.origin - handle.origin;
+        math::Vec3 const local_origin =
+            math::Vec3{math::dot(offset, handle.x_axis), math::dot(offset, handle.y_axis), -math::dot(offset, handle.z_axis)} * inverse_scale;
+        math::Vec3 const local_direction =
+            math::Vec3{math::dot(ray.direction, handle.x_axis), math::dot(ray.direction, handle.y_axis), -math::dot(ray.direction, handle.z_axis)} *
+            inverse_scale;
+        return intersect(math::Ray{local_origin, local_direction}, max_distance);
+    }
+
+    void Mesh_BVH::get_bounds(math::Vec3& min, math::Vec3& max) const {
+        if(nodes.size() == 0) {
+            min = math::Vec3{math::infinity};
+            max = math::Vec3{-math::infinity};
+        } else {
+            min = nodes[0].min;
+            max = nodes[0].max;
+        }
+    }
+
+    Prepared_Handle prepare_mesh(Mesh_BVH const& mesh, math::Mat4 const& world_transform) {
+        math::Vec3 min;
+        math::Vec3 max;
+        mesh.get_bounds(min, max);
+        if(min.x > max.x) {
+            return prepare_handle(world_transform, math::Vec3{0.0f}, 0.0f);
+        }
+
+        return prepare_handle(world_transform, 0.5f * (min + max), 0.5f * math::length(max - min));
+    }
+
+    Optional<Gizmo_Pick> pick_gizmo(math::Ray const& ray, Prepared_Gizmo const& gizmo, Gizmo_Meshes const& meshes, u32 const base_handle_id) {
+        Optional<Gizmo_Pick> result = null_optional;
+        for(i64 i = 0; i < gizmo_handle_count; ++i) {
+            if(gizmo.shapes[i] == Gizmo_Handle_Shape::none) {
+                continue;
+            }
+
+            Gizmo_Handle const handle = static_cast<Gizmo_Handle>(i);
+            Optional<f32> hit = null_optional;
+            if(meshes.handles[i] != nullptr) {
+                Optional<Mesh_Hit> const mesh_hit = meshes.handles[i]->intersect(ray, gizmo.handles[i], result ? result->distance : math::infinity);
+                if(mesh_hit) {
+                    hit = mesh_hit->distance;
+                }
+            } else {
+                hit = intersect_gizmo_handle(ray, gizmo, handle);
+            }
+
+            if(hit && (!result || *hit < result->distance)) {
+                result = Gizmo_Pick{handle, base_handle_id + static_cast<u32>(handle), *hit};
+            }
+        }
+        return result;
+    }
+} // namespace anton::gizmo
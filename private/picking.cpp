@@ -0,0 +1,216 @@
+#include <anton/gizmo/picking.hpp>
+
+#include <anton/gizmo/shapes.hpp>
+#include <anton/math/math.hpp>
+#include <anton/math/vec4.hpp>
+#include <utils.hpp>
+
+namespace anton::gizmo {
+    // calculate_handle_transform
+    // Calculates the world transform of a handle directed towards -z in its local space that is placed in the gizmo
+    // like Gizmo_Builder places it, i.e. scaled, rotated towards axis and then offset.
+    //
+    [[nodiscard]] static math::Mat4 calculate_handle_transform(math::Mat4 const& gizmo_transform, i32 const axis, f32 const scale,
+                                                               math::Vec3 const& offset) {
+        f32 const(&r)[3][3] = axis_rotations[axis];
+        math::Mat4 const local{math::Vec4{r[0][0] * scale, r[0][1] * scale, r[0][2] * scale, 0.0f},
+                               math::Vec4{r[1][0] * scale, r[1][1] * scale, r[1][2] * scale, 0.0f},
+                               math::Vec4{r[2][0] * scale, r[2][1] * scale, r[2][2] * scale, 0.0f}, math::Vec4{offset, 1.0f}};
+        return gizmo_transform * local;
+    }
+
+    [[nodiscard]] static math::Mat4 calculate_center_transform(math::Mat4 const& gizmo_transform, f32 const scale) {
+        math::Mat4 const local{math::Vec4{scale, 0.0f, 0.0f, 0.0f}, math::Vec4{0.0f, scale, 0.0f, 0.0f}, math::Vec4{0.0f, 0.0f, scale, 0.0f},
+                               math::Vec4{0.0f, 0.0f, 0.0f, 1.0f}};
+        return gizmo_transform * local;
+    }
+
+    [[nodiscard]] static Prepared_Gizmo make_empty_gizmo() {
+        Prepared_Gizmo gizmo{};
+        for(Gizmo_Handle_Shape& shape: gizmo.shapes) {
+            shape = Gizmo_Handle_Shape::none;
+        }
+        return gizmo;
+    }
+
+    static void set_handle(Prepared_Gizmo& gizmo, Gizmo_Handle const handle, Gizmo_Handle_Shape const shape, Prepared_Handle const& prepared) {
+        gizmo.shapes[static_cast<u32>(handle)] = shape;
+        gizmo.handles[static_cast<u32>(handle)] = prepared;
+    }
+
+    // calculate_gizmo_bounds
+    // Calculates the sphere around the origin of the gizmo enclosing the bounding spheres of all handles.
+    //
+    static void calculate_gizmo_bounds(Prepared_Gizmo& gizmo, math::Mat4 const& gizmo_transform) {
+        gizmo.bounding_center = math::Vec3{gizmo_transform * math::Vec4{0.0f, 0.0f, 0.0f, 1.0f}};
+        gizmo.bounding_radius = 0.0f;
+        for(i64 i = 0; i < gizmo_handle_count; ++i) {
+            if(gizmo.shapes[i] != Gizmo_Handle_Shape::none) {
+                Prepared_Handle const& handle = gizmo.handles[i];
+                f32 const radius = math::length(handle.bounding_center - gizmo.bounding_center) + handle.bounding_radius;
+                gizmo.bounding_radius = math::max(gizmo.bounding_radius, radius);
+            }
+        }
+    }
+
+    [[nodiscard]] static Gizmo_Handle get_axis_handle(i32 const axis) {
+        return static_cast<Gizmo_Handle>(static_cast<u32>(Gizmo_Handle::axis_x) + axis);
+    }
+
+    [[nodiscard]] static Gizmo_Handle get_plane_handle(i32 const axis) {
+        return static_cast<Gizmo_Handle>(static_cast<u32>(Gizmo_Handle::plane_yz) + axis);
+    }
+
+    Prepared_Gizmo prepare_gizmo(Translate_Gizmo const& gizmo, math::Mat4 const& gizmo_transform) {
+        Prepared_Gizmo prepared = make_empty_gizmo();
+        prepared.arrow = gizmo.arrow;
+        for(i32 axis = 0; axis < 3; ++axis) {
+            math::Mat4 const transform = calculate_handle_transform(gizmo_transform, axis, 1.0f, math::Vec3{0.0f});
+            set_handle(prepared, get_axis_handle(axis), Gizmo_Handle_Shape::arrow_3d, prepare_arrow_3d(gizmo.arrow, transform));
+        }
+
+        for(i32 axis = 0; axis < 3; ++axis) {
+            // The plane is spanned by the 2 axes other than its normal.
+            math::Vec3 offset{gizmo.plane_offset};
+            offset[axis] = 0.0f;
+            math::Mat4 const transform = calculate_handle_transform(gizmo_transform, axis, gizmo.plane_size, offset);
+            set_handle(prepared, get_plane_handle(axis), Gizmo_Handle_Shape::square, prepare_square(transform));
+        }
+
+        math::Mat4 const center_transform = calculate_center_transform(gizmo_transform, gizmo.center_size);
+        set_handle(prepared, Gizmo_Handle::center, Gizmo_Handle_Shape::cube, prepare_cube(center_transform));
+        calculate_gizmo_bounds(prepared, gizmo_transform);
+        return prepared;
+    }
+
+    Prepared_Gizmo prepare_gizmo(Rotate_Gizmo const& gizmo, math::Mat4 const& gizmo_transform) {
+        Prepared_Gizmo prepared = make_empty_gizmo();
+        prepared.dial = gizmo.dial;
+        for(i32 axis = 0; axis < 3; ++axis) {
+            math::Mat4 const transform = calculate_handle_transform(gizmo_transform, axis, 1.0f, math::Vec3{0.0f});
+            set_handle(prepared, get_axis_handle(axis), Gizmo_Handle_Shape::dial_3d, prepare_dial_3d(gizmo.dial, transform));
+        }
+
+        math::Mat4 const center_transform = calculate_center_transform(gizmo_transform, gizmo.trackball_radius);
+        set_handle(prepared, Gizmo_Handle::center, Gizmo_Handle_Shape::sphere, prepare_sphere(center_transform));
+        calculate_gizmo_bounds(prepared, gizmo_transform);
+        return prepared;
+    }
+
+    Prepared_Gizmo prepare_gizmo(Scale_Gizmo const& gizmo, math::Mat4 const& gizmo_transform) {
+        Prepared_Gizmo prepared = make_empty_gizmo();
+        prepared.arrow = gizmo.arrow;
+        for(i32 axis = 0; axis < 3; ++axis) {
+            math::Mat4 const transform = calculate_handle_transform(gizmo_transform, axis, 1.0f, math::Vec3{0.0f});
+            set_handle(prepared, get_axis_handle(axis), Gizmo_Handle_Shape::arrow_3d, prepare_arrow_3d(gizmo.arrow, transform));
+        }
+
+        math::Mat4 const center_transform = calculate_center_transform(gizmo_transform, gizmo.center_size);
+        set_handle(prepared, Gizmo_Handle::center, Gizmo_Handle_Shape::cube, prepare_cube(center_transform));
+        calculate_gizmo_bounds(prepared, gizmo_transform);
+        return prepared;
+    }
+
+    // intersect_bounding_sphere
+    // Calculates the distance along the ray at which it enters the sphere. The direction of the ray must be normalized.
+    //
+    // Returns:
+    // The entry distance, 0 if the origin of the ray is inside the sphere, or null_optional if the ray misses the sphere.
+    //
+    [[nodiscard]] static Optional<f32> intersect_bounding_sphere(math::Ray const& ray, math::Vec3 const& center, f32 const radius) {
+        math::Vec3 const to_center = center - ray.origin;
+        f32 const projection = math::dot(to_center, ray.direction);
+        f32 const distance_squared = math::length_squared(to_center) - projection * projection;
+        f32 const radius_squared = radius * radius;
+        if(distance_squared > radius_squared) {
+            return null_optional;
+        }
+
+        f32 const half_chord = math::sqrt(radius_squared - distance_squared);
+        if(projection + half_chord < 0.0f) {
+            return null_optional;
+        }
+
+        return math::max(projection - half_chord, 0.0f);
+    }
+
+    Optional<f32> intersect_gizmo_handle(math::Ray const& ray, Prepared_Gizmo const& gizmo, Gizmo_Handle const gizmo_handle) {
+        i64 const index = static_cast<i64>(gizmo_handle);
+        Prepared_Handle const& handle = gizmo.handles[index];
+        switch(gizmo.shapes[index]) {
+            case Gizmo_Handle_Shape::none:
+                return null_optional;
+            case Gizmo_Handle_Shape::arrow_3d:
+                return intersect_arrow_3d(ray, gizmo.arrow, handle);
+            case Gizmo_Handle_Shape::dial_3d:
+                return intersect_dial_3d(ray, gizmo.dial, handle);
+            case Gizmo_Handle_Shape::square:
+                return intersect_square(ray, handle);
+            case Gizmo_Handle_Shape::cube:
+                return intersect_cube(ray, handle);
+            case Gizmo_Handle_Shape::sphere:
+                return intersect_sphere(ray, handle);
+        }
+    }
+
+    Optional<Gizmo_Pick> pick_gizmo(math::Ray const& ray, Prepared_Gizmo const& gizmo, u32 const base_handle_id) {
+        if(!intersect_bounding_sphere(ray, gizmo.bounding_center, gizmo.bounding_radius)) {
+            return null_optional;
+        }
+
+        // Sort the handles whose bounding spheres are hit by the distance to their bounding spheres.
+        struct Candidate {
+            f32 distance;
+            i64 index;
+        };
+
+        Candidate candidates[gizmo_handle_count];
+        i64 candidate_count = 0;
+        for(i64 i = 0; i < gizmo_handle_count; ++i) {
+            if(gizmo.shapes[i] == Gizmo_Handle_Shape::none) {
+                continue;
+            }
+
+            Prepared_Handle const& handle = gizmo.handles[i];
+            Optional<f32> const distance = intersect_bounding_sphere(ray, handle.bounding_center, handle.bounding_radius);
+            if(!distance) {
+                continue;
+            }
+
+            i64 position = candidate_count;
+            for(; position > 0 && candidates[position - 1].distance > *distance; --position) {
+                candidates[position] = candidates[position - 1];
+            }
+            candidates[position] = Candidate{*distance, i};
+            candidate_count += 1;
+        }
+
+        Optional<Gizmo_Pick> result = null_optional;
+        for(i64 i = 0; i < candidate_count; ++i) {
+            Candidate const& candidate = candidates[i];
+            // Every hit lies within the bounding sphere of its handle, hence no further handle may be closer.
+            if(result && candidate.distance > result->distance) {
+                break;
+            }
+
+            Gizmo_Handle const handle = static_cast<Gizmo_Handle>(candidate.index);
+            Optional<f32> const hit = intersect_gizmo_handle(ray, gizmo, handle);
+            if(hit && (!result || *hit < result->distance)) {
+                result = Gizmo_Pick{handle, base_handle_id + static_cast<u32>(handle), *hit};
+            }
+        }
+        return result;
+    }
+
+    Optional<Gizmo_Pick> pick_gizmo(math::Ray const& ray, Translate_Gizmo const& gizmo, math::Mat4 const& gizmo_transform, u32 const base_handle_id) {
+        return pick_gizmo(ray, prepare_gizmo(gizmo, gizmo_transform), base_handle_id);
+    }
+
+    Optional<Gizmo_Pick> pick_gizmo(math::Ray const& ray, Rotate_Gizmo const& gizmo, math::Mat4 const& gizmo_transform, u32 const base_handle_id) {
+        return pick_gizmo(ray, prepare_gizmo(gizmo, gizmo_transform), base_handle_id);
+    }
+
+    Optional<Gizmo_Pick> pick_gizmo(math::Ray const& ray, Scale_Gizmo const& gizmo, math::Mat4 const& gizmo_transform, u32 const base_handle_id) {
+        return pick_gizmo(ray, prepare_gizmo(gizmo, gizmo_transform), base_handle_id);
+    }
+} // namespace anton::gizmo
@@ -0,0 +1,21 @@
+#include <anton/gizmo/prepared_handle.hpp>
+
+#include <anton/math/math.hpp>
+#include <anton/math/vec4.hpp>
+
+namespace anton::gizmo {
+    Prepared_Handle prepare_handle(math::Mat4 const& world_transform, math::Vec3 const local_bounding_center, f32 const local_bounding_radius) {
+        Prepared_Handle handle;
+        handle.origin = math::Vec3{world_transform * math::Vec4{0.0f, 0.0f, 0.0f, 1.0f}};
+        // Uniformly scaled - all axes have the same scale applied, so we normalize with the scale of the x axis.
+        handle.scale = math::length(math::Vec3{world_transform[0]});
+        f32 const inverse_scale = 1.0f / handle.scale;
+        handle.x_axis = math::Vec3{world_transform[0]} * inverse_scale;
+        handle.y_axis = math::Vec3{world_transform[1]} * inverse_scale;
+        handle.z_axis = math::Vec3{world_transform[2]} * -inverse_scale;
+        handle.plane_distance = math::dot(handle.origin, handle.z_axis);
+        handle.bounding_center = math::Vec3{world_transform * math::Vec4{local_bounding_center, 1.0f}};
+        handle.bounding_radius = handle.scale * local_bounding_radius;
+        return handle;
+    }
+} // namespace anton::gizmo
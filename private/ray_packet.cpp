@@ -0,0 +1,29 @@
+#include <anton/gizmo/ray_packet.hpp>
+
+#include <anton/math/math.hpp>
+
+namespace anton::gizmo {
+    Ray_Packet make_ray_packet(Slice<math::Ray const> const rays) {
+        Ray_Packet packet;
+        // The rays past max_ray_packet_size do not fit into the packet.
+        i64 const count = math::min(rays.size(), max_ray_packet_size);
+        packet.count = count;
+        for(i64 i = 0; i < max_ray_packet_size; ++i) {
+            // The padding repeats the last ray, so that the rays loaded together with the last rays of the packet
+            // are valid and cost no more than the rays of the packet.
+            math::Ray ray{math::Vec3{0.0f}, math::Vec3{0.0f, 0.0f, -1.0f}};
+            if(i < count) {
+                ray = rays[i];
+            } else if(count > 0) {
+                ray = rays[count - 1];
+            }
+            packet.origin_x[i] = ray.origin.x;
+            packet.origin_y[i] = ray.origin.y;
+            packet.origin_z[i] = ray.origin.z;
+            packet.direction_x[i] = ray.direction.x;
+            packet.direction_y[i] = ray.direction.y;
+            packet.direction_z[i] = ray.direction.z;
+        }
+        return packet;
+    }
+} // namespace anton::gizmo
@@ -0,0 +1,414 @@
+#include <anton/gizmo/screen_picking.hpp>
+
+#include <anton/math/math.hpp>
+#include <anton/math/vec4.hpp>
+
+#include <math.h>
+
+namespace anton::gizmo {
+    // Points closer to the plane of the camera than this clip space w are clipped.
+    constexpr f32 min_clip_w = 1e-5f;
+
+    // Screen_Projection
+    // The rows of the view projection that map a world space point p to the homogeneous pixel coordinates (x * w, y * w, w)
+    // of its projection (x, y).
+    //
+    struct Screen_Projection {
+        math::Vec4 x_row;
+        math::Vec4 y_row;
+        math::Vec4 w_row;
+    };
+
+    // Homogeneous pixel coordinates. The conics of the ellipses are calculated in double precision, because the ellipses
+    // are recovered from the differences of products of pixel coordinates.
+    struct Pixel_Point {
+        f64 x;
+        f64 y;
+        f64 w;
+    };
+
+    [[nodiscard]] static Screen_Projection make_screen_projection(math::Mat4 const& view_projection, math::Vec2 const viewport_size) {
+        math::Vec4 const row_x{view_projection[0][0], view_projection[1][0], view_projection[2][0], view_projection[3][0]};
+        math::Vec4 const row_y{view_projection[0][1], view_projection[1][1], view_projection[2][1], view_projection[3][1]};
+        math::Vec4 const row_w{view_projection[0][3], view_projection[1][3], view_projection[2][3], view_projection[3][3]};
+        // x = (ndc.x + 1) * width / 2 and y = (1 - ndc.y) * height / 2.
+        return Screen_Projection{(row_x + row_w) * (0.5f * viewport_size.x), (row_w - row_y) * (0.5f * viewport_size.y), row_w};
+    }
+
+    // project
+    // Projects a point (w = 1) or a direction (w = 0).
+    //
+    [[nodiscard]] static Pixel_Point project(Screen_Projection const& projection, math::Vec3 const& v, f32 const w) {
+        math::Vec4 const h{v, w};
+        return Pixel_Point{math::dot(projection.x_row, h), math::dot(projection.y_row, h), math::dot(projection.w_row, h)};
+    }
+
+    [[nodiscard]] static math::Vec2 to_pixels(Pixel_Point const& p) {
+        return math::Vec2{static_cast<f32>(p.x / p.w), static_cast<f32>(p.y / p.w)};
+    }
+
+    [[nodiscard]] static Projected_Handle make_empty_handle() {
+        Projected_Handle handle{};
+        handle.shape = Projected_Handle_Shape::none;
+        return handle;
+    }
+
+    [[nodiscard]] static Projected_Handle project_segment(Screen_Projection const& projection, math::Vec3 const& a, math::Vec3 const& b) {
+        Pixel_Point p1 = project(projection, a, 1.0f);
+        Pixel_Point p2 = project(projection, b, 1.0f);
+        if(p1.w < min_clip_w && p2.w < min_clip_w) {
+            return make_empty_handle();
+        }
+
+        // Clip the part behind the camera.
+        if(p1.w < min_clip_w || p2.w < min_clip_w) {
+            Pixel_Point& behind = p1.w < min_clip_w ? p1 : p2;
+            Pixel_Point const& front = p1.w < min_clip_w ? p2 : p1;
+            f64 const t = (min_clip_w - behind.w) / (front.w - behind.w);
+            behind = Pixel_Point{behind.x + (front.x - behind.x) * t, behind.y + (front.y - behind.y) * t, min_clip_w};
+        }
+
+        Projected_Handle handle = make_empty_handle();
+        handle.shape = Projected_Handle_Shape::segment;
+        handle.points[0] = to_pixels(p1);
+        handle.points[1] = to_pixels(p2);
+        return handle;
+    }
+
+    [[nodiscard]] static Projected_Handle project_quad(Screen_Projection const& projection, Prepared_Handle const& square) {
+        f32 const half_edge = 0.5f * square.scale;
+        math::Vec3 const x = square.x_axis * half_edge;
+        math::Vec3 const y = square.y_axis * half_edge;
+        math::Vec3 const corners[4] = {square.origin + x + y, square.origin - x + y, square.origin - x - y, square.origin + x - y};
+        Projected_Handle handle = make_empty_handle();
+        for(i64 i = 0; i < 4; ++i) {
+            Pixel_Point const p = project(projection, corners[i], 1.0f);
+            if(p.w < min_clip_w) {
+                return make_empty_handle();
+            }
+            handle.points[i] = to_pixels(p);
+        }
+        handle.shape = Projected_Handle_Shape::quad;
+        return handle;
+    }
+
+    // project_ellipse
+    // Projects the circle or the sphere center + sum(axes[i] * cos_i) with sum(cos_i^2) = 1. The image is the conic whose
+    // dual is H * diag(1, ..., 1, -1) * H^T where the columns of H are the projections of the axes and of the center, i.e.
+    // sum(h_i * h_i^T) - q * q^T. The dual of an ellipse with center c and shape M = L * L^T, the image of the unit circle
+    // under x = c + L * u, is [M - c * c^T, -c; -c^T, -1], from which c and M are read after scaling the conic.
+    //
+    [[nodiscard]] static Projected_Handle project_ellipse(Screen_Projection const& projection, math::Vec3 const& center, math::Vec3 const* const axes,
+                                                          i64 const axis_count, Projected_Handle_Shape const shape) {
+        Pixel_Point const q = project(projection, center, 1.0f);
+        f64 s11 = -q.x * q.x;
+        f64 s12 = -q.x * q.y;
+        f64 s13 = -q.x * q.w;
+        f64 s22 = -q.y * q.y;
+        f64 s23 = -q.y * q.w;
+        f64 s33 = -q.w * q.w;
+        for(i64 i = 0; i < axis_count; ++i) {
+            Pixel_Point const h = project(projection, axes[i], 0.0f);
+            s11 += h.x * h.x;
+            s12 += h.x * h.y;
+            s13 += h.x * h.w;
+            s22 += h.y * h.y;
+            s23 += h.y * h.w;
+            s33 += h.w * h.w;
+        }
+
+        // The conic is an ellipse only if the shape lies entirely in front of the camera.
+        if(!(q.w > 0.0 && s33 < 0.0)) {
+            return make_empty_handle();
+        }
+
+        f64 const scale = -1.0 / s33;
+        f64 const center_x = s13 / s33;
+        f64 const center_y = s23 / s33;
+        f64 const m11 = s11 * scale + center_x * center_x;
+        f64 const m12 = s12 * scale + center_x * center_y;
+        f64 const m22 = s22 * scale + center_y * center_y;
+        // The eigenvalues of M are the squares of the semi-axes.
+        f64 const mean = 0.5 * (m11 + m22);
+        f64 const half_difference = 0.5 * (m11 - m22);
+        f64 const deviation = ::sqrt(half_difference * half_difference + m12 * m12);
+        f64 const major_squared = mean + deviation;
+        f64 const minor_squared = mean - deviation;
+
+        Projected_Handle handle = make_empty_handle();
+        handle.shape = shape;
+        handle.points[0] = math::Vec2{static_cast<f32>(center_x), static_cast<f32>(center_y)};
+        handle.major_radius = math::sqrt(static_cast<f32>(major_squared > 0.0 ? major_squared : 0.0));
+        handle.minor_radius = math::sqrt(static_cast<f32>(minor_squared > 0.0 ? minor_squared : 0.0));
+        if(m12 != 0.0) {
+            handle.major_axis = math::normalize(math::Vec2{static_cast<f32>(major_squared - m22), static_cast<f32>(m12)});
+        } else if(m11 >= m22) {
+            handle.major_axis = math::Vec2{1.0f, 0.0f};
+        } else {
+            handle.major_axis = math::Vec2{0.0f, 1.0f};
+        }
+        return handle;
+    }
+
+    [[nodiscard]] static Projected_Handle project_handle(Screen_Projection const& projection, Prepared_Gizmo const& gizmo, i64 const index) {
+        Prepared_Handle const& handle = gizmo.handles[index];
+        switch(gizmo.shapes[index]) {
+            case Gizmo_Handle_Shape::none:
+                return make_empty_handle();
+
+            case Gizmo_Handle_Shape::arrow_3d: {
+                f32 length = gizmo.arrow.shaft_length;
+                if(gizmo.arrow.draw_style == Arrow_3D_Style::cone) {
+                    length += gizmo.arrow.cap_length;
+                }
+                return project_segment(projection, handle.origin, handle.origin + handle.z_axis * (handle.scale * length));
+            }
+
+            case Gizmo_Handle_Shape::dial_3d: {
+                f32 const radius = handle.scale * gizmo.dial.major_radius;
+                math::Vec3 const axes[2] = {handle.x_axis * radius, handle.y_axis * radius};
+                return project_ellipse(projection, handle.origin, axes, 2, Projected_Handle_Shape::ellipse);
+            }
+
+            case Gizmo_Handle_Shape::square:
+                return project_quad(projection, handle);
+
+            case Gizmo_Handle_Shape::cube:
+            case Gizmo_Handle_Shape::sphere: {
+                // The sphere inscribed in the cube.
+                f32 const radius = gizmo.shapes[index] == Gizmo_Handle_Shape::cube ? 0.5f * handle.scale : handle.scale;
+                math::Vec3 const axes[3] = {math::Vec3{radius, 0.0f, 0.0f}, math::Vec3{0.0f, radius, 0.0f}, math::Vec3{0.0f, 0.0f, radius}};
+                return project_ellipse(projection, handle.origin, axes, 3, Projected_Handle_Shape::filled_ellipse);
+            }
+        }
+    }
+
+    static void extend_bounds(Projected_Gizmo& gizmo, math::Vec2 const point, f32 const radius) {
+        gizmo.bounds_min.x = math::min(gizmo.bounds_min.x, point.x - radius);
+        gizmo.bounds_min.y = math::min(gizmo.bounds_min.y, point.y - radius);
+        gizmo.bounds_max.x = math::max(gizmo.bounds_max.x, point.x + radius);
+        gizmo.bounds_max.y = math::max(gizmo.bounds_max.y, point.y + radius);
+    }
+
+    Projected_Gizmo project_gizmo(Prepared_Gizmo const& gizmo, math::Mat4 const& view_projection, math::Vec2 const viewport_size) {
+        Screen_Projection const projection = make_screen_projection(view_projection, viewport_size);
+        Projected_Gizmo projected;
+        projected.bounds_min = math::Vec2{math::infinity};
+        projected.bounds_max = math::Vec2{-math::infinity};
+        for(i64 i = 0; i < gizmo_handle_count; ++i) {
+            Projected_Handle const handle = project_handle(projection, gizmo, i);
+            projected.handles[i] = handle;
+            switch(handle.shape) {
+                case Projected_Handle_Shape::none:
+                    break;
+
+                case Projected_Handle_Shape::segment:
+                    extend_bounds(projected, handle.points[0], 0.0f);
+                    extend_bounds(projected, handle.points[1], 0.0f);
+                    break;
+
+                case Projected_Handle_Shape::quad:
+                    for(math::Vec2 const& point: handle.points) {
+                        extend_bounds(projected, point, 0.0f);
+                    }
+                    break;
+
+                case Projected_Handle_Shape::ellipse:
+                case Projected_Handle_Shape::filled_ellipse:
+                    extend_bounds(projected, handle.points[0], handle.major_radius);
+                    break;
+            }
+        }
+        return projected;
+    }
+
+    Projected_Gizmo project_gizmo(Translate_Gizmo const& gizmo, math::Mat4 const& gizmo_transform, math::Mat4 const& view_projection,
+                                  math::Vec2 const viewport_size) {
+        return project_gizmo(prepare_gizmo(gizmo, gizmo_transform), view_projection, viewport_size);
+    }
+
+    Projected_Gizmo project_gizmo(Rotate_Gizmo const& gizmo, math::Mat4 const& gizmo_transform, math::Mat4 const& view_projection,
+                                  math::Vec2 const viewport_size) {
+        return project_gizmo(prepare_gizmo(gizmo, gizmo_transform), view_projection, viewport_size);
+    }
+
+    Projected_Gizmo project_gizmo(Scale_Gizmo const& gizmo, math::Mat4 const& gizmo_transform, math::Mat4 const& view_projection,
+                                  math::Vec2 const viewport_size) {
+        return project_gizmo(prepare_gizmo(gizmo, gizmo_transform), view_projection, viewport_size);
+    }
+
+    [[nodiscard]] static f32 distance_to_segment(math::Vec2 const point, math::Vec2 const a, math::Vec2 const b) {
+        math::Vec2 const ab = b - a;
+        math::Vec2 const ap = point - a;
+        f32 const length_squared = math::dot(ab, ab);
+        f32 t = 0.0f;
+        if(length_squared > 0.0f) {
+            t = math::clamp(math::dot(ap, ab) / length_squared, 0.0f, 1.0f);
+        }
+        return math::length(ap - ab * t);
+    }
+
+    // distance_to_ellipse
+    // Calculates the distance from a point to an ellipse centered at the origin with the semi-axes a >= b >= 0 along
+    // the x and y axes. The nearest point of the ellipse (a * r0 * x / (s + r0), y / (s + 1)) in the units of b, where
+    // r0 = (a / b)^2, is found by bisecting for the root s of the equation of the ellipse.
+    //
+    [[nodiscard]] static f32 distance_to_ellipse(f32 const point_x, f32 const point_y, f32 const a, f32 const b) {
+        // The ellipse is symmetric, hence the nearest point lies in the same quadrant as the point.
+        f64 const x = math::abs(point_x);
+        f64 const y = math::abs(point_y);
+        if(b <= 1e-4f * a) {
+            // A circle seen edge-on is a segment.
+            f64 const dx = x > a ? x - a : 0.0;
+            return static_cast<f32>(::sqrt(dx * dx + y * y));
+        }
+
+        if(y == 0.0) {
+            f64 const numerator = a * x;
+            f64 const denominator = static_cast<f64>(a) * a - static_cast<f64>(b) * b;
+            if(numerator >= denominator) {
+                return static_cast<f32>(x > a ? x - a : a - x);
+            }
+
+            // The nearest point lies off the x axis.
+            f64 const ratio = numerator / denominator;
+            f64 const nearest_x = a * ratio;
+            f64 const nearest_y = b * ::sqrt(1.0 - ratio * ratio);
+            return static_cast<f32>(::sqrt((nearest_x - x) * (nearest_x - x) + nearest_y * nearest_y));
+        }
+
+        if(x == 0.0) {
+            return static_cast<f32>(y > b ? y - b : b - y);
+        }
+
+        f64 const z0 = x / a;
+        f64 const z1 = y / b;
+        f64 const g = z0 * z0 + z1 * z1 - 1.0;
+        if(g == 0.0) {
+            return 0.0f;
+        }
+
+        f64 const r0 = (static_cast<f64>(a) / b) * (static_cast<f64>(a) / b);
+        f64 const n0 = r0 * z0;
+        f64 s0 = z1 - 1.0;
+        f64 s1 = g < 0.0 ? 0.0 : ::sqrt(n0 * n0 + z1 * z1) * (1.0 + 1e-6) - 1.0;
+        f64 s = 0.0;
+        for(i32 iteration = 0; iteration < 64; ++iteration) {
+            s = 0.5 * (s0 + s1);
+            // The precision of the result, which is a f32.
+            if(s1 - s0 <= 1e-7 * (1.0 + (s > 0.0 ? s : -s))) {
+                break;
+            }
+
+            f64 const ratio0 = n0 / (s + r0);
+            f64 const ratio1 = z1 / (s + 1.0);
+            f64 const value = ratio0 * ratio0 + ratio1 * ratio1 - 1.0;
+            if(value > 0.0) {
+                s0 = s;
+            } else if(value < 0.0) {
+                s1 = s;
+            } else {
+                break;
+            }
+        }
+
+        f64 const nearest_x = r0 * x / (s + r0);
+        f64 const nearest_y = y / (s + 1.0);
+        return static_cast<f32>(::sqrt((nearest_x - x) * (nearest_x - x) + (nearest_y - y) * (nearest_y - y)));
+    }
+
+    [[nodiscard]] static f32 cross(math::Vec2 const a, math::Vec2 const b) {
+        return a.x * b.y - a.y * b.x;
+    }
+
+    // calculate_pixel_distance
+    // Calculates the distance from the cursor to the skeleton of a handle.
+    //
+    // Returns:
+    // The distance or infinity if it is greater than tolerance.
+    //
+    [[nodiscard]] static f32 calculate_pixel_distance(math::Vec2 const cursor, Projected_Handle const& handle, f32 const tolerance) {
+        switch(handle.shape) {
+            case Projected_Handle_Shape::none:
+                return math::infinity;
+
+            case Projected_Handle_Shape::segment:
+                return distance_to_segment(cursor, handle.points[0], handle.points[1]);
+
+            case Projected_Handle_Shape::ellipse:
+            case Projected_Handle_Shape::filled_ellipse: {
+                math::Vec2 const offset = cursor - handle.points[0];
+                f32 const a = handle.major_radius;
+                f32 const b = handle.minor_radius;
+                // Points outside of the circle around the ellipse grown by tolerance are too far.
+                f32 const outer = a + tolerance;
+                if(math::dot(offset, offset) > outer * outer) {
+                    return math::infinity;
+                }
+
+                f32 const x = math::dot(offset, handle.major_axis);
+                f32 const y = cross(handle.major_axis, offset);
+                f32 const value = b > 0.0f ? (x * x) / (a * a) + (y * y) / (b * b) : math::infinity;
+                if(value <= 1.0f) {
+                    if(handle.shape == Projected_Handle_Shape::filled_ellipse) {
+                        return 0.0f;
+                    }
+
+                    // Points inside of the ellipse scaled by 1 - tolerance / b are too far from the outline. The distance
+                    // between the scaled ellipse and the outline is at least tolerance, because the support function of
+                    // the ellipse is never smaller than b. The ellipse with the semi-axes shrunk by tolerance instead reaches
+                    // past the curve at tolerance inside of the outline near the ends of the major axis.
+                    f32 const scale = 1.0f - tolerance / b;
+                    if(scale > 0.0f && value < scale * scale) {
+                        return math::infinity;
+                    }
+                }
+                return distance_to_ellipse(x, y, a, b);
+            }
+
+            case Projected_Handle_Shape::quad: {
+                // The projection of a square in front of the camera is convex. The cursor is inside if it lies on the same
+                // side of every edge.
+                bool positive = true;
+                bool negative = true;
+                f32 distance = math::infinity;
+                for(i64 i = 0; i < 4; ++i) {
+                    math::Vec2 const a = handle.points[i];
+                    math::Vec2 const b = handle.points[(i + 1) % 4];
+                    f32 const side = cross(b - a, cursor - a);
+                    positive = positive && side >= 0.0f;
+                    negative = negative && side <= 0.0f;
+                    distance = math::min(distance, distance_to_segment(cursor, a, b));
+                }
+                return positive || negative ? 0.0f : distance;
+            }
+        }
+    }
+
+    Optional<Gizmo_Screen_Pick> pick_projected_gizmo(math::Vec2 const cursor, Projected_Gizmo const& gizmo, f32 const pixel_tolerance,
+                                                     u32 const base_handle_id) {
+        if(cursor.x < gizmo.bounds_min.x - pixel_tolerance || cursor.x > gizmo.bounds_max.x + pixel_tolerance ||
+           cursor.y < gizmo.bounds_min.y - pixel_tolerance || cursor.y > gizmo.bounds_max.y + pixel_tolerance) {
+            return null_optional;
+        }
+
+        Optional<Gizmo_Screen_Pick> result = null_optional;
+        bool result_is_outline = false;
+        for(i64 i = 0; i < gizmo_handle_count; ++i) {
+            Projected_Handle const& handle = gizmo.handles[i];
+            f32 const distance = calculate_pixel_distance(cursor, handle, pixel_tolerance);
+            if(!(distance <= pixel_tolerance)) {
+                continue;
+            }
+
+            bool const is_outline = handle.shape == Projected_Handle_Shape::segment || handle.shape == Projected_Handle_Shape::ellipse;
+            bool const better = !result || (is_outline && !result_is_outline) || (is_outline == result_is_outline && distance < result->pixel_distance);
+            if(better) {
+                Gizmo_Handle const picked = static_cast<Gizmo_Handle>(i);
+                result = Gizmo_Screen_Pick{picked, base_handle_id + static_cast<u32>(picked), distance};
+                result_is_outline = is_outline;
+            }
+        }
+        return result;
+    }
+} // namespace anton::gizmo
@@ -3,245 +3,478 @@
 #include <anton/math/math.hpp>
 #include <intersection_tests.hpp>
 #include <utils.hpp>
+#include <vertex_output.hpp>
 
 namespace anton::gizmo {
-    Array<math::Vec3> generate_filled_circle(i32 const vertex_count) {
+    i64 filled_circle_vertex_count(i32 const vertex_count) {
+        return 3 * (i64)vertex_count;
+    }
+
+    template<typename Output>
+    static void write_filled_circle(i32 const vertex_count, Output& output) {
         math::Vec3 const origin{0.0f, 0.0f, 0.0f};
-        Array<math::Vec3> circle = generate_circle(origin, math::Vec3{0.0f, 0.0f, -1.0f}, 1.0f, vertex_count);
-        Array<math::Vec3> result{reserve, 3 * vertex_count};
+        Circle_Generator circle{origin, math::Vec3{0.0f, 0.0f, -1.0f}, 1.0f, vertex_count};
+        math::Vec3 const first = circle.next();
+        math::Vec3 v2 = first;
         for(i64 i = 0; i < vertex_count; ++i) {
-            math::Vec3 const& v2 = circle[i];
-            math::Vec3 const& v3 = circle[(i + 1) % vertex_count];
-            result.emplace_back(origin);
-            result.emplace_back(v3);
-            result.emplace_back(v2);
+            math::Vec3 const v3 = i + 1 < vertex_count ? circle.next() : first;
+            output.write(origin);
+            output.write(v3);
+            output.write(v2);
+            v2 = v3;
         }
-        return result;
     }
 
-    Array<math::Vec3> generate_square() {
+    void generate_filled_circle(i32 const vertex_count, Slice<math::Vec3> const vertices) {
+        Position_Output output{vertices};
+        write_filled_circle(vertex_count, output);
+    }
+
+    Position_Dequantization generate_filled_circle(i32 const vertex_count, Vertex_Layout const& layout, u32 const handle_id, Slice<u8> const buffer) {
+        Vertex_Output output{layout, handle_id, math::Vec3{-1.0f, -1.0f, 0.0f}, math::Vec3{1.0f, 1.0f, 0.0f}, buffer};
+        write_filled_circle(vertex_count, output);
+        return output.get_dequantization();
+    }
+
+    Array<math::Vec3> generate_filled_circle(i32 const vertex_count) {
+        Array<math::Vec3> vertices(filled_circle_vertex_count(vertex_count));
+        generate_filled_circle(vertex_count, vertices);
+        return vertices;
+    }
+
+    i64 square_vertex_count() {
+        return 6;
+    }
+
+    template<typename Output>
+    static void write_square(Output& output) {
         math::Vec3 const v1{0.5f, 0.5f, 0.0f};
         math::Vec3 const v2{0.5f, -0.5f, 0.0f};
         math::Vec3 const v3{-0.5f, 0.5f, 0.0f};
         math::Vec3 const v4{-0.5f, -0.5f, 0.0f};
-        Array<math::Vec3> square{reserve, 6};
-        square.emplace_back(v1);
-        square.emplace_back(v2);
-        square.emplace_back(v3);
-        square.emplace_back(v3);
-        square.emplace_back(v2);
-        square.emplace_back(v4);
+        output.write(v1);
+        output.write(v2);
+        output.write(v3);
+        output.write(v3);
+        output.write(v2);
+        output.write(v4);
+    }
+
+    void generate_square(Slice<math::Vec3> const vertices) {
+        Position_Output output{vertices};
+        write_square(output);
+    }
+
+    Position_Dequantization generate_square(Vertex_Layout const& layout, u32 const handle_id, Slice<u8> const buffer) {
+        Vertex_Output output{layout, handle_id, math::Vec3{-0.5f, -0.5f, 0.0f}, math::Vec3{0.5f, 0.5f, 0.0f}, buffer};
+        write_square(output);
+        return output.get_dequantization();
+    }
+
+    Array<math::Vec3> generate_square() {
+        Array<math::Vec3> square(square_vertex_count());
+        generate_square(square);
         return square;
     }
 
-    Array<math::Vec3> generate_cube(f32 const edge_length) {
-        f32 const half_size = 0.5f * edge_length;
-        Array<math::Vec3> cube{reserve, 36};
-        // Generate cube
-        // Top face
-        cube.emplace_back(math::Vec3{-half_size, half_size, half_size});
-        cube.emplace_back(math::Vec3{half_size, half_size, half_size});
-        cube.emplace_back(math::Vec3{-half_size, half_size, -half_size});
-        cube.emplace_back(math::Vec3{-half_size, half_size, -half_size});
-        cube.emplace_back(math::Vec3{half_size, half_size, half_size});
-        cube.emplace_back(math::Vec3{half_size, half_size, -half_size});
-        // Bottom face
-        cube.emplace_back(math::Vec3{-half_size, -half_size, half_size});
-        cube.emplace_back(math::Vec3{-half_size, -half_size, -half_size});
-        cube.emplace_back(math::Vec3{half_size, -half_size, half_size});
-        cube.emplace_back(math::Vec3{-half_size, -half_size, -half_size});
-        cube.emplace_back(math::Vec3{half_size, -half_size, -half_size});
-        cube.emplace_back(math::Vec3{half_size, -half_size, half_size});
-        // Right face
-        cube.emplace_back(math::Vec3{half_size, half_size, half_size});
-        cube.emplace_back(math::Vec3{half_size, -half_size, half_size});
-        cube.emplace_back(math::Vec3{half_size, -half_size, -half_size});
-        cube.emplace_back(math::Vec3{half_size, half_size, half_size});
-        cube.emplace_back(math::Vec3{half_size, -half_size, -half_size});
-        cube.emplace_back(math::Vec3{half_size, half_size, -half_size});
-        // Left face
-        cube.emplace_back(math::Vec3{-half_size, half_size, half_size});
-        cube.emplace_back(math::Vec3{-half_size, -half_size, -half_size});
-        cube.emplace_back(math::Vec3{-half_size, -half_size, half_size});
-        cube.emplace_back(math::Vec3{-half_size, half_size, half_size});
-        cube.emplace_back(math::Vec3{-half_size, half_size, -half_size});
-        cube.emplace_back(math::Vec3{-half_size, -half_size, -half_size});
-        // Front face
-        cube.emplace_back(math::Vec3{-half_size, half_size, -half_size});
-        cube.emplace_back(math::Vec3{half_size, half_size, -half_size});
-        cube.emplace_back(math::Vec3{-half_size, -half_size, -half_size});
-        cube.emplace_back(math::Vec3{-half_size, -half_size, -half_size});
-        cube.emplace_back(math::Vec3{half_size, half_size, -half_size});
-        cube.emplace_back(math::Vec3{half_size, -half_size, -half_size});
-        // Back face
-        cube.emplace_back(math::Vec3{-half_size, half_size, half_size});
-        cube.emplace_back(math::Vec3{-half_size, -half_size, half_size});
-        cube.emplace_back(math::Vec3{half_size, half_size, half_size});
-        cube.emplace_back(math::Vec3{-half_size, -half_size, half_size});
-        cube.emplace_back(math::Vec3{half_size, -half_size, half_size});
-        cube.emplace_back(math::Vec3{half_size, half_size, half_size});
+    Indexed_Geometry generate_filled_circle_indexed(i32 const vertex_count) {
+        math::Vec3 const origin{0.0f, 0.0f, 0.0f};
+        Array<math::Vec3> circle = generate_circle(origin, math::Vec3{0.0f, 0.0f, -1.0f}, 1.0f, vertex_count);
+        Indexed_Geometry geometry{Array<math::Vec3>{reserve, vertex_count + 1}, Array<u32>{reserve, 3 * vertex_count}};
+        geometry.vertices.emplace_back(origin);
+        for(i64 i = 0; i < vertex_count; ++i) {
+            geometry.vertices.emplace_back(circle[i]);
+        }
+
+        u32 const count = vertex_count;
+        for(u32 i = 0; i < count; ++i) {
+            geometry.indices.emplace_back(0);
+            geometry.indices.emplace_back(1 + (i + 1) % count);
+            geometry.indices.emplace_back(1 + i);
+        }
+        return geometry;
+    }
+
+    Indexed_Geometry generate_square_indexed() {
+        Indexed_Geometry geometry{Array<math::Vec3>{reserve, 4}, Array<u32>{reserve, 6}};
+        geometry.vertices.emplace_back(0.5f, 0.5f, 0.0f);
+        geometry.vertices.emplace_back(0.5f, -0.5f, 0.0f);
+        geometry.vertices.emplace_back(-0.5f, 0.5f, 0.0f);
+        geometry.vertices.emplace_back(-0.5f, -0.5f, 0.0f);
+        geometry.indices.emplace_back(0);
+        geometry.indices.emplace_back(1);
+        geometry.indices.emplace_back(2);
+        geometry.indices.emplace_back(2);
+        geometry.indices.emplace_back(1);
+        geometry.indices.emplace_back(3);
+        return geometry;
+    }
+
+    i64 cube_vertex_count() {
+        return 36;
+    }
+
+    template<typename Output>
+    static void write_cube(Output& output) {
+        for(u32 const index: cube_indices) {
+            output.write(cube_corners[index]);
+        }
+    }
+
+    void generate_cube(Slice<math::Vec3> const vertices) {
+        Position_Output output{vertices};
+        write_cube(output);
+    }
+
+    Position_Dequantization generate_cube(Vertex_Layout const& layout, u32 const handle_id, Slice<u8> const buffer) {
+        Vertex_Output output{layout, handle_id, math::Vec3{-0.5f}, math::Vec3{0.5f}, buffer};
+        write_cube(output);
+        return output.get_dequantization();
+    }
+
+    Array<math::Vec3> generate_cube() {
+        Array<math::Vec3> cube(cube_vertex_count());
+        generate_cube(cube);
         return cube;
     }
 
-    Array<math::Vec3> generate_icosphere(i64 const subdivision_level) {
+    Indexed_Geometry generate_cube_indexed() {
+        Indexed_Geometry geometry{Array<math::Vec3>{reserve, 8}, Array<u32>{reserve, 36}};
+        for(math::Vec3 const& corner: cube_corners) {
+            geometry.vertices.emplace_back(corner);
+        }
+        for(u32 const index: cube_indices) {
+            geometry.indices.emplace_back(index);
+        }
+        return geometry;
+    }
+
+    // Indices of the faces of the base icosahedron into the vertices calculated by get_icosahedron_vertices.
+    // Faces around xy_v1, 5 adjacent faces, faces around xy_v3 and 5 adjacent faces, all in CCW order.
+    static u32 const icosahedron_indices[60] = {0,  9, 10, 0,  10, 7, 0, 7, 3, 0, 3, 6, 0, 6, 9, 10, 9, 1, 7, 10, 4, 3, 7, 11, 6, 3, 8, 9, 6, 5,
+                                                2,  8, 11, 2,  11, 4, 2, 4, 1, 2, 1, 5, 2, 5, 8, 11, 8, 3, 4, 11, 7, 1, 4, 10, 5, 1, 9, 8, 5, 6};
+
+    // Calculates the 12 vertices of the base icosahedron.
+    static void get_icosahedron_vertices(math::Vec3 (&vertices)[12]) {
         // The vertices of an icoshpere are formed by the corners of 3 orthogonal intersecting
         // rectangles with edge lengths 1 and golden ratio.
         // The first letter is the axis along which the shorter edge of the rectangle is.
         // The second letter is the axis along which the longer edge of the rectangle is.
         // Points are in CCW order from the top-left (when the plane normal is facing us and the 2nd axis is oriented upwards).
+        // The vertices are stored in the order xy_v1-4, yz_v1-4, zx_v1-4.
 
         f32 const vert_inv_len = math::inv_sqrt(1.0f + math::golden_ratio * math::golden_ratio);
 
-        math::Vec3 const xy_v1 = math::Vec3{-1.0f, math::golden_ratio, 0.0f} * vert_inv_len;
-        math::Vec3 const xy_v2 = math::Vec3{-1.0f, -math::golden_ratio, 0.0f} * vert_inv_len;
-        math::Vec3 const xy_v3 = math::Vec3{1.0f, -math::golden_ratio, 0.0f} * vert_inv_len;
-        math::Vec3 const xy_v4 = math::Vec3{1.0f, math::golden_ratio, 0.0f} * vert_inv_len;
-
-        math::Vec3 const yz_v1 = math::Vec3{0.0f, -1.0f, math::golden_ratio} * vert_inv_len;
-        math::Vec3 const yz_v2 = math::Vec3{0.0f, -1.0f, -math::golden_ratio} * vert_inv_len;
-        math::Vec3 const yz_v3 = math::Vec3{0.0f, 1.0f, -math::golden_ratio} * vert_inv_len;
-        math::Vec3 const yz_v4 = math::Vec3{0.0f, 1.0f, math::golden_ratio} * vert_inv_len;
-
-        math::Vec3 const zx_v1 = math::Vec3{math::golden_ratio, 0.0f, -1.0f} * vert_inv_len;
-        math::Vec3 const zx_v2 = math::Vec3{-math::golden_ratio, 0.0f, -1.0f} * vert_inv_len;
-        math::Vec3 const zx_v3 = math::Vec3{-math::golden_ratio, 0.0f, 1.0f} * vert_inv_len;
-        math::Vec3 const zx_v4 = math::Vec3{math::golden_ratio, 0.0f, 1.0f} * vert_inv_len;
-
-        Array<math::Vec3> vertices{reserve, 60};
+        vertices[0] = math::Vec3{-1.0f, math::golden_ratio, 0.0f} * vert_inv_len;
+        vertices[1] = math::Vec3{-1.0f, -math::golden_ratio, 0.0f} * vert_inv_len;
+        vertices[2] = math::Vec3{1.0f, -math::golden_ratio, 0.0f} * vert_inv_len;
+        vertices[3] = math::Vec3{1.0f, math::golden_ratio, 0.0f} * vert_inv_len;
 
-        // Faces around xy_v1 point in CCW order
-        vertices.emplace_back(xy_v1);
-        vertices.emplace_back(zx_v2);
-        vertices.emplace_back(zx_v3);
+        vertices[4] = math::Vec3{0.0f, -1.0f, math::golden_ratio} * vert_inv_len;
+        vertices[5] = math::Vec3{0.0f, -1.0f, -math::golden_ratio} * vert_inv_len;
+        vertices[6] = math::Vec3{0.0f, 1.0f, -math::golden_ratio} * vert_inv_len;
+        vertices[7] = math::Vec3{0.0f, 1.0f, math::golden_ratio} * vert_inv_len;
 
-        vertices.emplace_back(xy_v1);
-        vertices.emplace_back(zx_v3);
-        vertices.emplace_back(yz_v4);
-
-        vertices.emplace_back(xy_v1);
-        vertices.emplace_back(yz_v4);
-        vertices.emplace_back(xy_v4);
+        vertices[8] = math::Vec3{math::golden_ratio, 0.0f, -1.0f} * vert_inv_len;
+        vertices[9] = math::Vec3{-math::golden_ratio, 0.0f, -1.0f} * vert_inv_len;
+        vertices[10] = math::Vec3{-math::golden_ratio, 0.0f, 1.0f} * vert_inv_len;
+        vertices[11] = math::Vec3{math::golden_ratio, 0.0f, 1.0f} * vert_inv_len;
+    }
 
-        vertices.emplace_back(xy_v1);
-        vertices.emplace_back(xy_v4);
-        vertices.emplace_back(yz_v3);
+    i64 icosphere_vertex_count(i64 const subdivision_level) {
+        return 60 * ((i64)1 << (2 * subdivision_level));
+    }
 
-        vertices.emplace_back(xy_v1);
-        vertices.emplace_back(yz_v3);
-        vertices.emplace_back(zx_v2);
+    // Face (v1, v2, v3) is replaced by the faces (v1, a, b), (v2, c, a), (v3, b, c) and (a, c, b) where a, b and c are
+    // the normalized midpoints of the edges (v1, v2), (v1, v3) and (v2, v3). The faces are subdivided depth-first,
+    // so only the vertices of the finest level are written to the output.
+    template<typename Output>
+    static void subdivide_icosphere_face(Output& output, math::Vec3 const& v1, math::Vec3 const& v2, math::Vec3 const& v3, i64 const subdivision_level) {
+        if(subdivision_level == 0) {
+            output.write(v1);
+            output.write(v2);
+            output.write(v3);
+            return;
+        }
 
-        // 5 adjacent faces
-        vertices.emplace_back(zx_v3);
-        vertices.emplace_back(zx_v2);
-        vertices.emplace_back(xy_v2);
+        math::Vec3 const a = math::normalize(v1 + v2);
+        math::Vec3 const b = math::normalize(v1 + v3);
+        math::Vec3 const c = math::normalize(v2 + v3);
+        if(subdivision_level == 1) {
+            // Write the last level directly to avoid the overhead of the recursion on the most frequent path.
+            math::Vec3 const faces[12] = {v1, a, b, v2, c, a, v3, b, c, a, c, b};
+            for(math::Vec3 const& vertex: faces) {
+                output.write(vertex);
+            }
+            return;
+        }
 
-        vertices.emplace_back(yz_v4);
-        vertices.emplace_back(zx_v3);
-        vertices.emplace_back(yz_v1);
+        subdivide_icosphere_face(output, v1, a, b, subdivision_level - 1);
+        subdivide_icosphere_face(output, v2, c, a, subdivision_level - 1);
+        subdivide_icosphere_face(output, v3, b, c, subdivision_level - 1);
+        subdivide_icosphere_face(output, a, c, b, subdivision_level - 1);
+    }
 
-        vertices.emplace_back(xy_v4);
-        vertices.emplace_back(yz_v4);
-        vertices.emplace_back(zx_v4);
+    template<typename Output>
+    static void write_icosphere(i64 const subdivision_level, Output& output) {
+        math::Vec3 icosahedron[12];
+        get_icosahedron_vertices(icosahedron);
+        for(i64 i = 0; i < 60; i += 3) {
+            subdivide_icosphere_face(output, icosahedron[icosahedron_indices[i]], icosahedron[icosahedron_indices[i + 1]],
+                                     icosahedron[icosahedron_indices[i + 2]], subdivision_level);
+        }
+    }
 
-        vertices.emplace_back(yz_v3);
-        vertices.emplace_back(xy_v4);
-        vertices.emplace_back(zx_v1);
+    void generate_icosphere(i64 const subdivision_level, Slice<math::Vec3> const vertices) {
+        Position_Output output{vertices};
+        write_icosphere(subdivision_level, output);
+    }
 
-        vertices.emplace_back(zx_v2);
-        vertices.emplace_back(yz_v3);
-        vertices.emplace_back(yz_v2);
+    Position_Dequantization generate_icosphere(i64 const subdivision_level, Vertex_Layout const& layout, u32 const handle_id, Slice<u8> const buffer) {
+        Vertex_Output output{layout, handle_id, math::Vec3{-1.0f}, math::Vec3{1.0f}, buffer};
+        write_icosphere(subdivision_level, output);
+        return output.get_dequantization();
+    }
 
-        // Faces around xy_v3 point in CCW order
-        vertices.emplace_back(xy_v3);
-        vertices.emplace_back(zx_v1);
-        vertices.emplace_back(zx_v4);
+    // The indexed icosphere keeps the edges of every level in addition to the faces. The midpoint of edge e
+    // of a level with vertex_count vertices becomes vertex vertex_count + e of the next level, therefore each
+    // midpoint is computed and normalized exactly once and the edges and faces can be subdivided independently.
+    //
+    // Every face stores the indices of its edges in the order (v1, v2), (v1, v3), (v2, v3).
+    // Edge e = (p, q) is split into edges 2e = (p, m) and 2e + 1 = (m, q) where m is its midpoint.
+    // Face f adds 3 interior edges 2 * edge_count + 3f + [0, 1, 2].
+    struct Icosphere_Subdivision {
+        math::Vec3* vertices;
+        u32 const* faces;
+        u32 const* face_edges;
+        u32 const* edges;
+        u32* subdivided_faces;
+        u32* subdivided_face_edges;
+        u32* subdivided_edges;
+        i64 vertex_count;
+        i64 face_count;
+        i64 edge_count;
+        // Whether to build the edges of the subdivided level. Not needed for the last level.
+        bool build_edges;
+    };
+
+    static constexpr i64 icosphere_task_size = 4096;
+
+    // Returns the half of the edge that contains vertex.
+    [[nodiscard]] static u32 get_half_edge(u32 const* const edges, u32 const edge, u32 const vertex) {
+        return edges[2 * edge] == vertex ? 2 * edge : 2 * edge + 1;
+    }
 
-        vertices.emplace_back(xy_v3);
-        vertices.emplace_back(zx_v4);
-        vertices.emplace_back(yz_v1);
+    static void subdivide_icosphere_edges(void* const data, i64 const task) {
+        Icosphere_Subdivision const& s = *static_cast<Icosphere_Subdivision const*>(data);
+        i64 const first = task * icosphere_task_size;
+        i64 const last = math::min(first + icosphere_task_size, s.edge_count);
+        for(i64 e = first; e < last; ++e) {
+            u32 const p = s.edges[2 * e];
+            u32 const q = s.edges[2 * e + 1];
+            u32 const midpoint = s.vertex_count + e;
+            s.vertices[midpoint] = math::normalize(s.vertices[p] + s.vertices[q]);
+            if(s.build_edges) {
+                u32* const halves = s.subdivided_edges + 4 * e;
+                halves[0] = p;
+                halves[1] = midpoint;
+                halves[2] = midpoint;
+                halves[3] = q;
+            }
+        }
+    }
 
-        vertices.emplace_back(xy_v3);
-        vertices.emplace_back(yz_v1);
-        vertices.emplace_back(xy_v2);
+    static void subdivide_icosphere_faces(void* const data, i64 const task) {
+        Icosphere_Subdivision const& s = *static_cast<Icosphere_Subdivision const*>(data);
+        i64 const first = task * icosphere_task_size;
+        i64 const last = math::min(first + icosphere_task_size, s.face_count);
+        for(i64 f = first; f < last; ++f) {
+            u32 const v1 = s.faces[3 * f];
+            u32 const v2 = s.faces[3 * f + 1];
+            u32 const v3 = s.faces[3 * f + 2];
+            u32 const e12 = s.face_edges[3 * f];
+            u32 const e13 = s.face_edges[3 * f + 1];
+            u32 const e23 = s.face_edges[3 * f + 2];
+            u32 const a = s.vertex_count + e12;
+            u32 const b = s.vertex_count + e13;
+            u32 const c = s.vertex_count + e23;
+
+            u32* const subdivided = s.subdivided_faces + 12 * f;
+            subdivided[0] = v1;
+            subdivided[1] = a;
+            subdivided[2] = b;
+
+            subdivided[3] = v2;
+            subdivided[4] = c;
+            subdivided[5] = a;
+
+            subdivided[6] = v3;
+            subdivided[7] = b;
+            subdivided[8] = c;
+
+            subdivided[9] = a;
+            subdivided[10] = c;
+            subdivided[11] = b;
+
+            if(s.build_edges) {
+                u32 const ab = 2 * s.edge_count + 3 * f;
+                u32 const ac = ab + 1;
+                u32 const bc = ab + 2;
+                u32* const subdivided_face_edges = s.subdivided_face_edges + 12 * f;
+                subdivided_face_edges[0] = get_half_edge(s.edges, e12, v1);
+                subdivided_face_edges[1] = get_half_edge(s.edges, e13, v1);
+                subdivided_face_edges[2] = ab;
+
+                subdivided_face_edges[3] = get_half_edge(s.edges, e23, v2);
+                subdivided_face_edges[4] = get_half_edge(s.edges, e12, v2);
+                subdivided_face_edges[5] = ac;
+
+                subdivided_face_edges[6] = get_half_edge(s.edges, e13, v3);
+                subdivided_face_edges[7] = get_half_edge(s.edges, e23, v3);
+                subdivided_face_edges[8] = bc;
+
+                subdivided_face_edges[9] = ac;
+                subdivided_face_edges[10] = ab;
+                subdivided_face_edges[11] = bc;
+
+                u32* const interior_edges = s.subdivided_edges + 2 * ab;
+                interior_edges[0] = a;
+                interior_edges[1] = b;
+                interior_edges[2] = a;
+                interior_edges[3] = c;
+                interior_edges[4] = b;
+                interior_edges[5] = c;
+            }
+        }
+    }
 
-        vertices.emplace_back(xy_v3);
-        vertices.emplace_back(xy_v2);
-        vertices.emplace_back(yz_v2);
+    Indexed_Geometry generate_icosphere_indexed(i64 const subdivision_level, Task_Executor* const executor) {
+        i64 const final_face_count = 20 * ((i64)1 << (2 * subdivision_level));
+        // Euler's formula: V - E + F = 2 and E = 3F / 2.
+        i64 const final_vertex_count = final_face_count / 2 + 2;
+        i64 const final_edge_count = 3 * final_face_count / 2;
+        Indexed_Geometry geometry{Array<math::Vec3>(final_vertex_count), Array<u32>{}};
+        math::Vec3 icosahedron[12];
+        get_icosahedron_vertices(icosahedron);
+        for(i64 i = 0; i < 12; ++i) {
+            geometry.vertices[i] = icosahedron[i];
+        }
 
-        vertices.emplace_back(xy_v3);
-        vertices.emplace_back(yz_v2);
-        vertices.emplace_back(zx_v1);
+        Array<u32> faces[2] = {Array<u32>{reserve, 3 * final_face_count}, Array<u32>{reserve, 3 * final_face_count}};
+        Array<u32> face_edges[2] = {Array<u32>{reserve, 3 * final_face_count / 4}, Array<u32>{reserve, 3 * final_face_count / 4}};
+        Array<u32> edges[2] = {Array<u32>{reserve, 2 * final_edge_count / 4}, Array<u32>{reserve, 2 * final_edge_count / 4}};
+        // Find the edges of the icosahedron.
+        for(i64 i = 0; i < 60; i += 3) {
+            u32 const v1 = icosahedron_indices[i];
+            u32 const v2 = icosahedron_indices[i + 1];
+            u32 const v3 = icosahedron_indices[i + 2];
+            faces[0].emplace_back(v1);
+            faces[0].emplace_back(v2);
+            faces[0].emplace_back(v3);
+            u32 const face_vertex_pairs[3][2] = {{v1, v2}, {v1, v3}, {v2, v3}};
+            for(auto const& pair: face_vertex_pairs) {
+                i64 edge = 0;
+                i64 const edge_count = edges[0].size() / 2;
+                for(; edge < edge_count; ++edge) {
+                    u32 const p = edges[0][2 * edge];
+                    u32 const q = edges[0][2 * edge + 1];
+                    if((p == pair[0] && q == pair[1]) || (p == pair[1] && q == pair[0])) {
+                        break;
+                    }
+                }
+
+                if(edge == edge_count) {
+                    edges[0].emplace_back(pair[0]);
+                    edges[0].emplace_back(pair[1]);
+                }
+                face_edges[0].emplace_back(edge);
+            }
+        }
 
-        // 5 adjacent faces
-        vertices.emplace_back(zx_v4);
-        vertices.emplace_back(zx_v1);
-        vertices.emplace_back(xy_v4);
+        i64 current = 0;
+        i64 vertex_count = 12;
+        i64 face_count = 20;
+        i64 edge_count = 30;
+        for(i64 s = 0; s < subdivision_level; ++s) {
+            i64 const next = 1 - current;
+            bool const build_edges = s + 1 < subdivision_level;
+            faces[next].resize(12 * face_count);
+            if(build_edges) {
+                face_edges[next].resize(12 * face_count);
+                edges[next].resize(2 * (2 * edge_count + 3 * face_count));
+            }
 
-        vertices.emplace_back(yz_v1);
-        vertices.emplace_back(zx_v4);
-        vertices.emplace_back(yz_v4);
+            Icosphere_Subdivision subdivision;
+            subdivision.vertices = geometry.vertices.data();
+            subdivision.faces = faces[current].data();
+            subdivision.face_edges = face_edges[current].data();
+            subdivision.edges = edges[current].data();
+            subdivision.subdivided_faces = faces[next].data();
+            subdivision.subdivided_face_edges = face_edges[next].data();
+            subdivision.subdivided_edges = edges[next].data();
+            subdivision.vertex_count = vertex_count;
+            subdivision.face_count = face_count;
+            subdivision.edge_count = edge_count;
+            subdivision.build_edges = build_edges;
+            execute_tasks(executor, (edge_count + icosphere_task_size - 1) / icosphere_task_size, subdivide_icosphere_edges, &subdivision);
+            execute_tasks(executor, (face_count + icosphere_task_size - 1) / icosphere_task_size, subdivide_icosphere_faces, &subdivision);
+
+            vertex_count += edge_count;
+            edge_count = 2 * edge_count + 3 * face_count;
+            face_count *= 4;
+            current = next;
+        }
 
-        vertices.emplace_back(xy_v2);
-        vertices.emplace_back(yz_v1);
-        vertices.emplace_back(zx_v3);
+        geometry.indices = ANTON_MOV(faces[current]);
+        return geometry;
+    }
 
-        vertices.emplace_back(yz_v2);
-        vertices.emplace_back(xy_v2);
-        vertices.emplace_back(zx_v2);
+    struct Icosphere_Expansion {
+        math::Vec3 const* vertices;
+        u32 const* indices;
+        math::Vec3* expanded;
+        i64 index_count;
+    };
+
+    static void expand_icosphere(void* const data, i64 const task) {
+        Icosphere_Expansion const& e = *static_cast<Icosphere_Expansion const*>(data);
+        i64 const first = task * icosphere_task_size;
+        i64 const last = math::min(first + icosphere_task_size, e.index_count);
+        for(i64 i = first; i < last; ++i) {
+            e.expanded[i] = e.vertices[e.indices[i]];
+        }
+    }
 
-        vertices.emplace_back(zx_v1);
-        vertices.emplace_back(yz_v2);
-        vertices.emplace_back(yz_v3);
-
-        // Subdivision
-        for(i64 s = 0; s < subdivision_level; ++s) {
-            Array<math::Vec3> subdivided{reserve, 4 * vertices.size()};
-            for(i64 i = 0; i < vertices.size(); i += 3) {
-                math::Vec3& v1 = vertices[i];
-                math::Vec3& v2 = vertices[i + 1];
-                math::Vec3& v3 = vertices[i + 2];
-
-                math::Vec3 const a = math::normalize(v1 + v2);
-                math::Vec3 const b = math::normalize(v1 + v3);
-                math::Vec3 const c = math::normalize(v2 + v3);
-
-                subdivided.emplace_back(v1);
-                subdivided.emplace_back(a);
-                subdivided.emplace_back(b);
-
-                subdivided.emplace_back(v2);
-                subdivided.emplace_back(c);
-                subdivided.emplace_back(a);
-
-                subdivided.emplace_back(v3);
-                subdivided.emplace_back(b);
-                subdivided.emplace_back(c);
-
-                subdivided.emplace_back(a);
-                subdivided.emplace_back(c);
-                subdivided.emplace_back(b);
-            }
-            vertices = ANTON_MOV(subdivided);
+    Array<math::Vec3> generate_icosphere(i64 const subdivision_level, Task_Executor* const executor) {
+        Array<math::Vec3> vertices(icosphere_vertex_count(subdivision_level));
+        if(!executor) {
+            // Generating the triangle list directly is faster than expanding the indexed icosphere on a single thread.
+            generate_icosphere(subdivision_level, vertices);
+            return vertices;
         }
 
+        Indexed_Geometry const geometry = generate_icosphere_indexed(subdivision_level, executor);
+        Icosphere_Expansion expansion;
+        expansion.vertices = geometry.vertices.data();
+        expansion.indices = geometry.indices.data();
+        expansion.expanded = vertices.data();
+        expansion.index_count = geometry.indices.size();
+        execute_tasks(executor, (expansion.index_count + icosphere_task_size - 1) / icosphere_task_size, expand_icosphere, &expansion);
         return vertices;
     }
 
-    Optional<f32> intersect_circle(math::Ray const& ray, math::Mat4 const& world_transform) {
-        math::Vec3 const world_origin{world_transform * math::Vec4{0.0f, 0.0f, 0.0f, 1.0f}};
-        math::Mat4 const inverse_transform{math::inverse(world_transform)};
-        math::Mat4 const transpose_inverse_transform{math::transpose(inverse_transform)};
-        math::Vec3 const world_normal{math::normalize(transpose_inverse_transform * math::Vec4{0.0f, 0.0f, -1.0f, 0.0f})};
-        f32 const plane_distance = math::dot(world_origin, world_normal);
-        Optional<Raycast_Hit> const hit = intersect_ray_plane(ray, world_normal, plane_distance);
+    Prepared_Handle prepare_circle(math::Mat4 const& world_transform) {
+        return prepare_handle(world_transform, math::Vec3{0.0f}, 1.0f);
+    }
+
+    Optional<f32> intersect_circle(math::Ray const& ray, Prepared_Handle const& handle) {
+        Optional<Raycast_Hit> const hit = intersect_ray_plane(ray, handle.z_axis, handle.plane_distance);
         if(!hit) {
             return null_optional;
         }
 
-        math::Vec4 const radius_vector{1.0f, 0.0f, 0.0f, 0.0f};
-        math::Vec3 const world_radius{world_transform * radius_vector};
-        f32 const radius_squared = math::length_squared(world_radius);
-        f32 const hit_distance_squared = math::length_squared(hit->hit_point - world_origin);
+        f32 const radius_squared = handle.scale * handle.scale;
+        f32 const hit_distance_squared = math::length_squared(hit->hit_point - handle.origin);
         if(hit_distance_squared <= radius_squared) {
             return hit->distance;
         } else {
@@ -249,40 +482,77 @@ namespace anton::gizmo {
         }
     }
 
-    Optional<f32> intersect_square(math::Ray const& ray, math::Mat4 const& world_transform) {
-        math::Vec3 const world_origin{world_transform * math::Vec4{0.0f, 0.0f, 0.0f, 1.0f}};
-        math::Mat4 const inverse_transform{math::inverse(world_transform)};
-        math::Mat4 const transpose_inverse_transform{math::transpose(inverse_transform)};
-        math::Vec3 const world_normal{math::normalize(transpose_inverse_transform * math::Vec4{0.0f, 0.0f, -1.0f, 0.0f})};
-        f32 const plane_distance = math::dot(world_origin, world_normal);
-        Optional<Raycast_Hit> const hit = intersect_ray_plane(ray, world_normal, plane_distance);
+    Ray_Packet_Hits intersect_circle(Ray_Packet const& packet, Prepared_Handle const& handle) {
+        simd::Float3 const origin = broadcast_vec3(handle.origin);
+        simd::Float3 const normal = broadcast_vec3(handle.z_axis);
+        simd::Float const radius_squared = simd::broadcast(handle.scale * handle.scale);
+        return intersect_ray_packet(packet, [&](simd::Float3 const& ray_origin, simd::Float3 const& ray_direction) {
+            return intersect_ray_disc(ray_origin - origin, ray_direction, normal, simd::dot(ray_direction, normal), radius_squared);
+        });
+    }
+
+    Optional<f32> intersect_circle(math::Ray const& ray, math::Mat4 const& world_transform) {
+        return intersect_circle(ray, prepare_circle(world_transform));
+    }
+
+    Prepared_Handle prepare_square(math::Mat4 const& world_transform) {
+        // Half of the diagonal of the square.
+        return prepare_handle(world_transform, math::Vec3{0.0f}, 0.70710678f);
+    }
+
+    Optional<f32> intersect_square(math::Ray const& ray, Prepared_Handle const& handle) {
+        Optional<Raycast_Hit> const hit = intersect_ray_plane(ray, handle.z_axis, handle.plane_distance);
         if(!hit) {
             return null_optional;
         }
 
-        math::Vec3 const p{hit->hit_point - world_origin};
-        math::Vec3 world_u{world_transform * math::Vec4{0.0f, 1.0f, 0.0f, 0.0f}};
-        f32 const length_u = math::length(world_u);
-        world_u /= length_u;
-        f32 const d_u = math::abs(math::dot(p, world_u));
-        math::Vec3 world_r{world_transform * math::Vec4{1.0f, 0.0f, 0.0f, 0.0f}};
-        f32 const length_r = math::length(world_r);
-        world_r /= length_r;
-        f32 const d_r = math::abs(math::dot(p, world_r));
-        if(d_u <= 0.5f * length_u && d_r <= 0.5f * length_r) {
+        math::Vec3 const p{hit->hit_point - handle.origin};
+        f32 const half_edge = 0.5f * handle.scale;
+        f32 const d_u = math::abs(math::dot(p, handle.y_axis));
+        f32 const d_r = math::abs(math::dot(p, handle.x_axis));
+        if(d_u <= half_edge && d_r <= half_edge) {
             return hit->distance;
         } else {
             return null_optional;
         }
     }
 
-    Optional<f32> intersect_cube(math::Ray const& ray, math::Mat4 const& world_transform) {
+    Ray_Packet_Hits intersect_square(Ray_Packet const& packet, Prepared_Handle const& handle) {
+        simd::Float3 const origin = broadcast_vec3(handle.origin);
+        simd::Float3 const normal = broadcast_vec3(handle.z_axis);
+        simd::Float3 const x_axis = broadcast_vec3(handle.x_axis);
+        simd::Float3 const y_axis = broadcast_vec3(handle.y_axis);
+        simd::Float const half_edge = simd::broadcast(0.5f * handle.scale);
+        simd::Float const epsilon = simd::broadcast(math::epsilon);
+        simd::Float const zero = simd::broadcast(0.0f);
+        simd::Float const infinity = simd::broadcast(math::infinity);
+        return intersect_ray_packet(packet, [&](simd::Float3 const& ray_origin, simd::Float3 const& ray_direction) {
+            simd::Float3 const offset = ray_origin - origin;
+            simd::Float const direction_dot_normal = simd::dot(ray_direction, normal);
+            simd::Float const distance = -simd::dot(offset, normal) / direction_dot_normal;
+            simd::Float3 const p = offset + ray_direction * distance;
+            simd::Mask const hit = (simd::abs(direction_dot_normal) > epsilon) & (distance >= zero) & (simd::abs(simd::dot(p, y_axis)) <= half_edge) &
+                                   (simd::abs(simd::dot(p, x_axis)) <= half_edge);
+            return simd::select(hit, distance, infinity);
+        });
+    }
+
+    Optional<f32> intersect_square(math::Ray const& ray, math::Mat4 const& world_transform) {
+        return intersect_square(ray, prepare_square(world_transform));
+    }
+
+    Prepared_Handle prepare_cube(math::Mat4 const& world_transform) {
+        // Half of the diagonal of the cube.
+        return prepare_handle(world_transform, math::Vec3{0.0f}, 0.8660254f);
+    }
+
+    Optional<f32> intersect_cube(math::Ray const& ray, Prepared_Handle const& handle) {
         math::OBB cube_bounding_vol;
-        cube_bounding_vol.local_x = math::normalize(math::Vec3(world_transform * math::Vec4(1.0f, 0.0f, 0.0f, 0.0f)));
-        cube_bounding_vol.local_y = math::normalize(math::Vec3(world_transform * math::Vec4(0.0f, 1.0f, 0.0f, 0.0f)));
-        cube_bounding_vol.local_z = math::normalize(math::Vec3(world_transform * math::Vec4(0.0f, 0.0f, -1.0f, 0.0f)));
-        cube_bounding_vol.halfwidths = math::Vec3{0.5f * math::length(math::Vec3{world_transform[0]})};
-        cube_bounding_vol.center = math::Vec3(world_transform * math::Vec4{0.0f, 0.0f, 0.0f, 1.0f});
+        cube_bounding_vol.local_x = handle.x_axis;
+        cube_bounding_vol.local_y = handle.y_axis;
+        cube_bounding_vol.local_z = handle.z_axis;
+        cube_bounding_vol.halfwidths = math::Vec3{0.5f * handle.scale};
+        cube_bounding_vol.center = handle.origin;
         Optional<Raycast_Hit> const hit = intersect_ray_obb(ray, cube_bounding_vol);
         if(hit) {
             return hit->distance;
@@ -291,14 +561,43 @@ namespace anton::gizmo {
         }
     }
 
-    Optional<f32> intersect_sphere(math::Ray const& ray, math::Mat4 const& world_transform) {
-        math::Vec3 const origin{world_transform * math::Vec4{0.0f, 0.0f, 0.0f, 1.0f}};
-        f32 const radius = math::length(math::Vec3{world_transform[0]});
-        Optional<Raycast_Hit> const hit = intersect_ray_sphere(ray, origin, radius);
+    Ray_Packet_Hits intersect_cube(Ray_Packet const& packet, Prepared_Handle const& handle) {
+        simd::Float3 const origin = broadcast_vec3(handle.origin);
+        simd::Float3 const x_axis = broadcast_vec3(handle.x_axis);
+        simd::Float3 const y_axis = broadcast_vec3(handle.y_axis);
+        simd::Float3 const z_axis = broadcast_vec3(handle.z_axis);
+        simd::Float3 const halfwidths = broadcast_vec3(math::Vec3{0.5f * handle.scale});
+        return intersect_ray_packet(packet, [&](simd::Float3 const& ray_origin, simd::Float3 const& ray_direction) {
+            return intersect_ray_obb(ray_origin - origin, ray_direction, x_axis, y_axis, z_axis, halfwidths);
+        });
+    }
+
+    Optional<f32> intersect_cube(math::Ray const& ray, math::Mat4 const& world_transform) {
+        return intersect_cube(ray, prepare_cube(world_transform));
+    }
+
+    Prepared_Handle prepare_sphere(math::Mat4 const& world_transform) {
+        return prepare_handle(world_transform, math::Vec3{0.0f}, 1.0f);
+    }
+
+    Optional<f32> intersect_sphere(math::Ray const& ray, Prepared_Handle const& handle) {
+        Optional<Raycast_Hit> const hit = intersect_ray_sphere(ray, handle.origin, handle.scale);
         if(hit) {
             return hit->distance;
         } else {
             return null_optional;
         }
     }
+
+    Ray_Packet_Hits intersect_sphere(Ray_Packet const& packet, Prepared_Handle const& handle) {
+        simd::Float3 const origin = broadcast_vec3(handle.origin);
+        simd::Float const radius = simd::broadcast(handle.scale);
+        return intersect_ray_packet(packet, [&](simd::Float3 const& ray_origin, simd::Float3 const& ray_direction) {
+            return solve_ray_quadric(setup_ray_sphere(ray_origin - origin, ray_direction, radius));
+        });
+    }
+
+    Optional<f32> intersect_sphere(math::Ray const& ray, math::Mat4 const& world_transform) {
+        return intersect_sphere(ray, prepare_sphere(world_transform));
+    }
 } // namespace anton::gizmo
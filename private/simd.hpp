@@ -0,0 +1,404 @@
+#pragma once
+
+#include <anton/math/math.hpp>
+#include <anton/types.hpp>
+
+// The widest instruction set enabled for the target is selected at compile time.
+// AVX2 requires compiling with ANTON_GIZMO_ENABLE_AVX2 (-mavx2 or /arch:AVX2).
+#if defined(__AVX2__)
+    #include <immintrin.h>
+    #define ANTON_GIZMO_SIMD_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define ANTON_GIZMO_SIMD_SSE2 1
+#endif
+
+namespace anton::gizmo::simd {
+    // Float
+    // lane_count 32-bit floats processed with a single instruction.
+    //
+    // Mask
+    // The result of a comparison of Floats with all bits of a lane set if the comparison is true.
+    //
+#if ANTON_GIZMO_SIMD_AVX2
+    constexpr i64 lane_count = 8;
+
+    struct Float {
+        __m256 v;
+    };
+
+    struct Mask {
+        __m256 v;
+    };
+
+    inline Float load(f32 const* const values) {
+        return {_mm256_loadu_ps(values)};
+    }
+
+    inline void store(f32* const destination, Float const a) {
+        _mm256_storeu_ps(destination, a.v);
+    }
+
+    inline Float broadcast(f32 const value) {
+        return {_mm256_set1_ps(value)};
+    }
+
+    // Returns first, first + 1, ..., first + lane_count - 1.
+    inline Float lane_indices(f32 const first) {
+        return {_mm256_add_ps(_mm256_set1_ps(first), _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f))};
+    }
+
+    inline Float operator+(Float const a, Float const b) {
+        return {_mm256_add_ps(a.v, b.v)};
+    }
+
+    inline Float operator-(Float const a, Float const b) {
+        return {_mm256_sub_ps(a.v, b.v)};
+    }
+
+    inline Float operator*(Float const a, Float const b) {
+        return {_mm256_mul_ps(a.v, b.v)};
+    }
+
+    inline Float operator/(Float const a, Float const b) {
+        return {_mm256_div_ps(a.v, b.v)};
+    }
+
+    inline Float sqrt(Float const a) {
+        return {_mm256_sqrt_ps(a.v)};
+    }
+
+    inline Float min(Float const a, Float const b) {
+        return {_mm256_min_ps(a.v, b.v)};
+    }
+
+    inline Float max(Float const a, Float const b) {
+        return {_mm256_max_ps(a.v, b.v)};
+    }
+
+    inline Float abs(Float const a) {
+        return {_mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v)};
+    }
+
+    inline Mask operator<(Float const a, Float const b) {
+        return {_mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ)};
+    }
+
+    inline Mask operator<=(Float const a, Float const b) {
+        return {_mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ)};
+    }
+
+    inline Mask operator>(Float const a, Float const b) {
+        return {_mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ)};
+    }
+
+    inline Mask operator>=(Float const a, Float const b) {
+        return {_mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ)};
+    }
+
+    inline Mask operator&(Mask const a, Mask const b) {
+        return {_mm256_and_ps(a.v, b.v)};
+    }
+
+    inline Mask operator|(Mask const a, Mask const b) {
+        return {_mm256_or_ps(a.v, b.v)};
+    }
+
+    // Selects the lanes of a where mask is set and the lanes of b otherwise.
+    inline Float select(Mask const mask, Float const a, Float const b) {
+        return {_mm256_blendv_ps(b.v, a.v, mask.v)};
+    }
+
+    inline bool any(Mask const mask) {
+        return _mm256_movemask_ps(mask.v) != 0;
+    }
+#elif ANTON_GIZMO_SIMD_SSE2
+    constexpr i64 lane_count = 4;
+
+    struct Float {
+        __m128 v;
+    };
+
+    struct Mask {
+        __m128 v;
+    };
+
+    inline Float load(f32 const* const values) {
+        return {_mm_loadu_ps(values)};
+    }
+
+    inline void store(f32* const destination, Float const a) {
+        _mm_storeu_ps(destination, a.v);
+    }
+
+    inline Float broadcast(f32 const value) {
+        return {_mm_set1_ps(value)};
+    }
+
+    // Returns first, first + 1, ..., first + lane_count - 1.
+    inline Float lane_indices(f32 const first) {
+        return {_mm_add_ps(_mm_set1_ps(first), _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f))};
+    }
+
+    inline Float operator+(Float const a, Float const b) {
+        return {_mm_add_ps(a.v, b.v)};
+    }
+
+    inline Float operator-(Float const a, Float const b) {
+        return {_mm_sub_ps(a.v, b.v)};
+    }
+
+    inline Float operator*(Float const a, Float const b) {
+        return {_mm_mul_ps(a.v, b.v)};
+    }
+
+    inline Float operator/(Float const a, Float const b) {
+        return {_mm_div_ps(a.v, b.v)};
+    }
+
+    inline Float sqrt(Float const a) {
+        return {_mm_sqrt_ps(a.v)};
+    }
+
+    inline Float min(Float const a, Float const b) {
+        return {_mm_min_ps(a.v, b.v)};
+    }
+
+    inline Float max(Float const a, Float const b) {
+        return {_mm_max_ps(a.v, b.v)};
+    }
+
+    inline Float abs(Float const a) {
+        return {_mm_andnot_ps(_mm_set1_ps(-0.0f), a.v)};
+    }
+
+    inline Mask operator<(Float const a, Float const b) {
+        return {_mm_cmplt_ps(a.v, b.v)};
+    }
+
+    inline Mask operator<=(Float const a, Float const b) {
+        return {_mm_cmple_ps(a.v, b.v)};
+    }
+
+    inline Mask operator>(Float const a, Float const b) {
+        return {_mm_cmpgt_ps(a.v, b.v)};
+    }
+
+    inline Mask operator>=(Float const a, Float const b) {
+        return {_mm_cmpge_ps(a.v, b.v)};
+    }
+
+    inline Mask operator&(Mask const a, Mask const b) {
+        return {_mm_and_ps(a.v, b.v)};
+    }
+
+    inline Mask operator|(Mask const a, Mask const b) {
+        return {_mm_or_ps(a.v, b.v)};
+    }
+
+    // Selects the lanes of a where mask is set and the lanes of b otherwise.
+    inline Float select(Mask const mask, Float const a, Float const b) {
+        return {_mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v))};
+    }
+
+    inline bool any(Mask const mask) {
+        return _mm_movemask_ps(mask.v) != 0;
+    }
+#else
+    // Scalar fallback for targets without a supported instruction set.
+    constexpr i64 lane_count = 1;
+
+    struct Float {
+        f32 v;
+    };
+
+    struct Mask {
+        bool v;
+    };
+
+    inline Float load(f32 const* const values) {
+        return {values[0]};
+    }
+
+    inline void store(f32* const destination, Float const a) {
+        destination[0] = a.v;
+    }
+
+    inline Float broadcast(f32 const value) {
+        return {value};
+    }
+
+    // Returns first, first + 1, ..., first + lane_count - 1.
+    inline Float lane_indices(f32 const first) {
+        return {first};
+    }
+
+    inline Float operator+(Float const a, Float const b) {
+        return {a.v + b.v};
+    }
+
+    inline Float operator-(Float const a, Float const b) {
+        return {a.v - b.v};
+    }
+
+    inline Float operator*(Float const a, Float const b) {
+        return {a.v * b.v};
+    }
+
+    inline Float operator/(Float const a, Float const b) {
+        return {a.v / b.v};
+    }
+
+    inline Float sqrt(Float const a) {
+        return {math::sqrt(a.v)};
+    }
+
+    // Like the instructions, returns b if either operand is NaN.
+    inline Float min(Float const a, Float const b) {
+        return {a.v < b.v ? a.v : b.v};
+    }
+
+    inline Float max(Float const a, Float const b) {
+        return {a.v > b.v ? a.v : b.v};
+    }
+
+    inline Float abs(Float const a) {
+        return {math::abs(a.v)};
+    }
+
+    inline Mask operator<(Float const a, Float const b) {
+        return {a.v < b.v};
+    }
+
+    inline Mask operator<=(Float const a, Float const b) {
+        return {a.v <= b.v};
+    }
+
+    inline Mask operator>(Float const a, Float const b) {
+        return {a.v > b.v};
+    }
+
+    inline Mask operator>=(Float const a, Float const b) {
+        return {a.v >= b.v};
+    }
+
+    inline Mask operator&(Mask const a, Mask const b) {
+        return {a.v && b.v};
+    }
+
+    inline Mask operator|(Mask const a, Mask const b) {
+        return {a.v || b.v};
+    }
+
+    // Selects the lanes of a where mask is set and the lanes of b otherwise.
+    inline Float select(Mask const mask, Float const a, Float const b) {
+        return {mask.v ? a.v : b.v};
+    }
+
+    inline bool any(Mask const mask) {
+        return mask.v;
+    }
+#endif
+
+    inline Float operator-(Float const a) {
+        return broadcast(0.0f) - a;
+    }
+
+    struct Float3 {
+        Float x;
+        Float y;
+        Float z;
+    };
+
+    inline Float3 operator+(Float3 const& a, Float3 const& b) {
+        return {a.x + b.x, a.y + b.y, a.z + b.z};
+    }
+
+    inline Float3 operator-(Float3 const& a, Float3 const& b) {
+        return {a.x - b.x, a.y - b.y, a.z - b.z};
+    }
+
+    inline Float3 operator*(Float3 const& a, Float const b) {
+        return {a.x * b, a.y * b, a.z * b};
+    }
+
+    inline Float3 operator-(Float3 const& a) {
+        return {-a.x, -a.y, -a.z};
+    }
+
+    inline Float dot(Float3 const& a, Float3 const& b) {
+        return a.x * b.x + a.y * b.y + a.z * b.z;
+    }
+
+    inline Float3 cross(Float3 const& a, Float3 const& b) {
+        return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+    }
+
+    // Overloads for f32, so that kernels templated on the float type may also be instantiated for a single value
+    // with math::Vec3 in place of Float3.
+
+    template<typename T>
+    struct Mask_Type;
+
+    template<>
+    struct Mask_Type<f32> {
+        using type = bool;
+    };
+
+    template<>
+    struct Mask_Type<Float> {
+        using type = Mask;
+    };
+
+    // Returns value in every lane of T.
+    template<typename T>
+    T splat(f32 value);
+
+    template<>
+    inline f32 splat<f32>(f32 const value) {
+        return value;
+    }
+
+    template<>
+    inline Float splat<Float>(f32 const value) {
+        return broadcast(value);
+    }
+
+    // Loads lanes of T from consecutive values.
+    template<typename T>
+    T load(f32 const* values);
+
+    template<>
+    inline f32 load<f32>(f32 const* const values) {
+        return *values;
+    }
+
+    template<>
+    inline Float load<Float>(f32 const* const values) {
+        return load(values);
+    }
+
+    inline void store(f32* const destination, f32 const a) {
+        *destination = a;
+    }
+
+    inline f32 sqrt(f32 const a) {
+        return math::sqrt(a);
+    }
+
+    inline f32 min(f32 const a, f32 const b) {
+        return a < b ? a : b;
+    }
+
+    inline f32 max(f32 const a, f32 const b) {
+        return a > b ? a : b;
+    }
+
+    inline f32 abs(f32 const a) {
+        return math::abs(a);
+    }
+
+    inline f32 select(bool const mask, f32 const a, f32 const b) {
+        return mask ? a : b;
+    }
+} // namespace anton::gizmo::simd
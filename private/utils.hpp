@@ -1,35 +1,185 @@
 #pragma once
 
 #include <anton/array.hpp>
+#include <anton/gizmo/task_executor.hpp>
 #include <anton/math/mat4.hpp>
 #include <anton/math/primitives.hpp>
 #include <anton/math/quat.hpp>
 #include <anton/math/vec3.hpp>
 #include <anton/types.hpp>
 
+#include <string.h>
+
 namespace anton::gizmo {
+    // Reinterprets the bits of value as an unsigned integer.
+    // memcpy compiles to a single move and, unlike reading an inactive member of a union, is well-defined.
+    [[maybe_unused]] [[nodiscard]] static u32 float_bits(f32 const value) {
+        u32 bits;
+        memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    struct Sin_Cos {
+        f32 sin;
+        f32 cos;
+    };
+
+    // Sin_Cos_Generator
+    // Generates sin(k * angle) and cos(k * angle) for consecutive k starting at first, where angle = 2pi / count.
+    //
+    // The values are evaluated for 4 consecutive k at a time by rotating the previous 4 by 4 * angle.
+    // The lanes are independent so that the compiler may vectorize the recurrence.
+    // To bound the accumulated rounding error the lanes are reseeded with exact values every 64 values.
+    //
+    class Sin_Cos_Generator {
+    public:
+        explicit Sin_Cos_Generator(i32 const count, i64 const first = 0): angle(math::two_pi / static_cast<f32>(count)), first(first) {
+            cos_step = math::cos(lane_count * angle);
+            sin_step = math::sin(lane_count * angle);
+            seed();
+        }
+
+        // next
+        // Advance to the next angle.
+        //
+        [[nodiscard]] Sin_Cos next() {
+            if(lane == lane_count) {
+                advance();
+            }
+
+            Sin_Cos const result{sin_lanes[lane], cos_lanes[lane]};
+            lane += 1;
+            return result;
+        }
+
+    private:
+        static constexpr i32 lane_count = 4;
+        static constexpr i64 reseed_interval = 16;
+
+        f32 angle;
+        f32 cos_step;
+        f32 sin_step;
+        f32 cos_lanes[lane_count];
+        f32 sin_lanes[lane_count];
+        i64 first;
+        i64 block = 0;
+        i32 lane = 0;
+
+        void seed() {
+            i64 const k = first + block * lane_count;
+            for(i32 l = 0; l < lane_count; ++l) {
+                f32 const lane_angle = static_cast<f32>(k + l) * angle;
+                cos_lanes[l] = math::cos(lane_angle);
+                sin_lanes[l] = math::sin(lane_angle);
+            }
+        }
+
+        void advance() {
+            block += 1;
+            lane = 0;
+            if(block % reseed_interval == 0) {
+                seed();
+                return;
+            }
+
+            for(i32 l = 0; l < lane_count; ++l) {
+                f32 const c = cos_lanes[l];
+                f32 const s = sin_lanes[l];
+                cos_lanes[l] = c * cos_step - s * sin_step;
+                sin_lanes[l] = s * cos_step + c * sin_step;
+            }
+        }
+    };
+
+    // Circle_Generator
+    // Generates the points of a circle of radius in the plane n = normal, d = dot(origin, normal) centered at origin
+    // one at a time without storing them. The vertices are generated in clockwise order.
+    //
+    // The k-th point is origin + cos(k * angle) * u + sin(k * angle) * v where u and v span the plane of the circle.
+    // The first point is rotated by angle from u.
+    //
+    class Circle_Generator {
+    public:
+        Circle_Generator(math::Vec3 const& origin, math::Vec3 const& normal, f32 const radius, i32 const vert_count)
+            : origin(origin), angles(vert_count, 1) {
+            // Find a point in the plane n = normal, d = 0 and rescale the circle
+            u = math::perpendicular(normal) * radius;
+            v = math::cross(normal, u);
+        }
+
+        // next
+        // Advance to the next point of the circle.
+        //
+        [[nodiscard]] math::Vec3 next() {
+            Sin_Cos const angle = angles.next();
+            return origin + angle.cos * u + angle.sin * v;
+        }
+
+    private:
+        math::Vec3 origin;
+        math::Vec3 u;
+        math::Vec3 v;
+        Sin_Cos_Generator angles;
+    };
+
     // generate_circle
     // Generate a circle of diameter in the plane n = normal, d = dot(origin, normal) centered at origin.
-    // The vertices are generated in clockwise order.
+    // The vertices are generated in clockwise order. The first vertex is repeated at the end.
     //
     [[maybe_unused]] [[nodiscard]] static anton::Array<math::Vec3> generate_circle(math::Vec3 const& origin, math::Vec3 const& normal, f32 const radius,
                                                                                    i32 const vert_count) {
-        f32 const angle = math::two_pi / static_cast<f32>(vert_count);
-        math::Quat const rotation_quat = math::Quat::from_axis_angle(normal, angle);
-        // Find a point in the plane n = normal, d = 0
-        math::Vec3 vertex = math::perpendicular(normal);
-        // Rescale the circle
-        vertex *= radius;
-        // Generate a circle in the plane n = normal, d = 0 and center it at origin
-        math::Quat rotated_vec{vertex.x, vertex.y, vertex.z, 0.0f};
-        anton::Array<math::Vec3> circle_points{anton::reserve, vert_count};
+        Circle_Generator generator{origin, normal, radius, vert_count};
+        anton::Array<math::Vec3> circle_points{anton::reserve, vert_count + 1};
         for(i64 i = 0; i <= vert_count; ++i) {
-            rotated_vec = rotation_quat * rotated_vec * conjugate(rotation_quat);
-            circle_points.emplace_back(rotated_vec.x + origin.x, rotated_vec.y + origin.y, rotated_vec.z + origin.z);
+            circle_points.emplace_back(generator.next());
         }
         return circle_points;
     }
 
+    // cube_corners
+    // Corners of a cube centered at (0, 0, 0) with edges of length 1.0 aligned with the x, y and z axes.
+    // Bit 0 of the index selects +x, bit 1 selects +y and bit 2 selects +z.
+    //
+    static math::Vec3 const cube_corners[8] = {{-0.5f, -0.5f, -0.5f}, {0.5f, -0.5f, -0.5f}, {-0.5f, 0.5f, -0.5f}, {0.5f, 0.5f, -0.5f},
+                                               {-0.5f, -0.5f, 0.5f},  {0.5f, -0.5f, 0.5f},  {-0.5f, 0.5f, 0.5f},  {0.5f, 0.5f, 0.5f}};
+
+    // cube_indices
+    // Indices into cube_corners of the triangles comprising the cube in CCW order when looking at the cube from outside.
+    // The faces are in the order top, bottom, right, left, front, back.
+    //
+    static u32 const cube_indices[36] = {6, 7, 2, 2, 7, 3, 4, 0, 5, 0, 1, 5, 7, 5, 1, 7, 1, 3, 6, 0, 4, 6, 2, 0, 2, 3, 0, 0, 3, 1, 6, 4, 7, 4, 5, 7};
+
+    // axis_rotations
+    // Columns of the rotations that orient -z, the direction of the handles in their local space, along the x, y and z axis.
+    //
+    static f32 const axis_rotations[3][3][3] = {
+        {{0.0f, 0.0f, 1.0f}, {0.0f, 1.0f, 0.0f}, {-1.0f, 0.0f, 0.0f}},
+        {{1.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 1.0f}, {0.0f, -1.0f, 0.0f}},
+        {{-1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, -1.0f}},
+    };
+
+    // Rotates vector by axis_rotations[axis].
+    [[maybe_unused]] [[nodiscard]] static math::Vec3 rotate_towards_axis(i32 const axis, math::Vec3 const& vector) {
+        f32 const(&r)[3][3] = axis_rotations[axis];
+        return math::Vec3{r[0][0], r[0][1], r[0][2]} * vector.x + math::Vec3{r[1][0], r[1][1], r[1][2]} * vector.y +
+               math::Vec3{r[2][0], r[2][1], r[2][2]} * vector.z;
+    }
+
+    // execute_tasks
+    // Invokes task(data, index) for every index in [0, task_count) using executor.
+    // If executor is nullptr, the tasks are invoked in order on the calling thread.
+    //
+    [[maybe_unused]] static void execute_tasks(Task_Executor* const executor, i64 const task_count, void (*const task)(void* data, i64 index),
+                                               void* const data) {
+        if(executor) {
+            executor->execute(task_count, task, data);
+        } else {
+            for(i64 i = 0; i < task_count; ++i) {
+                task(data, i);
+            }
+        }
+    }
+
     [[maybe_unused]] [[nodiscard]] static math::Vec3 calculate_world_origin(math::Mat4 const& world_transform) {
         math::Vec3 const origin{world_transform * math::Vec4{0.0f, 0.0f, 0.0f, 1.0f}};
         return origin;
@@ -0,0 +1,293 @@
+#pragma once
+
+#include <anton/gizmo/geometry.hpp>
+#include <anton/math/vec3.hpp>
+#include <anton/slice.hpp>
+#include <anton/types.hpp>
+#include <utils.hpp>
+
+namespace anton::gizmo {
+    // The generators are templates over an output that receives the vertices of the generated triangle list
+    // one at a time via write(position). Position_Output stores the positions only. Vertex_Output assembles
+    // the triangles and writes the interleaved attributes described by a Vertex_Layout.
+
+    class Position_Output {
+    public:
+        explicit Position_Output(Slice<math::Vec3> const vertices): vertices(vertices) {}
+
+        void write(math::Vec3 const& position) {
+            vertices[index] = position;
+            index += 1;
+        }
+
+    private:
+        Slice<math::Vec3> vertices;
+        i64 index = 0;
+    };
+
+    // The sizes of the attributes in bytes.
+    [[maybe_unused]] [[nodiscard]] static i64 get_size(Position_Format const format) {
+        switch(format) {
+            case Position_Format::f32x3:
+                return 12;
+
+            case Position_Format::f16x4:
+            case Position_Format::snorm16x4:
+                return 8;
+
+            case Position_Format::snorm10x3_2:
+                return 4;
+        }
+    }
+
+    [[maybe_unused]] [[nodiscard]] static i64 get_size(Normal_Format const format) {
+        switch(format) {
+            case Normal_Format::none:
+                return 0;
+
+            case Normal_Format::f32x3:
+                return 12;
+
+            case Normal_Format::f16x4:
+            case Normal_Format::snorm16x4:
+                return 8;
+        }
+    }
+
+    [[maybe_unused]] [[nodiscard]] static i64 get_size(Handle_ID_Format const format) {
+        switch(format) {
+            case Handle_ID_Format::none:
+                return 0;
+
+            case Handle_ID_Format::u8:
+                return 1;
+
+            case Handle_ID_Format::u16:
+                return 2;
+
+            case Handle_ID_Format::u32:
+                return 4;
+        }
+    }
+
+    // Copies the bytes of value to destination which does not have to be aligned.
+    template<typename T>
+    static void store_unaligned(u8* const destination, T const value) {
+        u8 const* const source = reinterpret_cast<u8 const*>(&value);
+        for(i64 i = 0; i < static_cast<i64>(sizeof(T)); ++i) {
+            destination[i] = source[i];
+        }
+    }
+
+    // Converts to the nearest half precision float rounding ties to even.
+    [[maybe_unused]] [[nodiscard]] static u16 f32_to_f16(f32 const value) {
+        u32 const bits = float_bits(value);
+        u32 const sign = (bits >> 16) & 0x8000;
+        u32 const exponent = (bits >> 23) & 0xFF;
+        u32 mantissa = bits & 0x7FFFFF;
+        if(exponent == 0xFF) {
+            // Infinity or NaN
+            return sign | 0x7C00 | (mantissa != 0 ? 0x200 : 0);
+        }
+
+        i32 const half_exponent = static_cast<i32>(exponent) - 127 + 15;
+        if(half_exponent >= 31) {
+            return sign | 0x7C00;
+        }
+
+        u32 half;
+        u32 remainder;
+        u32 halfway;
+        if(half_exponent <= 0) {
+            // Subnormal half or zero
+            if(half_exponent < -10) {
+                return sign;
+            }
+
+            mantissa |= 0x800000;
+            u32 const shift = 14 - half_exponent;
+            half = mantissa >> shift;
+            remainder = mantissa & ((1u << shift) - 1);
+            halfway = 1u << (shift - 1);
+        } else {
+            half = (static_cast<u32>(half_exponent) << 10) | (mantissa >> 13);
+            remainder = mantissa & 0x1FFF;
+            halfway = 0x1000;
+        }
+
+        // A carry out of the mantissa correctly increments the exponent.
+        if(remainder > halfway || (remainder == halfway && (half & 1))) {
+            half += 1;
+        }
+        return sign | half;
+    }
+
+    // Converts value in [-1, 1] to a signed normalized integer with the largest value max rounding to the nearest.
+    [[maybe_unused]] [[nodiscard]] static i32 f32_to_snorm(f32 const value, i32 const max) {
+        f32 const clamped = math::clamp(value, -1.0f, 1.0f);
+        f32 const scaled = clamped * static_cast<f32>(max);
+        return static_cast<i32>(scaled >= 0.0f ? scaled + 0.5f : scaled - 0.5f);
+    }
+
+    [[maybe_unused]] [[nodiscard]] static i16 f32_to_snorm16(f32 const value) {
+        return static_cast<i16>(f32_to_snorm(value, 32767));
+    }
+
+    // calculate_position_dequantization
+    // Calculates the dequantization that maps [-1, 1] onto the bounding box [min, max] of a shape for the quantized formats.
+    //
+    [[maybe_unused]] [[nodiscard]] static Position_Dequantization calculate_position_dequantization(Position_Format const format, math::Vec3 const& min,
+                                                                                                     math::Vec3 const& max) {
+        switch(format) {
+            case Position_Format::f32x3:
+            case Position_Format::f16x4:
+                return {math::Vec3{1.0f}, math::Vec3{0.0f}};
+
+            case Position_Format::snorm16x4:
+            case Position_Format::snorm10x3_2:
+                return {0.5f * (max - min), 0.5f * (max + min)};
+        }
+    }
+
+    // Maps position into [-1, 1] inverting dequantization. Components of zero extent map to 0.
+    [[maybe_unused]] [[nodiscard]] static math::Vec3 quantize_position(Position_Dequantization const& dequantization, math::Vec3 const& position) {
+        math::Vec3 const offset = position - dequantization.bias;
+        math::Vec3 const& scale = dequantization.scale;
+        return {scale.x != 0.0f ? offset.x / scale.x : 0.0f, scale.y != 0.0f ? offset.y / scale.y : 0.0f, scale.z != 0.0f ? offset.z / scale.z : 0.0f};
+    }
+
+    [[maybe_unused]] static void write_position(Vertex_Layout const& layout, Position_Dequantization const& dequantization, u8* const vertex,
+                                                math::Vec3 const& position) {
+        u8* const destination = vertex + layout.position_offset;
+        switch(layout.position_format) {
+            case Position_Format::f32x3:
+                store_unaligned(destination, position.x);
+                store_unaligned(destination + 4, position.y);
+                store_unaligned(destination + 8, position.z);
+                break;
+
+            case Position_Format::f16x4:
+                store_unaligned(destination, f32_to_f16(position.x));
+                store_unaligned(destination + 2, f32_to_f16(position.y));
+                store_unaligned(destination + 4, f32_to_f16(position.z));
+                store_unaligned(destination + 6, f32_to_f16(1.0f));
+                break;
+
+            case Position_Format::snorm16x4: {
+                math::Vec3 const q = quantize_position(dequantization, position);
+                store_unaligned(destination, f32_to_snorm16(q.x));
+                store_unaligned(destination + 2, f32_to_snorm16(q.y));
+                store_unaligned(destination + 4, f32_to_snorm16(q.z));
+                store_unaligned(destination + 6, static_cast<i16>(32767));
+            } break;
+
+            case Position_Format::snorm10x3_2: {
+                math::Vec3 const q = quantize_position(dequantization, position);
+                u32 const x = static_cast<u32>(f32_to_snorm(q.x, 511)) & 0x3FF;
+                u32 const y = static_cast<u32>(f32_to_snorm(q.y, 511)) & 0x3FF;
+                u32 const z = static_cast<u32>(f32_to_snorm(q.z, 511)) & 0x3FF;
+                u32 const w = 1;
+                store_unaligned(destination, x | (y << 10) | (z << 20) | (w << 30));
+            } break;
+        }
+    }
+
+    [[maybe_unused]] static void write_normal(Vertex_Layout const& layout, u8* const vertex, math::Vec3 const& normal) {
+        u8* const destination = vertex + layout.normal_offset;
+        switch(layout.normal_format) {
+            case Normal_Format::none:
+                break;
+
+            case Normal_Format::f32x3:
+                store_unaligned(destination, normal.x);
+                store_unaligned(destination + 4, normal.y);
+                store_unaligned(destination + 8, normal.z);
+                break;
+
+            case Normal_Format::f16x4:
+                store_unaligned(destination, f32_to_f16(normal.x));
+                store_unaligned(destination + 2, f32_to_f16(normal.y));
+                store_unaligned(destination + 4, f32_to_f16(normal.z));
+                store_unaligned(destination + 6, static_cast<u16>(0));
+                break;
+
+            case Normal_Format::snorm16x4:
+                store_unaligned(destination, f32_to_snorm16(normal.x));
+                store_unaligned(destination + 2, f32_to_snorm16(normal.y));
+                store_unaligned(destination + 4, f32_to_snorm16(normal.z));
+                store_unaligned(destination + 6, static_cast<i16>(0));
+                break;
+        }
+    }
+
+    [[maybe_unused]] static void write_handle_id(Vertex_Layout const& layout, u8* const vertex, u32 const handle_id) {
+        u8* const destination = vertex + layout.handle_id_offset;
+        switch(layout.handle_id_format) {
+            case Handle_ID_Format::none:
+                break;
+
+            case Handle_ID_Format::u8:
+                store_unaligned(destination, static_cast<u8>(handle_id));
+                break;
+
+            case Handle_ID_Format::u16:
+                store_unaligned(destination, static_cast<u16>(handle_id));
+                break;
+
+            case Handle_ID_Format::u32:
+                store_unaligned(destination, handle_id);
+                break;
+        }
+    }
+
+    class Vertex_Output {
+    public:
+        // Parameters:
+        // min, max - the bounding box of the shape used to quantize the positions.
+        //
+        Vertex_Output(Vertex_Layout const& layout, u32 const handle_id, math::Vec3 const& min, math::Vec3 const& max, Slice<u8> const buffer)
+            : layout(layout), dequantization(calculate_position_dequantization(layout.position_format, min, max)), buffer(buffer), handle_id(handle_id) {}
+
+        [[nodiscard]] Position_Dequantization get_dequantization() const {
+            return dequantization;
+        }
+
+        void write(math::Vec3 const& position) {
+            triangle[corner] = position;
+            corner += 1;
+            if(corner == 3) {
+                write_triangle();
+                corner = 0;
+            }
+        }
+
+    private:
+        Vertex_Layout layout;
+        Position_Dequantization dequantization;
+        Slice<u8> buffer;
+        u32 handle_id;
+        math::Vec3 triangle[3];
+        i32 corner = 0;
+        i64 offset = 0;
+
+        void write_triangle() {
+            math::Vec3 normal{0.0f};
+            if(layout.normal_format != Normal_Format::none) {
+                // Degenerate triangles get a zero normal.
+                math::Vec3 const cross = math::cross(triangle[1] - triangle[0], triangle[2] - triangle[0]);
+                f32 const length_squared = math::length_squared(cross);
+                if(length_squared > 0.0f) {
+                    normal = cross * math::inv_sqrt(length_squared);
+                }
+            }
+
+            for(math::Vec3 const& position: triangle) {
+                u8* const vertex = buffer.data() + offset;
+                write_position(layout, dequantization, vertex, position);
+                write_normal(layout, vertex, normal);
+                write_handle_id(layout, vertex, handle_id);
+                offset += layout.stride;
+            }
+        }
+    };
+} // namespace anton::gizmo
@@ -1,9 +1,13 @@
 #pragma once
 
 #include <anton/array.hpp>
+#include <anton/gizmo/geometry.hpp>
+#include <anton/gizmo/prepared_handle.hpp>
+#include <anton/gizmo/ray_packet.hpp>
 #include <anton/math/mat4.hpp>
 #include <anton/math/primitives.hpp>
 #include <anton/optional.hpp>
+#include <anton/slice.hpp>
 #include <anton/types.hpp>
 
 namespace anton::gizmo {
@@ -40,6 +44,53 @@ namespace anton::gizmo {
     //
     [[nodiscard]] anton::Array<math::Vec3> generate_arrow_3d_geometry(Arrow_3D const& arrow, i32 vertex_count);
 
+    // arrow_3d_vertex_count
+    // Calculates the number of vertices generated by generate_arrow_3d_geometry.
+    //
+    // Parameters:
+    //        arrow - parameter struct that defines the shape and size of the geometry.
+    // vertex_count - the number of vertices that comprise the base of the cone (in case cone is the draw_style).
+    //
+    // Returns:
+    // The number of vertices of the triangles comprising the handle.
+    //
+    [[nodiscard]] i64 arrow_3d_vertex_count(Arrow_3D const& arrow, i32 vertex_count);
+
+    // generate_arrow_3d_geometry
+    // Generates the geometry of a handle into a caller-provided buffer without allocating memory.
+    //
+    // Parameters:
+    //        arrow - parameter struct that defines the shape and size of the geometry.
+    // vertex_count - the number of vertices that comprise the base of the cone (in case cone is the draw_style).
+    //     vertices - the buffer to write the vertices of the triangles comprising the handle in CCW order to.
+    //                Must have at least arrow_3d_vertex_count(arrow, vertex_count) elements.
+    //
+    void generate_arrow_3d_geometry(Arrow_3D const& arrow, i32 vertex_count, Slice<math::Vec3> vertices);
+
+    // generate_arrow_3d_geometry
+    // Generates the geometry of a handle into a caller-provided interleaved vertex buffer in a single pass.
+    //
+    // Parameters:
+    //        arrow - parameter struct that defines the shape and size of the geometry.
+    // vertex_count - the number of vertices that comprise the base of the cone (in case cone is the draw_style).
+    //       layout - the layout of the vertices in buffer.
+    //    handle_id - the value of the handle id attribute of every vertex.
+    //       buffer - the buffer to write the vertices of the triangles comprising the handle in CCW order to.
+    //                Must have at least arrow_3d_vertex_count(arrow, vertex_count) * layout.stride bytes.
+    //
+    // Returns:
+    // The dequantization of the positions written to buffer.
+    //
+    Position_Dequantization generate_arrow_3d_geometry(Arrow_3D const& arrow, i32 vertex_count, Vertex_Layout const& layout, u32 handle_id, Slice<u8> buffer);
+
+    // generate_arrow_3d_geometry_indexed
+    // Generates the same geometry as generate_arrow_3d_geometry, but with each distinct vertex stored only once.
+    //
+    // Returns:
+    // Vertices of the handle and a list of indices of the triangles comprising the handle in CCW order.
+    //
+    [[nodiscard]] Indexed_Geometry generate_arrow_3d_geometry_indexed(Arrow_3D const& arrow, i32 vertex_count);
+
     [[nodiscard]] math::Mat4 calculate_transform(math::Mat4 const& world_transform, math::Vec3 axis);
 
     // intersect_arrow_3d
@@ -56,4 +107,86 @@ namespace anton::gizmo {
     // Distance along ray's direction to the intersection point or null_optional if no intersection occured.
     //
     [[nodiscard]] Optional<f32> intersect_arrow_3d(math::Ray ray, Arrow_3D const& arrow, math::Mat4 const& gizmo_transform);
+
+    // prepare_arrow_3d
+    // Prepares an arrow for intersect_arrow_3d. The bounding sphere of the handle encloses the bounding volumes of the arrow.
+    //
+    // Parameters:
+    //           arrow - parameter struct that defines the shape and size of the bounding volumes.
+    // gizmo_transform - a transform to the world space generated by calculate_gizmo_transform.
+    //
+    [[nodiscard]] Prepared_Handle prepare_arrow_3d(Arrow_3D const& arrow, math::Mat4 const& gizmo_transform);
+
+    // intersect_arrow_3d
+    // Perform an intersection test of a ray against the bounding volumes of an arrow prepared with prepare_arrow_3d.
+    //
+    // Parameters:
+    //    ray - a world space ray to test against.
+    //  arrow - parameter struct that defines the shape and size of the bounding volumes.
+    //          Should be identical to that passed to prepare_arrow_3d.
+    // handle - the prepared arrow.
+    //
+    [[nodiscard]] Optional<f32> intersect_arrow_3d(math::Ray ray, Arrow_3D const& arrow, Prepared_Handle const& handle);
+
+    // intersect_arrow_3d
+    // Performs the intersection test of intersect_arrow_3d of every ray of a packet against an arrow prepared with prepare_arrow_3d.
+    // Rays are tested 8 at a time with AVX2 (if enabled with ANTON_GIZMO_ENABLE_AVX2), 4 at a time with SSE2
+    // or one at a time on other targets.
+    //
+    // Parameters:
+    // packet - world space rays to test against.
+    //  arrow - parameter struct that defines the shape and size of the bounding volumes.
+    //          Should be identical to that passed to prepare_arrow_3d.
+    // handle - the prepared arrow.
+    //
+    // Returns:
+    // The distances along the rays to the intersection points and the nearest hit of the packet.
+    //
+    [[nodiscard]] Ray_Packet_Hits intersect_arrow_3d(Ray_Packet const& packet, Arrow_3D const& arrow, Prepared_Handle const& handle);
+
+    // Arrow_3D_Batch
+    // The transforms of many arrows prepared by prepare_arrow_3d_batch for intersect_arrow_3d_batch.
+    // Every component is stored in a separate stream so that several arrows can be processed at once.
+    //
+    struct Arrow_3D_Batch {
+        // The number of arrows.
+        i64 count = 0;
+        // The number of elements of every stream. count rounded up to a multiple of 8.
+        i64 stride = 0;
+        // The streams of the origin, the direction, the x axis, the y axis (all x, y, z) and the scale of the arrows
+        // stored one after another.
+        Array<f32> components;
+    };
+
+    struct Arrow_3D_Batch_Hit {
+        // Index of the arrow in the transforms passed to prepare_arrow_3d_batch.
+        i64 index;
+        f32 distance;
+    };
+
+    // prepare_arrow_3d_batch
+    // Extracts the components of the transforms used by intersect_arrow_3d_batch reusing the memory of batch.
+    //
+    // Parameters:
+    // gizmo_transforms - transforms to the world space. Must consist of translation, rotation and uniform scale only.
+    //                    At most 2^24 transforms.
+    //            batch - the batch to write the components to.
+    //
+    void prepare_arrow_3d_batch(Slice<math::Mat4 const> gizmo_transforms, Arrow_3D_Batch& batch);
+
+    // intersect_arrow_3d_batch
+    // Performs the intersection test of intersect_arrow_3d of a ray against every arrow of batch and finds the nearest hit.
+    // Arrows are tested 8 at a time with AVX2 (if enabled with ANTON_GIZMO_ENABLE_AVX2), 4 at a time with SSE2
+    // or one at a time on other targets.
+    //
+    // Parameters:
+    //   ray - a world space ray to test against. The direction must be normalized.
+    // arrow - parameter struct that defines the shape and size of the bounding volumes shared by all arrows.
+    // batch - the transforms of the arrows.
+    //
+    // Returns:
+    // The index of the nearest arrow hit by the ray and the distance along ray's direction to the intersection point
+    // or null_optional if no arrow has been hit.
+    //
+    [[nodiscard]] Optional<Arrow_3D_Batch_Hit> intersect_arrow_3d_batch(math::Ray ray, Arrow_3D const& arrow, Arrow_3D_Batch const& batch);
 } // namespace anton::gizmo
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <anton/array.hpp>
+#include <anton/gizmo/geometry.hpp>
+#include <anton/gizmo/geometry_key.hpp>
+#include <anton/math/vec3.hpp>
+#include <anton/optional.hpp>
+#include <anton/slice.hpp>
+#include <anton/types.hpp>
+
+namespace anton::gizmo {
+    // Baked geometry files store generated geometry keyed by the parameters of the generator, so that it does not
+    // have to be regenerated at startup. A file contains any number of entries, each holding one of:
+    //  - a triangle list as produced by the generate_* functions writing math::Vec3,
+    //  - indexed geometry as produced by the generate_*_indexed functions,
+    //  - an interleaved vertex buffer as produced by the generate_* functions writing a Vertex_Layout.
+    //
+    // The file starts with a header followed by the table of entries and the data of the entries. All values are
+    // stored in the native byte order and the data of every entry is aligned to 16 bytes, so the data may be used
+    // directly from memory the file has been mapped to.
+    //
+    // The header records the version of the format and the version of the generators. A file written by a different
+    // version of the library fails to load and all geometry is generated at runtime instead.
+
+    struct Indexed_Geometry_View {
+        Slice<math::Vec3 const> vertices;
+        Slice<u32 const> indices;
+    };
+
+    struct Interleaved_Geometry_View {
+        Slice<u8 const> vertices;
+        Vertex_Layout layout;
+        Position_Dequantization dequantization;
+        i64 vertex_count;
+    };
+
+    // Baked_Geometry_Writer
+    // Collects geometry and serializes it into the baked geometry format.
+    // Adding an entry with a key that has already been added for the same kind of geometry replaces it.
+    //
+    class Baked_Geometry_Writer {
+    public:
+        void add_triangle_list(Geometry_Key const& key, Slice<math::Vec3 const> vertices);
+        void add_indexed(Geometry_Key const& key, Indexed_Geometry const& geometry);
+
+        // add_interleaved
+        //
+        // Parameters:
+        //            key - the parameters of the generator.
+        //         layout - the layout of the vertices. Entries with a stride that is not positive are ignored.
+        //      handle_id - the handle id the vertices were generated with.
+        // dequantization - the dequantization returned by the generator.
+        //       vertices - the vertex buffer. Must have a multiple of layout.stride bytes.
+        //
+        void add_interleaved(Geometry_Key const& key, Vertex_Layout const& layout, u32 handle_id, Position_Dequantization const& dequantization,
+                             Slice<u8 const> vertices);
+
+        // serialize
+        //
+        // Returns:
+        // The contents of a baked geometry file containing all added entries.
+        //
+        [[nodiscard]] Array<u8> serialize() const;
+
+        // write
+        // Serializes the entries and writes them to the file at path replacing its contents.
+        //
+        // Returns:
+        // true if the file has been written successfully.
+        //
+        [[nodiscard]] bool write(char const* path) const;
+
+    private:
+        struct Entry {
+            Geometry_Key key;
+            u32 kind;
+            Vertex_Layout layout;
+            u32 handle_id;
+            Position_Dequantization dequantization;
+            i64 vertex_count;
+            i64 index_count;
+            // The vertices followed by the indices.
+            Array<u8> data;
+        };
+
+        Array<Entry> entries;
+
+        void add(Entry&& entry);
+    };
+
+    // Baked_Geometry_File
+    // Read-only view of a baked geometry file. The views returned by the find functions point directly into
+    // the mapped file and remain valid until the file is closed or destroyed.
+    //
+    class Baked_Geometry_File {
+    public:
+        Baked_Geometry_File() = default;
+        Baked_Geometry_File(Baked_Geometry_File const&) = delete;
+        Baked_Geometry_File& operator=(Baked_Geometry_File const&) = delete;
+        ~Baked_Geometry_File();
+
+        // open
+        // Memory maps the file at path and validates its contents. Closes the previously opened file.
+        //
+        // Returns:
+        // true if the file has been mapped and is a valid baked geometry file written by this version of the library.
+        //
+        [[nodiscard]] bool open(char const* path);
+
+        // load
+        // Validates data and uses it as the contents of the file without copying. Closes the previously opened file.
+        // data must remain valid and unchanged until the file is closed. Must be aligned to 16 bytes.
+        //
+        // Returns:
+        // true if data is a valid baked geometry file written by this version of the library.
+        //
+        [[nodiscard]] bool load(Slice<u8 const> data);
+
+        void close();
+
+        [[nodiscard]] bool is_open() const;
+
+        [[nodiscard]] Optional<Slice<math::Vec3 const>> find_triangle_list(Geometry_Key const& key) const;
+        [[nodiscard]] Optional<Indexed_Geometry_View> find_indexed(Geometry_Key const& key) const;
+        [[nodiscard]] Optional<Interleaved_Geometry_View> find_interleaved(Geometry_Key const& key, Vertex_Layout const& layout, u32 handle_id) const;
+
+    private:
+        u8 const* data = nullptr;
+        i64 size = 0;
+        // The mapping created by open. Empty if the data has been provided to load.
+        void* mapping = nullptr;
+        i64 mapping_size = 0;
+    };
+} // namespace anton::gizmo
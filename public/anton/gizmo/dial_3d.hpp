@@ -1,17 +1,32 @@
 #pragma once
 
 #include <anton/array.hpp>
+#include <anton/gizmo/geometry.hpp>
+#include <anton/gizmo/prepared_handle.hpp>
+#include <anton/gizmo/ray_packet.hpp>
 #include <anton/math/mat4.hpp>
 #include <anton/math/primitives.hpp>
 #include <anton/optional.hpp>
+#include <anton/slice.hpp>
 #include <anton/types.hpp>
 
 namespace anton::gizmo {
+    // The bounding volumes tested by intersect_dial_3d.
+    enum class Dial_3D_Bounds {
+        // The torus of the dial itself. Exact, but a smaller target than the cylinders.
+        torus,
+        // The ring between two cylinders of radii major_radius - minor_radius and major_radius + minor_radius and height
+        // 2 * minor_radius. A larger target than the torus, which also accepts hits outside of the tube near its corners.
+        cylinders,
+    };
+
     struct Dial_3D {
         // Radius of the dial.
         f32 major_radius;
         // Thickness of the dial.
         f32 minor_radius;
+        // The bounding volumes tested by intersect_dial_3d. Ignored by geometry generation.
+        Dial_3D_Bounds bounds = Dial_3D_Bounds::cylinders;
     };
 
     // generate_dial_3d_geometry
@@ -21,19 +36,75 @@ namespace anton::gizmo {
     // dial               - Parameter struct that defines the size of the geometry.
     // vertex_count_major - the number of vertices that comprise the large circle of the dial.
     // vertex_count_minor - the number of vertices that comprise the small circle of the dial.
+    // topology           - the topology of the generated vertices.
     //
     // Returns:
     // Vertices of the triangles comprising the dial in CCW order.
     //
-    [[nodiscard]] Array<math::Vec3> generate_dial_3d_geometry(Dial_3D const& dial, i32 vertex_count_major, i32 vertex_count_minor);
+    [[nodiscard]] Array<math::Vec3> generate_dial_3d_geometry(Dial_3D const& dial, i32 vertex_count_major, i32 vertex_count_minor,
+                                                              Primitive_Topology topology = Primitive_Topology::triangle_list);
+
+    // dial_3d_vertex_count
+    // Calculates the number of vertices generated by generate_dial_3d_geometry.
+    //
+    // Parameters:
+    // vertex_count_major - the number of vertices that comprise the large circle of the dial.
+    // vertex_count_minor - the number of vertices that comprise the small circle of the dial.
+    // topology           - the topology of the generated vertices.
+    //
+    // Returns:
+    // The number of vertices of the triangles comprising the dial.
+    //
+    [[nodiscard]] i64 dial_3d_vertex_count(i32 vertex_count_major, i32 vertex_count_minor, Primitive_Topology topology = Primitive_Topology::triangle_list);
+
+    // generate_dial_3d_geometry
+    // Generates the geometry of a dial into a caller-provided buffer without allocating memory.
+    // The torus is generated in a single pass from the sines and cosines of the angles of the major and the minor circle.
+    //
+    // Parameters:
+    // dial               - Parameter struct that defines the size of the geometry.
+    // vertex_count_major - the number of vertices that comprise the large circle of the dial.
+    // vertex_count_minor - the number of vertices that comprise the small circle of the dial.
+    // vertices           - the buffer to write the vertices of the triangles comprising the dial in CCW order to.
+    //                      Must have at least dial_3d_vertex_count(vertex_count_major, vertex_count_minor, topology) elements.
+    // topology           - the topology of the generated vertices.
+    //
+    void generate_dial_3d_geometry(Dial_3D const& dial, i32 vertex_count_major, i32 vertex_count_minor, Slice<math::Vec3> vertices,
+                                   Primitive_Topology topology = Primitive_Topology::triangle_list);
+
+    // generate_dial_3d_geometry
+    // Generates the geometry of a dial as a triangle list into a caller-provided interleaved vertex buffer in a single pass.
+    //
+    // Parameters:
+    // dial               - Parameter struct that defines the size of the geometry.
+    // vertex_count_major - the number of vertices that comprise the large circle of the dial.
+    // vertex_count_minor - the number of vertices that comprise the small circle of the dial.
+    // layout             - the layout of the vertices in buffer.
+    // handle_id          - the value of the handle id attribute of every vertex.
+    // buffer             - the buffer to write the vertices of the triangles comprising the dial in CCW order to.
+    //                      Must have at least dial_3d_vertex_count(vertex_count_major, vertex_count_minor) * layout.stride bytes.
+    //
+    // Returns:
+    // The dequantization of the positions written to buffer.
+    //
+    Position_Dequantization generate_dial_3d_geometry(Dial_3D const& dial, i32 vertex_count_major, i32 vertex_count_minor, Vertex_Layout const& layout,
+                                                      u32 handle_id, Slice<u8> buffer);
+
+    // generate_dial_3d_geometry_indexed
+    // Generates the same geometry as generate_dial_3d_geometry, but with each distinct vertex stored only once.
+    //
+    // Returns:
+    // Vertices of the dial and a list of indices of the triangles comprising the dial in CCW order.
+    //
+    [[nodiscard]] Indexed_Geometry generate_dial_3d_geometry_indexed(Dial_3D const& dial, i32 vertex_count_major, i32 vertex_count_minor);
 
     // intersect_dial_3d
-    // Perform an intersection test of a ray against the bounding volumes of the dial.
+    // Perform an intersection test of a ray against the bounding volumes of the dial selected by dial.bounds.
     // The dial is located at (0, 0, 0) and is aligned with the -z axis before being transformed into world space.
     //
     // Parameters:
-    // ray             - a world space ray to test against.
-    // dial            - parameter struct that defines the size of the bounding volumes.
+    // ray             - a world space ray to test against. The direction does not have to be normalized.
+    // dial            - parameter struct that defines the size and the kind of the bounding volumes.
     //                   Should be identical to that passed to generate_dial_3d_geometry.
     // world_transform - a transform to the world space. The transform must consist of
     //                   translation, rotation and uniform scale only.
@@ -42,4 +113,45 @@ namespace anton::gizmo {
     // Distance along ray's direction to the intersection point or null_optional if no intersection occured.
     //
     [[nodiscard]] Optional<f32> intersect_dial_3d(math::Ray ray, Dial_3D const& dial, math::Mat4 const& world_transform);
+
+    // prepare_dial_3d
+    // Prepares a dial for intersect_dial_3d. The bounding sphere of the handle encloses the bounding volumes of the dial.
+    //
+    // Parameters:
+    // dial            - parameter struct that defines the size of the bounding volumes.
+    // world_transform - a transform to the world space. The transform must consist of
+    //                   translation, rotation and uniform scale only.
+    //
+    [[nodiscard]] Prepared_Handle prepare_dial_3d(Dial_3D const& dial, math::Mat4 const& world_transform);
+
+    // intersect_dial_3d
+    // Perform an intersection test of a ray against the bounding volumes of a dial prepared with prepare_dial_3d
+    // selected by dial.bounds.
+    //
+    // Parameters:
+    // ray    - a world space ray to test against. The direction does not have to be normalized.
+    // dial   - parameter struct that defines the size and the kind of the bounding volumes.
+    //          Should be identical to that passed to prepare_dial_3d.
+    // handle - the prepared dial.
+    //
+    // Returns:
+    // Distance along ray's direction to the intersection point in units of the length of the direction
+    // or null_optional if no intersection occured.
+    //
+    [[nodiscard]] Optional<f32> intersect_dial_3d(math::Ray ray, Dial_3D const& dial, Prepared_Handle const& handle);
+
+    // intersect_dial_3d
+    // Performs the intersection test of intersect_dial_3d of every ray of a packet against a dial prepared with prepare_dial_3d.
+    // The cylinders are tested several rays at a time, the torus one ray at a time.
+    //
+    // Parameters:
+    // packet - world space rays to test against.
+    //   dial - parameter struct that defines the size of the bounding volumes.
+    //          Should be identical to that passed to prepare_dial_3d.
+    // handle - the prepared dial.
+    //
+    // Returns:
+    // The distances along the rays to the intersection points and the nearest hit of the packet.
+    //
+    [[nodiscard]] Ray_Packet_Hits intersect_dial_3d(Ray_Packet const& packet, Dial_3D const& dial, Prepared_Handle const& handle);
 } // namespace anton::gizmo
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <anton/array.hpp>
+#include <anton/math/vec3.hpp>
+#include <anton/types.hpp>
+
+namespace anton::gizmo {
+    // Primitive_Topology
+    // How consecutive vertices of generated geometry form triangles.
+    //
+    enum class Primitive_Topology {
+        // Every 3 consecutive vertices form a triangle.
+        triangle_list,
+        // A single triangle strip. Separate parts of the geometry are joined with degenerate triangles.
+        triangle_strip,
+    };
+
+    // Indexed_Geometry
+    // Geometry with deduplicated vertices. Every 3 consecutive indices form a triangle.
+    //
+    struct Indexed_Geometry {
+        Array<math::Vec3> vertices;
+        Array<u32> indices;
+    };
+
+    enum class Position_Format {
+        // 3 32-bit floats.
+        f32x3,
+        // 4 16-bit floats. The 4th component is 1.0.
+        f16x4,
+        // 4 16-bit signed normalized integers quantized within the bounding box of the shape. The 4th component is 1.0.
+        snorm16x4,
+        // A 32-bit integer with 3 10-bit signed normalized integers quantized within the bounding box of the shape
+        // in bits 0-9, 10-19 and 20-29 and a 2-bit signed normalized integer 1.0 in bits 30-31.
+        snorm10x3_2,
+    };
+
+    // Position_Dequantization
+    // Maps the normalized components q in [-1, 1] of a quantized position back to the local space of the shape
+    // as position = q * scale + bias. For the floating point formats scale is 1 and bias is 0.
+    //
+    struct Position_Dequantization {
+        math::Vec3 scale;
+        math::Vec3 bias;
+    };
+
+    enum class Normal_Format {
+        none,
+        // 3 32-bit floats.
+        f32x3,
+        // 4 16-bit floats. The 4th component is 0.0.
+        f16x4,
+        // 4 16-bit signed normalized integers. The 4th component is 0.
+        snorm16x4,
+    };
+
+    enum class Handle_ID_Format {
+        none,
+        u8,
+        u16,
+        u32,
+    };
+
+    // Vertex_Layout
+    // Describes the format and placement of the attributes of a single vertex in an interleaved vertex buffer.
+    // The attributes are written with their native byte order and do not have to be aligned.
+    //
+    struct Vertex_Layout {
+        // The size of a single vertex in bytes.
+        i64 stride;
+        Position_Format position_format;
+        i64 position_offset;
+        // The flat normal of the triangle the vertex belongs to.
+        Normal_Format normal_format;
+        i64 normal_offset;
+        // The handle id passed to the generator.
+        Handle_ID_Format handle_id_format;
+        i64 handle_id_offset;
+    };
+
+    // make_vertex_layout
+    // Creates a layout with the attributes stored in the order position, normal, handle id without any padding
+    // other than rounding the stride up to a multiple of 4.
+    //
+    [[nodiscard]] Vertex_Layout make_vertex_layout(Position_Format position_format, Normal_Format normal_format = Normal_Format::none,
+                                                   Handle_ID_Format handle_id_format = Handle_ID_Format::none);
+
+    // narrow_indices_u16
+    // Converts the 32-bit indices of the geometry to 16-bit indices.
+    // The geometry must not have more than 65536 vertices.
+    //
+    // Returns:
+    // An array containing the same triangle list as geometry.indices.
+    //
+    [[nodiscard]] Array<u16> narrow_indices_u16(Indexed_Geometry const& geometry);
+} // namespace anton::gizmo
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <anton/array.hpp>
+#include <anton/gizmo/arrow_3d.hpp>
+#include <anton/gizmo/baked_geometry.hpp>
+#include <anton/gizmo/dial_3d.hpp>
+#include <anton/gizmo/geometry.hpp>
+#include <anton/gizmo/geometry_key.hpp>
+#include <anton/math/vec3.hpp>
+#include <anton/slice.hpp>
+#include <anton/types.hpp>
+
+namespace anton::gizmo {
+    struct Geometry_Cache_Entry;
+
+    // Shared_Geometry
+    // A reference counted handle to immutable geometry owned by a Geometry_Cache.
+    // The geometry stays alive as long as any handle refers to it, even if the cache evicts it or is destroyed.
+    // Handles are not thread-safe. Copying and destroying handles to the same geometry must be synchronized.
+    //
+    class Shared_Geometry {
+    public:
+        Shared_Geometry() = default;
+        Shared_Geometry(Shared_Geometry const& other);
+        Shared_Geometry(Shared_Geometry&& other);
+        Shared_Geometry& operator=(Shared_Geometry const& other);
+        Shared_Geometry& operator=(Shared_Geometry&& other);
+        ~Shared_Geometry();
+
+        // get_vertices
+        //
+        // Returns:
+        // The triangle list of the geometry or an empty slice if the handle does not refer to any geometry.
+        //
+        [[nodiscard]] Slice<math::Vec3 const> get_vertices() const;
+
+        [[nodiscard]] explicit operator bool() const;
+
+    private:
+        friend class Geometry_Cache;
+
+        Geometry_Cache_Entry* entry = nullptr;
+
+        explicit Shared_Geometry(Geometry_Cache_Entry* entry);
+    };
+
+    struct Geometry_Cache_Statistics {
+        // The number of requests that returned already cached geometry.
+        i64 hits;
+        // The number of requests that were not cached, including those served from baked geometry.
+        i64 misses;
+        // The number of misses served from baked geometry instead of generating it.
+        i64 baked_loads;
+        // The number of entries removed from the cache to stay within the memory budget.
+        i64 evictions;
+        // The number of entries currently held by the cache.
+        i64 entry_count;
+        // The size in bytes of the vertices of all entries currently held by the cache.
+        // Baked geometry is not owned by the cache and does not count towards the memory usage.
+        i64 memory_usage;
+    };
+
+    // Geometry_Cache
+    // Memoizes generated geometry keyed by the parameters of the generator, so that requesting the same geometry
+    // repeatedly, e.g. when creating viewports, generates it only once.
+    //
+    // When the memory usage exceeds the budget, the least recently requested entries are evicted. Evicted geometry
+    // that is still referenced by a Shared_Geometry stays alive until the last handle is destroyed, but no longer
+    // counts towards the memory usage. The most recently requested entry is never evicted.
+    //
+    // If baked geometry has been set, misses first look the geometry up in the baked geometry file and
+    // fall back to generating it when the file does not contain geometry with matching parameters.
+    //
+    // The cache is not thread-safe.
+    //
+    class Geometry_Cache {
+    public:
+        // Parameters:
+        // memory_budget - the maximum size in bytes of the vertices held by the cache.
+        //
+        explicit Geometry_Cache(i64 memory_budget);
+        Geometry_Cache(Geometry_Cache const&) = delete;
+        Geometry_Cache& operator=(Geometry_Cache const&) = delete;
+        ~Geometry_Cache();
+
+        // get_arrow_3d
+        // Returns the geometry generated by generate_arrow_3d_geometry(arrow, vertex_count).
+        //
+        [[nodiscard]] Shared_Geometry get_arrow_3d(Arrow_3D const& arrow, i32 vertex_count);
+
+        // get_dial_3d
+        // Returns the geometry generated by generate_dial_3d_geometry(dial, vertex_count_major, vertex_count_minor, topology).
+        //
+        [[nodiscard]] Shared_Geometry get_dial_3d(Dial_3D const& dial, i32 vertex_count_major, i32 vertex_count_minor,
+                                                  Primitive_Topology topology = Primitive_Topology::triangle_list);
+
+        // get_icosphere
+        // Returns the geometry generated by generate_icosphere(level).
+        //
+        [[nodiscard]] Shared_Geometry get_icosphere(i64 level);
+
+        // set_baked_geometry
+        // Sets the baked geometry file used to serve misses. The file must stay open as long as any geometry
+        // obtained from it is referenced by the cache or a Shared_Geometry. Pass nullptr to always generate geometry.
+        //
+        void set_baked_geometry(Baked_Geometry_File const* file);
+
+        // set_memory_budget
+        // Changes the memory budget and evicts entries until the memory usage is within the new budget.
+        //
+        void set_memory_budget(i64 memory_budget);
+
+        // clear
+        // Removes all entries from the cache. Does not reset the statistics.
+        //
+        void clear();
+
+        [[nodiscard]] Geometry_Cache_Statistics get_statistics() const;
+
+        // reset_statistics
+        // Resets the hit, miss, baked load and eviction counters.
+        //
+        void reset_statistics();
+
+    private:
+        struct Entry {
+            Geometry_Key key;
+            u64 hash;
+            u64 last_use;
+            Geometry_Cache_Entry* geometry;
+        };
+
+        Array<Entry> entries;
+        Baked_Geometry_File const* baked_geometry = nullptr;
+        i64 memory_budget;
+        i64 memory_usage = 0;
+        u64 use_counter = 0;
+        i64 hits = 0;
+        i64 misses = 0;
+        i64 baked_loads = 0;
+        i64 evictions = 0;
+
+        [[nodiscard]] Entry* find(Geometry_Key const& key, u64 hash);
+        [[nodiscard]] Geometry_Cache_Entry* load_baked(Geometry_Key const& key);
+        Shared_Geometry insert(Geometry_Key const& key, u64 hash, Geometry_Cache_Entry* geometry);
+        void evict();
+        void remove(i64 index);
+    };
+} // namespace anton::gizmo
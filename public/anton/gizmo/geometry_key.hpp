@@ -0,0 +1,29 @@
+#pragma once
+
+#include <anton/gizmo/arrow_3d.hpp>
+#include <anton/gizmo/dial_3d.hpp>
+#include <anton/gizmo/geometry.hpp>
+#include <anton/types.hpp>
+
+namespace anton::gizmo {
+    // Geometry_Key
+    // Identifies generated geometry by the generator and the bit patterns of its parameters.
+    // Used to look up geometry in Geometry_Cache and baked geometry files.
+    //
+    struct Geometry_Key {
+        u32 words[8];
+    };
+
+    [[nodiscard]] Geometry_Key make_arrow_3d_key(Arrow_3D const& arrow, i32 vertex_count);
+    [[nodiscard]] Geometry_Key make_dial_3d_key(Dial_3D const& dial, i32 vertex_count_major, i32 vertex_count_minor,
+                                                Primitive_Topology topology = Primitive_Topology::triangle_list);
+    [[nodiscard]] Geometry_Key make_icosphere_key(i64 subdivision_level);
+
+    // hash_geometry_key
+    // Calculates the FNV-1a hash of the words of key.
+    //
+    [[nodiscard]] u64 hash_geometry_key(Geometry_Key const& key);
+
+    [[nodiscard]] bool operator==(Geometry_Key const& lhs, Geometry_Key const& rhs);
+    [[nodiscard]] bool operator!=(Geometry_Key const& lhs, Geometry_Key const& rhs);
+} // namespace anton::gizmo
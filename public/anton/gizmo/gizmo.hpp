@@ -1,6 +1,21 @@
 #pragma once
 
 #include <anton/gizmo/arrow_3d.hpp>
+#include <anton/gizmo/baked_geometry.hpp>
 #include <anton/gizmo/dial_3d.hpp>
+#include <anton/gizmo/geometry.hpp>
+#include <anton/gizmo/geometry_cache.hpp>
+#include <anton/gizmo/geometry_key.hpp>
+#include <anton/gizmo/gizmo_bvh.hpp>
+#include <anton/gizmo/gizmo_builder.hpp>
+#include <anton/gizmo/hover_tracker.hpp>
+#include <anton/gizmo/instancing.hpp>
+#include <anton/gizmo/lod.hpp>
 #include <anton/gizmo/manipulate.hpp>
+#include <anton/gizmo/mesh_bvh.hpp>
+#include <anton/gizmo/picking.hpp>
+#include <anton/gizmo/prepared_handle.hpp>
+#include <anton/gizmo/ray_packet.hpp>
+#include <anton/gizmo/screen_picking.hpp>
 #include <anton/gizmo/shapes.hpp>
+#include <anton/gizmo/task_executor.hpp>
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <anton/array.hpp>
+#include <anton/gizmo/arrow_3d.hpp>
+#include <anton/gizmo/dial_3d.hpp>
+#include <anton/gizmo/geometry.hpp>
+#include <anton/math/vec3.hpp>
+#include <anton/slice.hpp>
+#include <anton/types.hpp>
+
+namespace anton::gizmo {
+    // Gizmo_Handle
+    // The handles of the composite gizmos. The handle id of a handle is the base handle id passed to
+    // the builder plus the value of the handle.
+    //
+    enum class Gizmo_Handle : u32 {
+        // The arrows of the translate and scale gizmos and the dials of the rotate gizmo.
+        axis_x,
+        axis_y,
+        axis_z,
+        // The planes of the translate gizmo.
+        plane_yz,
+        plane_zx,
+        plane_xy,
+        // The cube of the translate and scale gizmos and the trackball of the rotate gizmo.
+        center,
+    };
+
+    // The number of values of Gizmo_Handle.
+    constexpr i64 gizmo_handle_count = 7;
+
+    struct Gizmo_Draw_Range {
+        Gizmo_Handle handle;
+        u32 handle_id;
+        i64 first_vertex;
+        i64 vertex_count;
+    };
+
+    // Gizmo_Geometry
+    // The triangle list of all handles of a gizmo in a single interleaved vertex buffer.
+    // The whole gizmo may be drawn with a single draw of all vertices or each handle separately using the draw ranges.
+    //
+    struct Gizmo_Geometry {
+        Array<u8> vertices;
+        Vertex_Layout layout;
+        // The dequantization of the positions, shared by all handles.
+        Position_Dequantization dequantization;
+        i64 vertex_count;
+        // Draw ranges in the order the handles are stored in vertices.
+        Array<Gizmo_Draw_Range> draw_ranges;
+    };
+
+    struct Translate_Gizmo {
+        Arrow_3D arrow;
+        // The number of vertices that comprise the base of the cones of the arrows.
+        i32 arrow_vertex_count;
+        // The length of the edges of the planes.
+        f32 plane_size;
+        // The distance of the centers of the planes from the axes they are spanned by.
+        f32 plane_offset;
+        // The length of the edges of the center cube.
+        f32 center_size;
+    };
+
+    struct Rotate_Gizmo {
+        Dial_3D dial;
+        i32 dial_vertex_count_major;
+        i32 dial_vertex_count_minor;
+        f32 trackball_radius;
+        i64 trackball_subdivision_level;
+    };
+
+    struct Scale_Gizmo {
+        Arrow_3D arrow;
+        // The number of vertices that comprise the base of the cones of the arrows (in case cone is the draw_style).
+        i32 arrow_vertex_count;
+        // The length of the edges of the center cube.
+        f32 center_size;
+    };
+
+    // Gizmo_Builder
+    // Builds complete gizmos out of the handle geometries. The geometries are placed in the local space of the gizmo
+    // with the handles of the x, y and z axis directed towards +x, +y and +z. The builder keeps its scratch memory
+    // between builds.
+    //
+    class Gizmo_Builder {
+    public:
+        explicit Gizmo_Builder(Vertex_Layout const& layout);
+
+        // build_translate
+        // Builds a translate gizmo consisting of 3 arrows, 3 planes and a center cube.
+        //
+        // Parameters:
+        //          gizmo - parameter struct that defines the shape and size of the handles.
+        // base_handle_id - the handle id of Gizmo_Handle::axis_x.
+        //
+        [[nodiscard]] Gizmo_Geometry build_translate(Translate_Gizmo const& gizmo, u32 base_handle_id);
+
+        // build_rotate
+        // Builds a rotate gizmo consisting of 3 dials and a trackball sphere.
+        //
+        // Parameters:
+        //          gizmo - parameter struct that defines the shape and size of the handles.
+        // base_handle_id - the handle id of Gizmo_Handle::axis_x.
+        //
+        [[nodiscard]] Gizmo_Geometry build_rotate(Rotate_Gizmo const& gizmo, u32 base_handle_id);
+
+        // build_scale
+        // Builds a scale gizmo consisting of 3 arrows and a center cube.
+        //
+        // Parameters:
+        //          gizmo - parameter struct that defines the shape and size of the handles.
+        // base_handle_id - the handle id of Gizmo_Handle::axis_x.
+        //
+        [[nodiscard]] Gizmo_Geometry build_scale(Scale_Gizmo const& gizmo, u32 base_handle_id);
+
+    private:
+        Vertex_Layout layout;
+        // Positions of all handles of the gizmo being built.
+        Array<math::Vec3> positions;
+        Array<Gizmo_Draw_Range> draw_ranges;
+
+        [[nodiscard]] Slice<math::Vec3> begin_handle(Gizmo_Handle handle, i64 vertex_count);
+        [[nodiscard]] Gizmo_Geometry finish(u32 base_handle_id);
+    };
+} // namespace anton::gizmo
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <anton/array.hpp>
+#include <anton/gizmo/picking.hpp>
+#include <anton/math/primitives.hpp>
+#include <anton/math/vec3.hpp>
+#include <anton/optional.hpp>
+#include <anton/slice.hpp>
+#include <anton/types.hpp>
+
+namespace anton::gizmo {
+    struct Gizmo_Instance_Pick {
+        // The index of the picked gizmo in the slice passed to Gizmo_BVH::pick.
+        i64 instance;
+        Gizmo_Pick pick;
+    };
+
+    // Gizmo_BVH
+    // A bounding volume hierarchy over the bounding spheres of many prepared gizmos, e.g. the gizmos of all objects
+    // of a selection, that finds the nearest handle of all gizmos without testing every gizmo.
+    //
+    // The hierarchy does not store the gizmos. The gizmos passed to refit and pick must be the gizmos the hierarchy
+    // has been built for, in the same order, with possibly changed transforms. When the gizmos move, refit updates
+    // the bounds of the nodes without changing the structure of the hierarchy. Picking gets slower as the gizmos
+    // move further from the positions the hierarchy has been built for, so the hierarchy should be built again
+    // once the movement is finished.
+    //
+    class Gizmo_BVH {
+    public:
+        // build
+        // Builds the hierarchy over gizmos reusing the memory of the previous build.
+        //
+        void build(Slice<Prepared_Gizmo const> gizmos);
+
+        // refit
+        // Updates the bounds of all nodes.
+        //
+        void refit(Slice<Prepared_Gizmo const> gizmos);
+
+        // refit
+        // Updates the bounds of the nodes containing the gizmos at changed_indices only.
+        // Faster than refitting all nodes when few gizmos have changed.
+        //
+        void refit(Slice<Prepared_Gizmo const> gizmos, Slice<i64 const> changed_indices);
+
+        // pick
+        // Finds the handle nearest along the ray of all gizmos. The nodes are visited front to back
+        // and nodes farther than the nearest hit found so far are skipped.
+        //
+        // Parameters:
+        //            ray - a world space ray to test against. The direction must be normalized.
+        //         gizmos - the gizmos the hierarchy has been built for.
+        // base_handle_id - the handle id of Gizmo_Handle::axis_x of every gizmo.
+        //
+        // Returns:
+        // The nearest handle hit by the ray and the index of its gizmo or null_optional if no handle has been hit.
+        //
+        [[nodiscard]] Optional<Gizmo_Instance_Pick> pick(math::Ray const& ray, Slice<Prepared_Gizmo const> gizmos, u32 base_handle_id) const;
+
+    private:
+        struct Node {
+            math::Vec3 min;
+            math::Vec3 max;
+            // For leaves the index of the first element of the node in instances.
+            // For inner nodes the index of the left child. The right child immediately follows the left child.
+            i64 first;
+            // The number of gizmos of a leaf. 0 for inner nodes.
+            i64 count;
+            // -1 for the root.
+            i64 parent;
+        };
+
+        // Children always follow their parents, so visiting the nodes in reverse order visits children first.
+        Array<Node> nodes;
+        // The indices of the gizmos ordered so that the gizmos of every leaf are stored contiguously.
+        Array<i64> instances;
+        // The index of the leaf containing each gizmo.
+        Array<i64> leaves;
+
+        void build_node(Slice<Prepared_Gizmo const> gizmos, i64 node);
+        void fit_leaf(Slice<Prepared_Gizmo const> gizmos, i64 node);
+        void fit_inner(i64 node);
+    };
+} // namespace anton::gizmo
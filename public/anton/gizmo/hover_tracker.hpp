@@ -0,0 +1,93 @@
+#pragma once
+
+#include <anton/gizmo/gizmo_builder.hpp>
+#include <anton/gizmo/picking.hpp>
+#include <anton/math/mat4.hpp>
+#include <anton/math/primitives.hpp>
+#include <anton/optional.hpp>
+#include <anton/types.hpp>
+
+namespace anton::gizmo {
+    struct Hover_Tracker_Counters {
+        // The number of calls to pick.
+        i64 queries = 0;
+        // The number of queries that have tested the whole gizmo.
+        i64 full_tests = 0;
+        // The number of queries answered by re-testing only the previous winner and the handles whose bounding spheres
+        // the ray may have reached since the last full test.
+        i64 avoided_full_tests = 0;
+        // The number of handles re-tested by the queries that avoided the full test.
+        i64 verified_handles = 0;
+        // The number of handles that the queries that avoided the full test did not have to test.
+        i64 skipped_handles = 0;
+    };
+
+    // Hover_Tracker
+    // Picks a gizmo under a cursor that moves by small steps, e.g. on every mouse move event, without testing every handle
+    // on every move. The results are identical to those of pick_gizmo.
+    //
+    // On a full test the tracker remembers the ray and, for every handle, how far the ray passes by the bounding sphere
+    // of the handle. As long as the gizmo has not changed and the following rays differ from that ray by less than any
+    // such clearance, the rays still miss the handles whose bounding spheres the remembered ray missed. Only the other
+    // handles, i.e. the previous winner and its neighbours along the ray, are tested again, starting with the previous
+    // winner. Once the rays move too far, the tracker tests the whole gizmo again and remembers the new ray.
+    //
+    class Hover_Tracker {
+    public:
+        // pick
+        // Finds the handle of the gizmo nearest along the ray. The gizmo is prepared only when the hash
+        // of its parameters and transform changes.
+        //
+        // Parameters:
+        //             ray - a world space ray to test against. The direction must be normalized.
+        //           gizmo - parameter struct that defines the shape and size of the handles.
+        // gizmo_transform - a transform of the gizmo to the world space. The transform must consist of
+        //                   translation, rotation and uniform scale only.
+        //  base_handle_id - the handle id of Gizmo_Handle::axis_x.
+        //
+        [[nodiscard]] Optional<Gizmo_Pick> pick(math::Ray const& ray, Translate_Gizmo const& gizmo, math::Mat4 const& gizmo_transform, u32 base_handle_id);
+        [[nodiscard]] Optional<Gizmo_Pick> pick(math::Ray const& ray, Rotate_Gizmo const& gizmo, math::Mat4 const& gizmo_transform, u32 base_handle_id);
+        [[nodiscard]] Optional<Gizmo_Pick> pick(math::Ray const& ray, Scale_Gizmo const& gizmo, math::Mat4 const& gizmo_transform, u32 base_handle_id);
+
+        // pick
+        // Finds the handle of a prepared gizmo nearest along the ray.
+        //
+        // Parameters:
+        //            ray - a world space ray to test against. The direction must be normalized.
+        //          gizmo - the prepared gizmo.
+        //     gizmo_hash - a value that changes whenever gizmo changes, e.g. a hash of its parameters and transform.
+        // base_handle_id - the handle id of Gizmo_Handle::axis_x.
+        //
+        [[nodiscard]] Optional<Gizmo_Pick> pick(math::Ray const& ray, Prepared_Gizmo const& gizmo, u64 gizmo_hash, u32 base_handle_id);
+
+        // reset
+        // Forgets the remembered ray, so that the next query tests the whole gizmo. The counters are kept.
+        //
+        void reset();
+
+        [[nodiscard]] Hover_Tracker_Counters const& get_counters() const;
+        void reset_counters();
+
+    private:
+        // The gizmo prepared by the overloads taking the parameters of the gizmo and the hash it has been prepared with.
+        Prepared_Gizmo prepared;
+        u64 prepared_hash = 0;
+        bool has_prepared = false;
+        // Whether the remembered ray and clearances are valid.
+        bool valid = false;
+        u64 gizmo_hash = 0;
+        math::Ray ray;
+        // The distance by which ray passes by the bounding sphere of the whole gizmo and the greatest distance along ray
+        // to a point of the sphere. The clearance is not positive if ray intersects the sphere.
+        f32 gizmo_clearance = 0.0f;
+        f32 gizmo_reach = 0.0f;
+        // The same for the bounding spheres of the handles indexed by Gizmo_Handle.
+        f32 clearances[gizmo_handle_count] = {};
+        f32 reaches[gizmo_handle_count] = {};
+        // The handle picked by the previous query or -1 if no handle has been picked.
+        i64 winner = -1;
+        Hover_Tracker_Counters counters;
+
+        [[nodiscard]] Optional<Gizmo_Pick> pick_full(math::Ray const& ray, Prepared_Gizmo const& gizmo, u64 gizmo_hash, u32 base_handle_id);
+    };
+} // namespace anton::gizmo
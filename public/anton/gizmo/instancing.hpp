@@ -0,0 +1,58 @@
+#pragma once
+
+#include <anton/array.hpp>
+#include <anton/math/mat4.hpp>
+#include <anton/slice.hpp>
+#include <anton/types.hpp>
+
+namespace anton::gizmo {
+    // The colour index of the instances of the axis highlighted by generate_gizmo_instances.
+    // The remaining instances use the axis id (0 for x, 1 for y, 2 for z) as their colour index.
+    constexpr u8 highlight_colour_index = 3;
+
+    // gizmo_instance_count
+    // Calculates the number of instances written by generate_gizmo_instances.
+    //
+    [[nodiscard]] i64 gizmo_instance_count(i64 gizmo_count);
+
+    // Gizmo_Instance_Stream
+    // Per-instance data of the handles of gizmos stored as separate tightly packed streams.
+    // Instance 3 * i + a is the handle of axis a of gizmo i.
+    //
+    struct Gizmo_Instance_Stream {
+        // Row-major 3x4 matrices, 12 floats per instance. The 4th row is (0, 0, 0, 1).
+        Array<f32> transforms;
+        Array<u8> axis_ids;
+        Array<u8> colour_indices;
+    };
+
+    // generate_gizmo_instances
+    // Calculates the per-instance data of the x, y and z handles of gizmos in a single batch.
+    // The handle meshes (generate_arrow_3d_geometry, generate_dial_3d_geometry, ...) are generated once in their
+    // local space where they are directed towards -z. The transform of an instance orients -z of the mesh along
+    // its axis in the local space of the gizmo and then applies the world transform of the gizmo.
+    //
+    // Parameters:
+    //   world_transforms - transforms of the gizmos to the world space.
+    //   highlighted_axes - the index of the axis of each gizmo to highlight or -1 for none.
+    //                      Either empty or has the same size as world_transforms.
+    //
+    // Returns:
+    // gizmo_instance_count(world_transforms.size()) instances.
+    //
+    [[nodiscard]] Gizmo_Instance_Stream generate_gizmo_instances(Slice<math::Mat4 const> world_transforms, Slice<i32 const> highlighted_axes = {});
+
+    // generate_gizmo_instances
+    // Writes the per-instance data to caller-provided streams without allocating memory.
+    //
+    // Parameters:
+    //   world_transforms - transforms of the gizmos to the world space.
+    //   highlighted_axes - the index of the axis of each gizmo to highlight or -1 for none.
+    //                      Either empty or has the same size as world_transforms.
+    //         transforms - must have at least 12 * gizmo_instance_count(world_transforms.size()) elements.
+    //           axis_ids - must have at least gizmo_instance_count(world_transforms.size()) elements.
+    //     colour_indices - must have at least gizmo_instance_count(world_transforms.size()) elements.
+    //
+    void generate_gizmo_instances(Slice<math::Mat4 const> world_transforms, Slice<i32 const> highlighted_axes, Slice<f32> transforms, Slice<u8> axis_ids,
+                                  Slice<u8> colour_indices);
+} // namespace anton::gizmo
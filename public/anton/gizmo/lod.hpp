@@ -0,0 +1,96 @@
+#pragma once
+
+#include <anton/array.hpp>
+#include <anton/gizmo/arrow_3d.hpp>
+#include <anton/gizmo/dial_3d.hpp>
+#include <anton/gizmo/geometry.hpp>
+#include <anton/math/mat4.hpp>
+#include <anton/math/vec2.hpp>
+#include <anton/math/vec3.hpp>
+#include <anton/types.hpp>
+
+namespace anton::gizmo {
+    struct LOD_Level {
+        // Index of the first vertex of the level in LOD_Chain::vertices.
+        i64 first_vertex;
+        i64 vertex_count;
+        // The largest distance between the tessellated and the exact surface in the local space of the geometry.
+        f32 error;
+    };
+
+    // LOD_Chain
+    // Tessellations of the same shape of decreasing detail stored in a single buffer.
+    //
+    struct LOD_Chain {
+        // Triangle lists of all levels stored one after another.
+        Array<math::Vec3> vertices;
+        // Level 0 is the most detailed.
+        Array<LOD_Level> levels;
+        // The radius of a sphere centered at (0, 0, 0) that contains all levels.
+        f32 bounding_radius;
+    };
+
+    // generate_arrow_3d_lod_chain
+    // Generates a chain of arrow geometries. Each level has half the vertex_count of the previous level.
+    // Levels that would not reduce the geometry any further are omitted.
+    //
+    // Parameters:
+    //        arrow - parameter struct that defines the shape and size of the geometry.
+    // vertex_count - the number of vertices that comprise the base of the cone of the most detailed level. At least 3.
+    //  level_count - the maximum number of levels.
+    //
+    [[nodiscard]] LOD_Chain generate_arrow_3d_lod_chain(Arrow_3D const& arrow, i32 vertex_count, i32 level_count);
+
+    // generate_dial_3d_lod_chain
+    // Generates a chain of dial geometries. Each level has half the vertex_count_major and vertex_count_minor
+    // of the previous level. Levels that would not reduce the geometry any further are omitted.
+    //
+    // Parameters:
+    //               dial - parameter struct that defines the size of the geometry.
+    // vertex_count_major - the number of vertices that comprise the large circle of the most detailed level. At least 3.
+    // vertex_count_minor - the number of vertices that comprise the small circle of the most detailed level. At least 3.
+    //        level_count - the maximum number of levels.
+    //           topology - the topology of the generated vertices.
+    //
+    [[nodiscard]] LOD_Chain generate_dial_3d_lod_chain(Dial_3D const& dial, i32 vertex_count_major, i32 vertex_count_minor, i32 level_count,
+                                                       Primitive_Topology topology = Primitive_Topology::triangle_list);
+
+    // generate_icosphere_lod_chain
+    // Generates a chain of icospheres. Each level is subdivided one time less than the previous level.
+    //
+    // Parameters:
+    // subdivision_level - the subdivision level of the most detailed level.
+    //       level_count - the maximum number of levels.
+    //
+    [[nodiscard]] LOD_Chain generate_icosphere_lod_chain(i64 subdivision_level, i32 level_count);
+
+    // calculate_screen_radius
+    // Estimates the radius in pixels of the projection of a sphere centered at the origin of the local space of a gizmo.
+    // Assumes world_transform applies uniform scale.
+    //
+    // Parameters:
+    //   bounding_radius - the radius of the sphere in the local space of the gizmo.
+    //   world_transform - transform from the local space of the gizmo to the world space.
+    //    view_transform - transform from the world space to the view space.
+    // projection_matrix - transform from the view space to the clip space.
+    //     viewport_size - the size of the viewport in pixels.
+    //
+    // Returns:
+    // The radius in pixels. If the camera is inside the sphere, the radius of a sphere that fills the viewport.
+    //
+    [[nodiscard]] f32 calculate_screen_radius(f32 bounding_radius, math::Mat4 const& world_transform, math::Mat4 const& view_transform,
+                                              math::Mat4 const& projection_matrix, math::Vec2 viewport_size);
+
+    // select_lod_level
+    // Selects the least detailed level whose error projected onto the screen does not exceed max_error.
+    //
+    // Parameters:
+    //         chain - the LOD chain to select the level from.
+    // screen_radius - the radius in pixels of the bounding sphere of the chain as calculated by calculate_screen_radius.
+    //     max_error - the largest acceptable error in pixels.
+    //
+    // Returns:
+    // Index of the level in chain.levels. 0 if no level satisfies max_error or if the chain is empty.
+    //
+    [[nodiscard]] i64 select_lod_level(LOD_Chain const& chain, f32 screen_radius, f32 max_error = 0.5f);
+} // namespace anton::gizmo
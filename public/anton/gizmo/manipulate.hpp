@@ -1,9 +1,12 @@
 #pragma once
 
+#include <anton/gizmo/task_executor.hpp>
 #include <anton/math/mat4.hpp>
 #include <anton/math/primitives.hpp>
 #include <anton/math/quat.hpp>
+#include <anton/math/vec2.hpp>
 #include <anton/math/vec3.hpp>
+#include <anton/optional.hpp>
 #include <anton/types.hpp>
 
 namespace anton::gizmo {
@@ -172,4 +175,174 @@ namespace anton::gizmo {
     //
     [[nodiscard]] math::Quat orient_trackball(math::Ray ray, math::Vec3 first_axis, math::Vec3 second_axis, math::Vec3 origin, math::Ray initial_ray,
                                               math::Quat initial_orientation, f32 snap = 0.0f);
+
+    // Manipulation_Result
+    // The result of Manipulation_Session::update. Only the member matching the kind of the session changes.
+    //
+    struct Manipulation_Result {
+        // The changed position in the parent space for translate sessions or the changed scale in the local space
+        // for scale sessions.
+        math::Vec3 vector;
+        // The changed orientation for turn and trackball sessions.
+        math::Quat orientation;
+    };
+
+    // Manipulation_Delta
+    // The change of a manipulation shared by all manipulated objects.
+    // Identity (no translation, factor 1, no rotation) if the rays miss the plane of the manipulation.
+    //
+    struct Manipulation_Delta {
+        // The translation in the world space for translate sessions.
+        math::Vec3 translation;
+        // The factor by which scale sessions multiply the part of the scale they change.
+        f32 scale_factor;
+        // The rotation applied before the initial orientation for turn and trackball sessions.
+        math::Quat rotation;
+    };
+
+    // Manipulation_Batch
+    // The initial values of many objects manipulated together and the arrays to write their changed values to.
+    // Every component is stored in a separate array of count elements, so that several objects can be processed
+    // at once. The arrays of the changed values may be the same as the arrays of the initial values.
+    //
+    struct Manipulation_Batch {
+        // The number of objects.
+        i64 count = 0;
+        // Translate sessions only. The upper-left 3x3 parts of the inverse parent transforms of the objects, indexed
+        // by [column][row]. The transforms are used only if all 9 arrays are set. Otherwise the objects are treated
+        // as unparented and translated in the world space.
+        f32 const* inverse_parent_transforms[3][3] = {};
+        // Translate and scale sessions. The x, y and z components of the initial positions in the parent spaces
+        // or the initial scales in the local spaces of the objects.
+        f32 const* initial_vectors[3] = {};
+        // Translate and scale sessions. The x, y and z components of the changed positions or scales.
+        f32* vectors[3] = {};
+        // Turn and trackball sessions. The x, y, z and w components of the initial orientations.
+        f32 const* initial_orientations[4] = {};
+        // Turn and trackball sessions. The x, y, z and w components of the changed orientations.
+        f32* orientations[4] = {};
+    };
+
+    // Manipulation_Session
+    // A manipulation of an object from the start of a drag to its end. The functions above recompute everything they
+    // derive from their parameters, e.g. the plane the rays are intersected with and the hit of initial_ray, on every
+    // call, although the parameters stay the same for the whole drag. A session computes them once at the start
+    // of the drag, so that every update costs a single ray-plane intersection and a few dot products.
+    //
+    // Sessions are created with the static functions named after the functions above, which take the same parameters
+    // except ray. update(ray) returns the same result as the function would for ray.
+    //
+    class Manipulation_Session {
+    public:
+        [[nodiscard]] static Manipulation_Session translate_along_line(math::Mat4 const& inverse_parent_transform, math::Vec3 axis, math::Vec3 origin,
+                                                                       math::Ray initial_ray, math::Vec3 initial_position, f32 snap = 0.0f);
+        [[nodiscard]] static Manipulation_Session translate_along_plane(math::Mat4 const& inverse_parent_transform, math::Vec3 first_axis,
+                                                                        math::Vec3 second_axis, math::Vec3 origin, math::Ray initial_ray,
+                                                                        math::Vec3 initial_position, f32 snap = 0.0f);
+        [[nodiscard]] static Manipulation_Session scale_along_line(math::Vec3 axis_world, math::Vec3 axis_local, math::Vec3 origin, math::Ray initial_ray,
+                                                                   math::Vec3 initial_scale, f32 snap = 0.0f);
+        [[nodiscard]] static Manipulation_Session scale_along_plane(math::Vec3 first_axis_world, math::Vec3 first_axis_local, math::Vec3 second_axis_world,
+                                                                    math::Vec3 second_axis_local, math::Vec3 origin, math::Ray initial_ray,
+                                                                    math::Vec3 initial_scale, f32 snap = 0.0f);
+        [[nodiscard]] static Manipulation_Session scale_uniform_along_line(math::Vec3 axis, math::Vec3 origin, math::Ray initial_ray,
+                                                                           math::Vec3 initial_scale, f32 snap = 0.0f);
+        [[nodiscard]] static Manipulation_Session scale_uniform_along_plane(math::Vec3 first_axis, math::Vec3 second_axis, math::Vec3 origin,
+                                                                            math::Ray initial_ray, math::Vec3 initial_scale, f32 snap = 0.0f);
+        [[nodiscard]] static Manipulation_Session orient_turn(math::Vec3 axis, math::Vec3 origin, math::Ray initial_ray, math::Quat initial_orientation,
+                                                              f32 snap = 0.0f);
+        [[nodiscard]] static Manipulation_Session orient_trackball(math::Vec3 first_axis, math::Vec3 second_axis, math::Vec3 origin, math::Ray initial_ray,
+                                                                   math::Quat initial_orientation, f32 snap = 0.0f);
+
+        // update
+        // Calculates the result of the manipulation for the current ray.
+        //
+        // Parameters:
+        // ray - the current ray in the world space constructed by unprojecting the cursor.
+        //
+        // Returns:
+        // The changed position or scale in vector or the changed orientation in orientation depending on the kind
+        // of the session. The other member holds its initial value.
+        //
+        [[nodiscard]] Manipulation_Result update(math::Ray const& ray);
+
+        // update_delta
+        // Calculates the change of the manipulation for the current ray independent of the initial value
+        // and the parent transform of the object.
+        //
+        // Parameters:
+        // ray - the current ray in the world space constructed by unprojecting the cursor.
+        //
+        [[nodiscard]] Manipulation_Delta update_delta(math::Ray const& ray);
+
+        // update_batch
+        // Applies the change of the manipulation for the current ray to every object of batch, e.g. all objects
+        // of a selection dragged with one gizmo. The change is calculated once and the objects are processed
+        // 8 at a time with AVX2 (if enabled with ANTON_GIZMO_ENABLE_AVX2), 4 at a time with SSE2 or one at a time
+        // on other targets. The initial value and the inverse parent transform passed to the function that has
+        // created the session are not used.
+        //
+        // Parameters:
+        //      ray - the current ray in the world space constructed by unprojecting the cursor.
+        //    batch - the objects to manipulate. Only the arrays used by the kind of the session must be set.
+        // executor - splits large batches into tasks. nullptr processes the batch on the calling thread.
+        //
+        void update_batch(math::Ray const& ray, Manipulation_Batch const& batch, Task_Executor* executor = nullptr);
+
+    private:
+        enum class Mode {
+            translate_along_line,
+            translate_along_plane,
+            // Also the uniform scale along a line.
+            scale_along_line,
+            // Also the uniform scale in a plane.
+            scale_along_plane,
+            orient_turn,
+            orient_trackball,
+        };
+
+        Mode mode;
+        f32 snap;
+        math::Vec3 origin;
+        math::Ray initial_ray;
+        // The axis of the line modes.
+        math::Vec3 axis;
+        // The axes of the plane modes.
+        math::Vec3 first_axis;
+        math::Vec3 second_axis;
+        // The plane the rays are intersected with. The line modes place the plane through the line facing the origin
+        // of the ray, which moves with the cursor for orthographic cameras, hence they calculate the plane again
+        // whenever the origin of the ray changes.
+        math::Vec3 plane_normal;
+        f32 plane_distance;
+        math::Vec3 plane_ray_origin;
+        bool has_plane;
+        // The hit of initial_ray with the plane. The manipulation has no effect if initial_ray misses the plane.
+        Optional<math::Vec3> initial_hit;
+        // The vectors whose dot products with a vector in the plane of the plane modes give its coordinates
+        // along first_axis and second_axis.
+        math::Vec3 first_dual;
+        math::Vec3 second_dual;
+        // The axes of the translate modes in the parent space of the object. parent_second_axis is 0 for the line mode.
+        math::Vec3 parent_first_axis;
+        math::Vec3 parent_second_axis;
+        // The initial position or scale.
+        math::Vec3 initial_vector;
+        // The part of a scale s that the scale modes change is
+        //     s * scaled_weight + dot(s, scaled_axis) * scaled_axis * scaled_axis_weight,
+        // i.e. the projection onto the local axis for the line modes, the projection onto the local plane
+        // for the plane modes and the whole scale for the uniform modes.
+        math::Vec3 scaled_axis;
+        f32 scaled_weight;
+        f32 scaled_axis_weight;
+        math::Quat initial_orientation;
+
+        Manipulation_Session(Mode mode, math::Vec3 origin, math::Ray initial_ray, f32 snap);
+
+        void set_plane(math::Vec3 plane_normal);
+        void set_line_plane(math::Vec3 ray_origin);
+        // Intersects ray with the plane of the manipulation. Returns null_optional if the manipulation has no effect.
+        [[nodiscard]] Optional<math::Vec3> intersect_plane(math::Ray const& ray);
+        // The snapped distances along the axes of the translate modes from the initial hit to hit.
+        [[nodiscard]] math::Vec2 calculate_translation_factors(math::Vec3 hit) const;
+    };
 } // namespace anton::gizmo
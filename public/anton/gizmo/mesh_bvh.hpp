@@ -0,0 +1,143 @@
+#pragma once
+
+#include <anton/array.hpp>
+#include <anton/gizmo/geometry.hpp>
+#include <anton/gizmo/picking.hpp>
+#include <anton/gizmo/prepared_handle.hpp>
+#include <anton/math/mat4.hpp>
+#include <anton/math/math.hpp>
+#include <anton/math/primitives.hpp>
+#include <anton/math/vec3.hpp>
+#include <anton/optional.hpp>
+#include <anton/slice.hpp>
+#include <anton/types.hpp>
+
+namespace anton::gizmo {
+    struct Mesh_Hit {
+        // Distance along ray's direction to the intersection point.
+        f32 distance;
+        // The index of the hit triangle in the order the triangles have been passed to Mesh_BVH::build.
+        i64 triangle;
+        // The weights of the 3 vertices of the hit triangle at the intersection point.
+        math::Vec3 barycentric_coordinates;
+    };
+
+    // Mesh_BVH
+    // A bounding volume hierarchy over the triangles of a mesh that finds the exact intersection of a ray with the mesh.
+    // The analytic intersection tests of the handles pick the shapes the meshes approximate, e.g. a thin shaft as a full
+    // cylinder. Picking the generated meshes, or custom meshes of handles, instead matches what is rendered exactly.
+    //
+    // The hierarchy stores its own copy of the triangles, so the geometry it has been built from may be freed.
+    // The triangles of the leaves are tested against a ray several at a time with SIMD instructions.
+    //
+    class Mesh_BVH {
+    public:
+        // build
+        // Builds the hierarchy over non-indexed geometry, e.g. the output of the generate_* functions, reusing the memory
+        // of the previous build.
+        //
+        // Parameters:
+        // vertices - the positions of the vertices.
+        // topology - how consecutive vertices form triangles. The triangle i of a strip consists of the vertices
+        //            i, i + 1 and i + 2.
+        //
+        void build(Slice<math::Vec3 const> vertices, Primitive_Topology topology = Primitive_Topology::triangle_list);
+
+        // build
+        // Builds the hierarchy over indexed geometry, e.g. the output of the generate_*_indexed functions or a user mesh.
+        // Every 3 consecutive indices form a triangle.
+        //
+        void build(Slice<math::Vec3 const> vertices, Slice<u32 const> indices);
+        void build(Indexed_Geometry const& geometry);
+
+        // intersect
+        // Finds the nearest intersection of a ray in the space of the mesh.
+        //
+        // Parameters:
+        //          ray - a ray in the space of the mesh.
+        // max_distance - hits not nearer along the ray than max_distance are ignored.
+        //
+        // Returns:
+        // The nearest hit or null_optional if the ray misses the mesh. The distance is measured in units of the length
+        // of ray's direction.
+        //
+        [[nodiscard]] Optional<Mesh_Hit> intersect(math::Ray const& ray, f32 max_distance = math::infinity) const;
+
+        // intersect
+        // Finds the nearest intersection of a world space ray with the mesh placed in the world by a prepared handle.
+        // The local space of the mesh is that of the handle geometry, e.g. the space of generate_arrow_3d_geometry
+        // for handles prepared with prepare_arrow_3d.
+        //
+        // Parameters:
+        //          ray - a world space ray to test against. The direction must be normalized.
+        //       handle - the prepared handle that places the mesh in the world.
+        // max_distance - hits not nearer along the ray than max_distance are ignored.
+        //
+        // Returns:
+        // The nearest hit with the world space distance or null_optional if the ray misses the mesh.
+        //
+        [[nodiscard]] Optional<Mesh_Hit> intersect(math::Ray const& ray, Prepared_Handle const& handle, f32 max_distance = math::infinity) const;
+
+        // get_bounds
+        // Returns the box enclosing all triangles of the mesh. Empty (min > max) if the mesh has no triangles.
+        //
+        void get_bounds(math::Vec3& min, math::Vec3& max) const;
+
+    private:
+        struct Node {
+            math::Vec3 min;
+            math::Vec3 max;
+            // For leaves the index of the first triangle group of the node.
+            // For inner nodes the index of the left child. The right child immediately follows the left child.
+            u32 first;
+            // The number of triangle groups of a leaf. 0 for inner nodes.
+            u32 count;
+        };
+
+        Array<Node> nodes;
+        // Groups of triangles tested together. Every group stores the first vertex and both edges of its triangles
+        // as 9 streams of the components, each stream as long as the SIMD lane count. Unused lanes hold
+        // degenerate triangles.
+        Array<f32> groups;
+        // The index of the triangle in every lane of every group. -1 for unused lanes.
+        Array<i64> triangle_indices;
+
+        struct Build_Triangle;
+
+        void build_hierarchy(Array<Build_Triangle>& triangles);
+        void build_node(Array<Build_Triangle>& triangles, i64 node, i64 first, i64 count);
+    };
+
+    // prepare_mesh
+    // Prepares a handle with a custom mesh for Mesh_BVH::intersect.
+    //
+    // Parameters:
+    //            mesh - the hierarchy built over the mesh of the handle.
+    // world_transform - a transform to the world space. The transform must consist of
+    //                   translation, rotation and uniform scale only.
+    //
+    [[nodiscard]] Prepared_Handle prepare_mesh(Mesh_BVH const& mesh, math::Mat4 const& world_transform);
+
+    // Gizmo_Meshes
+    // The meshes to pick the handles of a composite gizmo with, indexed by Gizmo_Handle. The meshes must be in the local
+    // spaces of the handles as laid out by prepare_gizmo, i.e. the geometry generated by the generate_* functions
+    // for the handles. Handles without a mesh (nullptr) are picked with their analytic tests.
+    //
+    struct Gizmo_Meshes {
+        Mesh_BVH const* handles[gizmo_handle_count] = {};
+    };
+
+    // pick_gizmo
+    // Finds the handle of the gizmo nearest along the ray picking the handles that have meshes exactly.
+    //
+    // Parameters:
+    //            ray - a world space ray to test against. The direction must be normalized.
+    //          gizmo - the prepared gizmo.
+    //         meshes - the meshes of the handles.
+    // base_handle_id - the handle id of Gizmo_Handle::axis_x.
+    //
+    // Returns:
+    // The nearest handle hit by the ray or null_optional if no handle has been hit.
+    //
+    [[nodiscard]] Optional<Gizmo_Pick> pick_gizmo(math::Ray const& ray, Prepared_Gizmo const& gizmo, Gizmo_Meshes const& meshes, u32 base_handle_id);
+} // namespace anton::gizmo
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <anton/gizmo/arrow_3d.hpp>
+#include <anton/gizmo/dial_3d.hpp>
+#include <anton/gizmo/gizmo_builder.hpp>
+#include <anton/gizmo/prepared_handle.hpp>
+#include <anton/math/mat4.hpp>
+#include <anton/math/primitives.hpp>
+#include <anton/math/vec3.hpp>
+#include <anton/optional.hpp>
+#include <anton/types.hpp>
+
+namespace anton::gizmo {
+    // Gizmo_Handle_Shape
+    // The bounding volume a handle of a composite gizmo is tested against.
+    //
+    enum class Gizmo_Handle_Shape : u8 {
+        // The gizmo does not have the handle.
+        none,
+        arrow_3d,
+        dial_3d,
+        square,
+        cube,
+        sphere,
+    };
+
+    // Prepared_Gizmo
+    // The handles of a composite gizmo prepared for pick_gizmo. The gizmo has to be prepared again whenever its
+    // transform changes.
+    //
+    struct Prepared_Gizmo {
+        // The shape and the prepared handle of every handle indexed by Gizmo_Handle.
+        Gizmo_Handle_Shape shapes[gizmo_handle_count];
+        Prepared_Handle handles[gizmo_handle_count];
+        // The parameters of the arrows or dials of the gizmo.
+        Arrow_3D arrow;
+        Dial_3D dial;
+        // A world space sphere enclosing the bounding spheres of all handles.
+        math::Vec3 bounding_center;
+        f32 bounding_radius;
+    };
+
+    struct Gizmo_Pick {
+        Gizmo_Handle handle;
+        // The base handle id passed to pick_gizmo plus the value of handle.
+        u32 handle_id;
+        // Distance along ray's direction to the intersection point.
+        f32 distance;
+    };
+
+    // prepare_gizmo
+    // Prepares the handles of a composite gizmo laid out like the geometry built by Gizmo_Builder.
+    //
+    // Parameters:
+    //           gizmo - parameter struct that defines the shape and size of the handles.
+    //                   Should be identical to that passed to Gizmo_Builder.
+    // gizmo_transform - a transform of the gizmo to the world space. The transform must consist of
+    //                   translation, rotation and uniform scale only.
+    //
+    [[nodiscard]] Prepared_Gizmo prepare_gizmo(Translate_Gizmo const& gizmo, math::Mat4 const& gizmo_transform);
+    [[nodiscard]] Prepared_Gizmo prepare_gizmo(Rotate_Gizmo const& gizmo, math::Mat4 const& gizmo_transform);
+    [[nodiscard]] Prepared_Gizmo prepare_gizmo(Scale_Gizmo const& gizmo, math::Mat4 const& gizmo_transform);
+
+    // intersect_gizmo_handle
+    // Performs the intersection test of a single handle of a prepared gizmo.
+    //
+    // Returns:
+    // Distance along ray's direction to the intersection point or null_optional if no intersection occured
+    // or the gizmo does not have the handle.
+    //
+    [[nodiscard]] Optional<f32> intersect_gizmo_handle(math::Ray const& ray, Prepared_Gizmo const& gizmo, Gizmo_Handle handle);
+
+    // pick_gizmo
+    // Finds the handle of the gizmo nearest along the ray. The ray is first tested against the bounding sphere
+    // of the whole gizmo and then against the bounding spheres of the handles. The handles are tested in the order
+    // of their bounding spheres along the ray until the nearest hit is closer than the next bounding sphere.
+    //
+    // Parameters:
+    //            ray - a world space ray to test against. The direction must be normalized.
+    //          gizmo - the prepared gizmo.
+    // base_handle_id - the handle id of Gizmo_Handle::axis_x.
+    //
+    // Returns:
+    // The nearest handle hit by the ray or null_optional if no handle has been hit.
+    //
+    [[nodiscard]] Optional<Gizmo_Pick> pick_gizmo(math::Ray const& ray, Prepared_Gizmo const& gizmo, u32 base_handle_id);
+
+    // pick_gizmo
+    // Prepares the gizmo and finds the handle nearest along the ray. Prefer preparing the gizmo once
+    // per transform change when picking repeatedly.
+    //
+    [[nodiscard]] Optional<Gizmo_Pick> pick_gizmo(math::Ray const& ray, Translate_Gizmo const& gizmo, math::Mat4 const& gizmo_transform, u32 base_handle_id);
+    [[nodiscard]] Optional<Gizmo_Pick> pick_gizmo(math::Ray const& ray, Rotate_Gizmo const& gizmo, math::Mat4 const& gizmo_transform, u32 base_handle_id);
+    [[nodiscard]] Optional<Gizmo_Pick> pick_gizmo(math::Ray const& ray, Scale_Gizmo const& gizmo, math::Mat4 const& gizmo_transform, u32 base_handle_id);
+} // namespace anton::gizmo
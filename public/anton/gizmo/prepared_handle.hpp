@@ -0,0 +1,42 @@
+#pragma once
+
+#include <anton/math/mat4.hpp>
+#include <anton/math/vec3.hpp>
+#include <anton/types.hpp>
+
+namespace anton::gizmo {
+    // Prepared_Handle
+    // The values derived from the world transform of a handle that the intersection tests need. Preparing a handle
+    // once whenever its transform changes and passing it to the prepared overloads of the intersect functions avoids
+    // recomputing them on every test. The transform must consist of translation, rotation and uniform scale only.
+    //
+    // Prepared handles are created with the prepare function of the shape (prepare_arrow_3d, prepare_circle, ...).
+    //
+    struct Prepared_Handle {
+        // The world space position of the local (0, 0, 0).
+        math::Vec3 origin;
+        // The normalized world space directions of the local +x, +y and -z axes.
+        // z_axis is the direction of arrows and the normal of circles, squares and dials.
+        math::Vec3 x_axis;
+        math::Vec3 y_axis;
+        math::Vec3 z_axis;
+        // The uniform scale of the transform.
+        f32 scale;
+        // The distance of the plane through origin with normal z_axis from the world origin along z_axis.
+        f32 plane_distance;
+        // A world space sphere enclosing the bounding volumes of the handle.
+        math::Vec3 bounding_center;
+        f32 bounding_radius;
+    };
+
+    // prepare_handle
+    // Prepares a handle of an arbitrary shape.
+    //
+    // Parameters:
+    //       world_transform - a transform to the world space. The transform must consist of
+    //                         translation, rotation and uniform scale only.
+    // local_bounding_center - the center of a sphere enclosing the handle before being transformed.
+    // local_bounding_radius - the radius of a sphere enclosing the handle before being transformed.
+    //
+    [[nodiscard]] Prepared_Handle prepare_handle(math::Mat4 const& world_transform, math::Vec3 local_bounding_center, f32 local_bounding_radius);
+} // namespace anton::gizmo
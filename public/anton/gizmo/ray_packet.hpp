@@ -0,0 +1,50 @@
+#pragma once
+
+#include <anton/math/primitives.hpp>
+#include <anton/slice.hpp>
+#include <anton/types.hpp>
+
+namespace anton::gizmo {
+    // The maximum number of rays in a Ray_Packet.
+    constexpr i64 max_ray_packet_size = 16;
+
+    // Ray_Packet
+    // A group of coherent rays, e.g. the rays through the samples of a fat cursor or of the contact area of a pen or a touch,
+    // that are tested against a handle together. The packet overloads of the intersect functions prepare the handle once
+    // for the whole packet and test several rays at a time. Packets of 4, 8 or 16 rays use every lane of the vector
+    // instructions.
+    //
+    // The rays are stored as separate arrays of components. The elements past count repeat the last ray.
+    //
+    struct Ray_Packet {
+        i64 count;
+        f32 origin_x[max_ray_packet_size];
+        f32 origin_y[max_ray_packet_size];
+        f32 origin_z[max_ray_packet_size];
+        f32 direction_x[max_ray_packet_size];
+        f32 direction_y[max_ray_packet_size];
+        f32 direction_z[max_ray_packet_size];
+    };
+
+    // Ray_Packet_Hits
+    // The results of the intersection test of a Ray_Packet.
+    //
+    struct Ray_Packet_Hits {
+        // The distance along each ray of the packet to the intersection point or infinity if the ray missed.
+        // The elements past the count of the packet are infinity.
+        f32 distances[max_ray_packet_size];
+        // The index of the ray with the nearest intersection point or -1 if no ray hit.
+        i64 nearest_ray;
+        // The distance along the ray nearest_ray to its intersection point or infinity if no ray hit.
+        f32 nearest_distance;
+    };
+
+    // make_ray_packet
+    // Packs rays into a Ray_Packet.
+    //
+    // Parameters:
+    // rays - world space rays with normalized directions. Only the first max_ray_packet_size rays are packed,
+    //        the rest are ignored. Split larger sets of rays into several packets.
+    //
+    [[nodiscard]] Ray_Packet make_ray_packet(Slice<math::Ray const> rays);
+} // namespace anton::gizmo
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <anton/gizmo/gizmo_builder.hpp>
+#include <anton/gizmo/picking.hpp>
+#include <anton/math/mat4.hpp>
+#include <anton/math/vec2.hpp>
+#include <anton/optional.hpp>
+#include <anton/types.hpp>
+
+namespace anton::gizmo {
+    // Projected_Handle_Shape
+    // The skeleton of a handle projected onto the screen.
+    //
+    enum class Projected_Handle_Shape : u8 {
+        // The gizmo does not have the handle or the handle is not in front of the camera.
+        none,
+        // The axis of an arrow from its origin to its tip.
+        segment,
+        // The circle of a dial.
+        ellipse,
+        // A square. The inside of the quad is part of the handle.
+        quad,
+        // The outline of the sphere of a center handle. The inside of the ellipse is part of the handle.
+        filled_ellipse,
+    };
+
+    struct Projected_Handle {
+        Projected_Handle_Shape shape;
+        // segment - the endpoints in points[0] and points[1].
+        // quad - the corners in order around the quad.
+        // ellipse, filled_ellipse - the center in points[0].
+        math::Vec2 points[4];
+        // The normalized direction of the major axis of an ellipse.
+        math::Vec2 major_axis;
+        // The semi-axes of an ellipse in pixels. minor_radius is 0 for a circle seen edge-on.
+        f32 major_radius;
+        f32 minor_radius;
+    };
+
+    // Projected_Gizmo
+    // The handles of a composite gizmo projected onto the screen by project_gizmo. Projecting the gizmo once per frame
+    // and reusing it for every cursor query of the frame avoids casting rays against the handles.
+    //
+    struct Projected_Gizmo {
+        // The projected handles indexed by Gizmo_Handle.
+        Projected_Handle handles[gizmo_handle_count];
+        // The rectangle enclosing all projected handles. Empty (min > max) if no handle is projected.
+        math::Vec2 bounds_min;
+        math::Vec2 bounds_max;
+    };
+
+    struct Gizmo_Screen_Pick {
+        Gizmo_Handle handle;
+        // The base handle id passed to pick_projected_gizmo plus the value of handle.
+        u32 handle_id;
+        // The distance in pixels from the cursor to the skeleton of the handle. 0 inside quads and filled ellipses.
+        f32 pixel_distance;
+    };
+
+    // project_gizmo
+    // Projects the skeletons of the handles of a prepared gizmo onto the screen. The skeleton of an arrow is the segment
+    // from its origin to its tip, of a dial its circle, of a square the square and of a center handle the outline
+    // of its sphere (of the sphere inscribed in the cube for cubes).
+    //
+    // Segments are clipped to the part in front of the camera. Dials, squares and center handles that are not entirely
+    // in front of the camera are not projected and cannot be picked.
+    //
+    // Parameters:
+    //           gizmo - the prepared gizmo.
+    // view_projection - transform from the world space to the clip space.
+    //   viewport_size - the size of the viewport in pixels.
+    //
+    // Returns:
+    // The handles in pixels relative to the top-left corner of the viewport with y pointing down.
+    //
+    [[nodiscard]] Projected_Gizmo project_gizmo(Prepared_Gizmo const& gizmo, math::Mat4 const& view_projection, math::Vec2 viewport_size);
+
+    // project_gizmo
+    // Prepares the gizmo and projects its handles onto the screen.
+    //
+    [[nodiscard]] Projected_Gizmo project_gizmo(Translate_Gizmo const& gizmo, math::Mat4 const& gizmo_transform, math::Mat4 const& view_projection,
+                                                math::Vec2 viewport_size);
+    [[nodiscard]] Projected_Gizmo project_gizmo(Rotate_Gizmo const& gizmo, math::Mat4 const& gizmo_transform, math::Mat4 const& view_projection,
+                                                math::Vec2 viewport_size);
+    [[nodiscard]] Projected_Gizmo project_gizmo(Scale_Gizmo const& gizmo, math::Mat4 const& gizmo_transform, math::Mat4 const& view_projection,
+                                                math::Vec2 viewport_size);
+
+    // pick_projected_gizmo
+    // Finds the handle whose skeleton is nearest to the cursor on the screen. Arrows and dials take precedence over
+    // squares and center handles, whose insides would otherwise hide the arrows and dials drawn over them.
+    //
+    // Parameters:
+    //          cursor - the position of the cursor in pixels relative to the top-left corner of the viewport.
+    //           gizmo - the projected gizmo.
+    // pixel_tolerance - the largest distance in pixels from the cursor to the skeleton of a picked handle.
+    //  base_handle_id - the handle id of Gizmo_Handle::axis_x.
+    //
+    // Returns:
+    // The nearest handle within pixel_tolerance of the cursor or null_optional if there is none.
+    //
+    [[nodiscard]] Optional<Gizmo_Screen_Pick> pick_projected_gizmo(math::Vec2 cursor, Projected_Gizmo const& gizmo, f32 pixel_tolerance,
+                                                                   u32 base_handle_id);
+} // namespace anton::gizmo
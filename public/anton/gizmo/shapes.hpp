@@ -1,10 +1,15 @@
 #pragma once
 
 #include <anton/array.hpp>
+#include <anton/gizmo/geometry.hpp>
+#include <anton/gizmo/prepared_handle.hpp>
+#include <anton/gizmo/ray_packet.hpp>
+#include <anton/gizmo/task_executor.hpp>
 #include <anton/math/mat4.hpp>
 #include <anton/math/primitives.hpp>
 #include <anton/math/vec3.hpp>
 #include <anton/optional.hpp>
+#include <anton/slice.hpp>
 #include <anton/types.hpp>
 
 namespace anton::gizmo {
@@ -19,6 +24,42 @@ namespace anton::gizmo {
     //
     [[nodiscard]] Array<math::Vec3> generate_filled_circle(i32 vertex_count);
 
+    // filled_circle_vertex_count
+    // Calculates the number of vertices generated by generate_filled_circle.
+    //
+    [[nodiscard]] i64 filled_circle_vertex_count(i32 vertex_count);
+
+    // generate_filled_circle
+    // Generates a filled circle into a caller-provided buffer without allocating memory.
+    //
+    // Parameters:
+    // vertex_count - the number of vertices that the circle will consist of.
+    //     vertices - the buffer to write the triangle list to. Must have at least filled_circle_vertex_count(vertex_count) elements.
+    //
+    void generate_filled_circle(i32 vertex_count, Slice<math::Vec3> vertices);
+
+    // generate_filled_circle
+    // Generates a filled circle into a caller-provided interleaved vertex buffer in a single pass.
+    //
+    // Parameters:
+    // vertex_count - the number of vertices that the circle will consist of.
+    //       layout - the layout of the vertices in buffer.
+    //    handle_id - the value of the handle id attribute of every vertex.
+    //       buffer - the buffer to write the triangle list to. Must have at least filled_circle_vertex_count(vertex_count) * layout.stride bytes.
+    //
+    // Returns:
+    // The dequantization of the positions written to buffer.
+    //
+    Position_Dequantization generate_filled_circle(i32 vertex_count, Vertex_Layout const& layout, u32 handle_id, Slice<u8> buffer);
+
+    // generate_filled_circle_indexed
+    // Generates the same geometry as generate_filled_circle, but with each distinct vertex stored only once.
+    //
+    // Returns:
+    // Vertices of the circle and a list of indices of the triangles in CCW order when looking at the circle in the direction of +z.
+    //
+    [[nodiscard]] Indexed_Geometry generate_filled_circle_indexed(i32 vertex_count);
+
     // generate_square
     // Generates a square centered at (0, 0, 0) with normal along -z.
     // The edges are of length 1.0 and are aligned with the x and y axes.
@@ -28,6 +69,40 @@ namespace anton::gizmo {
     //
     [[nodiscard]] Array<math::Vec3> generate_square();
 
+    // square_vertex_count
+    // Calculates the number of vertices generated by generate_square.
+    //
+    [[nodiscard]] i64 square_vertex_count();
+
+    // generate_square
+    // Generates a square into a caller-provided buffer without allocating memory.
+    //
+    // Parameters:
+    // vertices - the buffer to write the triangle list to. Must have at least square_vertex_count() elements.
+    //
+    void generate_square(Slice<math::Vec3> vertices);
+
+    // generate_square
+    // Generates a square into a caller-provided interleaved vertex buffer in a single pass.
+    //
+    // Parameters:
+    //    layout - the layout of the vertices in buffer.
+    // handle_id - the value of the handle id attribute of every vertex.
+    //    buffer - the buffer to write the triangle list to. Must have at least square_vertex_count() * layout.stride bytes.
+    //
+    // Returns:
+    // The dequantization of the positions written to buffer.
+    //
+    Position_Dequantization generate_square(Vertex_Layout const& layout, u32 handle_id, Slice<u8> buffer);
+
+    // generate_square_indexed
+    // Generates the same geometry as generate_square, but with each distinct vertex stored only once.
+    //
+    // Returns:
+    // Vertices of the square and a list of indices of the triangles in CCW order when looking at the square in the direction of +z.
+    //
+    [[nodiscard]] Indexed_Geometry generate_square_indexed();
+
     // generate_cube
     // Generates a cube centered at (0, 0, 0). The edges are of length 1.0
     // and are aligned with the x, y and z axes.
@@ -37,17 +112,101 @@ namespace anton::gizmo {
     //
     [[nodiscard]] Array<math::Vec3> generate_cube();
 
+    // cube_vertex_count
+    // Calculates the number of vertices generated by generate_cube.
+    //
+    [[nodiscard]] i64 cube_vertex_count();
+
+    // generate_cube
+    // Generates a cube into a caller-provided buffer without allocating memory.
+    //
+    // Parameters:
+    // vertices - the buffer to write the triangle list to. Must have at least cube_vertex_count() elements.
+    //
+    void generate_cube(Slice<math::Vec3> vertices);
+
+    // generate_cube
+    // Generates a cube into a caller-provided interleaved vertex buffer in a single pass.
+    //
+    // Parameters:
+    //    layout - the layout of the vertices in buffer.
+    // handle_id - the value of the handle id attribute of every vertex.
+    //    buffer - the buffer to write the triangle list to. Must have at least cube_vertex_count() * layout.stride bytes.
+    //
+    // Returns:
+    // The dequantization of the positions written to buffer.
+    //
+    Position_Dequantization generate_cube(Vertex_Layout const& layout, u32 handle_id, Slice<u8> buffer);
+
+    // generate_cube_indexed
+    // Generates the same geometry as generate_cube, but with each distinct vertex stored only once.
+    //
+    // Returns:
+    // Vertices of the cube and a list of indices of the triangles in CCW order when looking at the cube from outside.
+    //
+    [[nodiscard]] Indexed_Geometry generate_cube_indexed();
+
     // generate_icosphere
     // Generates an icosphere centered at (0, 0, 0) with radius 1.0.
+    // If executor is provided, the icosphere is built with shared vertices (see generate_icosphere_indexed)
+    // and expanded to a triangle list in parallel.
     //
     // Parameters:
     // subdivision_level - the level of subdivision of the icosphere. Each level increases detail
     //                     and smoothness at the expense of quadrupling the triangle count.
+    //          executor - used to split the work of each subdivision level into tasks.
+    //                     If nullptr, all work is done on the calling thread.
     //
     // Returns:
     // An array containing a triangle list in CCW order when looking at the icosphere from outside.
     //
-    [[nodiscard]] Array<math::Vec3> generate_icosphere(i64 subdivision_level);
+    [[nodiscard]] Array<math::Vec3> generate_icosphere(i64 subdivision_level, Task_Executor* executor = nullptr);
+
+    // icosphere_vertex_count
+    // Calculates the number of vertices generated by generate_icosphere.
+    //
+    [[nodiscard]] i64 icosphere_vertex_count(i64 subdivision_level);
+
+    // generate_icosphere
+    // Generates an icosphere into a caller-provided buffer without allocating memory.
+    //
+    // Parameters:
+    // subdivision_level - the level of subdivision of the icosphere.
+    //          vertices - the buffer to write the triangle list to. Must have at least icosphere_vertex_count(subdivision_level) elements.
+    //
+    void generate_icosphere(i64 subdivision_level, Slice<math::Vec3> vertices);
+
+    // generate_icosphere
+    // Generates an icosphere into a caller-provided interleaved vertex buffer in a single pass.
+    //
+    // Parameters:
+    // subdivision_level - the level of subdivision of the icosphere.
+    //            layout - the layout of the vertices in buffer.
+    //         handle_id - the value of the handle id attribute of every vertex.
+    //            buffer - the buffer to write the triangle list to.
+    //                     Must have at least icosphere_vertex_count(subdivision_level) * layout.stride bytes.
+    //
+    // Returns:
+    // The dequantization of the positions written to buffer.
+    //
+    Position_Dequantization generate_icosphere(i64 subdivision_level, Vertex_Layout const& layout, u32 handle_id, Slice<u8> buffer);
+
+    // generate_icosphere_indexed
+    // Generates the same geometry as generate_icosphere, but with each distinct vertex stored only once.
+    // Vertices shared by neighbouring triangles (including the edge midpoints created during subdivision)
+    // are computed once and referenced by index. Within a level the edges and the faces are subdivided
+    // independently of each other, so the work may be split across threads by executor.
+    //
+    // Parameters:
+    // subdivision_level - the level of subdivision of the icosphere. Each level increases detail
+    //                     and smoothness at the expense of quadrupling the triangle count.
+    //          executor - used to split the work of each subdivision level into tasks.
+    //                     If nullptr, all work is done on the calling thread.
+    //
+    // Returns:
+    // Vertices of the icosphere and a list of indices of the triangles in CCW order when looking at the icosphere from outside.
+    //
+    [[nodiscard]] Indexed_Geometry generate_icosphere_indexed(i64 subdivision_level, Task_Executor* executor = nullptr);
 
     // intersect_circle
     // Perform an intersection test of a ray against a circle.
@@ -64,6 +223,28 @@ namespace anton::gizmo {
     //
     [[nodiscard]] Optional<f32> intersect_circle(math::Ray const& ray, math::Mat4 const& world_transform);
 
+    // prepare_circle
+    // Prepares a circle for intersect_circle.
+    //
+    // Parameters:
+    // world_transform - a transform to the world space. The transform must consist of
+    //                   translation, rotation and uniform scale only.
+    //
+    [[nodiscard]] Prepared_Handle prepare_circle(math::Mat4 const& world_transform);
+
+    // intersect_circle
+    // Perform an intersection test of a ray against a circle prepared with prepare_circle.
+    //
+    [[nodiscard]] Optional<f32> intersect_circle(math::Ray const& ray, Prepared_Handle const& handle);
+
+    // intersect_circle
+    // Perform an intersection test of every ray of a packet against a circle prepared with prepare_circle.
+    //
+    // Returns:
+    // The distances along the rays to the intersection points and the nearest hit of the packet.
+    //
+    [[nodiscard]] Ray_Packet_Hits intersect_circle(Ray_Packet const& packet, Prepared_Handle const& handle);
+
     // intersect_square
     // Perform an intersection test of a ray against a square.
     // Before being transformed using world_transform, the square is centered at (0, 0, 0)
@@ -79,6 +260,28 @@ namespace anton::gizmo {
     //
     [[nodiscard]] Optional<f32> intersect_square(math::Ray const& ray, math::Mat4 const& world_transform);
 
+    // prepare_square
+    // Prepares a square for intersect_square.
+    //
+    // Parameters:
+    // world_transform - a transform to the world space. The transform must consist of
+    //                   translation, rotation and uniform scale only.
+    //
+    [[nodiscard]] Prepared_Handle prepare_square(math::Mat4 const& world_transform);
+
+    // intersect_square
+    // Perform an intersection test of a ray against a square prepared with prepare_square.
+    //
+    [[nodiscard]] Optional<f32> intersect_square(math::Ray const& ray, Prepared_Handle const& handle);
+
+    // intersect_square
+    // Perform an intersection test of every ray of a packet against a square prepared with prepare_square.
+    //
+    // Returns:
+    // The distances along the rays to the intersection points and the nearest hit of the packet.
+    //
+    [[nodiscard]] Ray_Packet_Hits intersect_square(Ray_Packet const& packet, Prepared_Handle const& handle);
+
     // intersect_cube
     // Perform an intersection test of a ray against a cube.
     // The cube's center is located at (0, 0, 0) and is aligned with the axes before
@@ -93,6 +296,28 @@ namespace anton::gizmo {
     //
     [[nodiscard]] Optional<f32> intersect_cube(math::Ray const& ray, math::Mat4 const& world_transform);
 
+    // prepare_cube
+    // Prepares a cube for intersect_cube.
+    //
+    // Parameters:
+    // world_transform - a transform to the world space. The transform must consist of
+    //                   translation, rotation and uniform scale only.
+    //
+    [[nodiscard]] Prepared_Handle prepare_cube(math::Mat4 const& world_transform);
+
+    // intersect_cube
+    // Perform an intersection test of a ray against a cube prepared with prepare_cube.
+    //
+    [[nodiscard]] Optional<f32> intersect_cube(math::Ray const& ray, Prepared_Handle const& handle);
+
+    // intersect_cube
+    // Perform an intersection test of every ray of a packet against a cube prepared with prepare_cube.
+    //
+    // Returns:
+    // The distances along the rays to the intersection points and the nearest hit of the packet.
+    //
+    [[nodiscard]] Ray_Packet_Hits intersect_cube(Ray_Packet const& packet, Prepared_Handle const& handle);
+
     // intersect_sphere
     // Perform an intersection test of a ray against a sphere.
     // The sphere's center is located at (0, 0, 0) and has radius 1.0
@@ -107,4 +332,26 @@ namespace anton::gizmo {
     // Distance along ray's direction to the intersection point or null_optional if no intersection occured.
     //
     [[nodiscard]] Optional<f32> intersect_sphere(math::Ray const& ray, math::Mat4 const& world_transform);
+
+    // prepare_sphere
+    // Prepares a sphere for intersect_sphere.
+    //
+    // Parameters:
+    // world_transform - a transform to the world space. The transform must consist of
+    //                   translation, rotation and uniform scale only.
+    //
+    [[nodiscard]] Prepared_Handle prepare_sphere(math::Mat4 const& world_transform);
+
+    // intersect_sphere
+    // Perform an intersection test of a ray against a sphere prepared with prepare_sphere.
+    //
+    [[nodiscard]] Optional<f32> intersect_sphere(math::Ray const& ray, Prepared_Handle const& handle);
+
+    // intersect_sphere
+    // Perform an intersection test of every ray of a packet against a sphere prepared with prepare_sphere.
+    //
+    // Returns:
+    // The distances along the rays to the intersection points and the nearest hit of the packet.
+    //
+    [[nodiscard]] Ray_Packet_Hits intersect_sphere(Ray_Packet const& packet, Prepared_Handle const& handle);
 } // namespace anton::gizmo
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <anton/types.hpp>
+
+namespace anton::gizmo {
+    // Task_Executor
+    // Interface through which the library splits expensive work into independent tasks.
+    // Implement it on top of the job system or thread pool of the application to run the tasks in parallel.
+    //
+    class Task_Executor {
+    public:
+        virtual ~Task_Executor() = default;
+
+        // execute
+        // Invokes task(data, index) for every index in [0, task_count). The invocations may run concurrently
+        // and in any order. Must not return until all invocations have completed.
+        //
+        virtual void execute(i64 task_count, void (*task)(void* data, i64 index), void* data) = 0;
+    };
+} // namespace anton::gizmo
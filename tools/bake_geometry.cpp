@@ -0,0 +1,270 @@
+// anton_gizmo_bake
+// Generates gizmo geometry and writes it to a baked geometry file loaded with Baked_Geometry_File.
+//
+// Usage:
+//   anton_gizmo_bake [options] <output> <shape>...
+//
+// Shapes:
+//   arrow cone|cube <cap_size> <cap_length> <shaft_length> <shaft_diameter> <vertex_count>
+//   dial <major_radius> <minor_radius> <vertex_count_major> <vertex_count_minor>
+//   icosphere <subdivision_level>
+//
+// Every shape is stored as a triangle list. Options add further representations of every shape:
+//   --indexed                                         indexed geometry.
+//   --layout <position> <normal> <handle_id> <value>  an interleaved vertex buffer with the layout created by
+//                                                     make_vertex_layout and the handle id attribute set to value.
+//                                                     position is one of f32x3, f16x4, snorm16x4, snorm10x3_2,
+//                                                     normal is one of none, f32x3, f16x4, snorm16x4,
+//                                                     handle_id is one of none, u8, u16, u32.
+
+#include <anton/gizmo/arrow_3d.hpp>
+#include <anton/gizmo/baked_geometry.hpp>
+#include <anton/gizmo/dial_3d.hpp>
+#include <anton/gizmo/shapes.hpp>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace anton;
+using namespace anton::gizmo;
+
+struct Options {
+    bool indexed = false;
+    bool interleaved = false;
+    Vertex_Layout layout;
+    u32 handle_id = 0;
+};
+
+static bool parse_position_format(char const* const string, Position_Format& format) {
+    if(strcmp(string, "f32x3") == 0) {
+        format = Position_Format::f32x3;
+    } else if(strcmp(string, "f16x4") == 0) {
+        format = Position_Format::f16x4;
+    } else if(strcmp(string, "snorm16x4") == 0) {
+        format = Position_Format::snorm16x4;
+    } else if(strcmp(string, "snorm10x3_2") == 0) {
+        format = Position_Format::snorm10x3_2;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static bool parse_normal_format(char const* const string, Normal_Format& format) {
+    if(strcmp(string, "none") == 0) {
+        format = Normal_Format::none;
+    } else if(strcmp(string, "f32x3") == 0) {
+        format = Normal_Format::f32x3;
+    } else if(strcmp(string, "f16x4") == 0) {
+        format = Normal_Format::f16x4;
+    } else if(strcmp(string, "snorm16x4") == 0) {
+        format = Normal_Format::snorm16x4;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static bool parse_handle_id_format(char const* const string, Handle_ID_Format& format) {
+    if(strcmp(string, "none") == 0) {
+        format = Handle_ID_Format::none;
+    } else if(strcmp(string, "u8") == 0) {
+        format = Handle_ID_Format::u8;
+    } else if(strcmp(string, "u16") == 0) {
+        format = Handle_ID_Format::u16;
+    } else if(strcmp(string, "u32") == 0) {
+        format = Handle_ID_Format::u32;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static bool parse_f32(char const* const string, f32& value) {
+    char* end;
+    value = strtof(string, &end);
+    return end != string && *end == '\0';
+}
+
+static bool parse_i64(char const* const string, i64& value) {
+    char* end;
+    value = strtoll(string, &end, 10);
+    return end != string && *end == '\0';
+}
+
+static bool parse_i32(char const* const string, i32& value) {
+    i64 result;
+    if(!parse_i64(string, result) || result < -2147483647 - 1 || result > 2147483647) {
+        return false;
+    }
+
+    value = static_cast<i32>(result);
+    return true;
+}
+
+static void print_usage() {
+    fprintf(stderr, "usage: anton_gizmo_bake [--indexed] [--layout <position> <normal> <handle_id> <value>] <output> <shape>...\n"
+                    "shapes:\n"
+                    "  arrow cone|cube <cap_size> <cap_length> <shaft_length> <shaft_diameter> <vertex_count>\n"
+                    "  dial <major_radius> <minor_radius> <vertex_count_major> <vertex_count_minor>\n"
+                    "  icosphere <subdivision_level>\n");
+}
+
+static Slice<math::Vec3 const> make_slice(Array<math::Vec3> const& vertices) {
+    return Slice<math::Vec3 const>{vertices.data(), vertices.data() + vertices.size()};
+}
+
+static Slice<u8 const> make_slice(Array<u8> const& bytes) {
+    return Slice<u8 const>{bytes.data(), bytes.data() + bytes.size()};
+}
+
+struct Arrow_Parameters {
+    Arrow_3D arrow;
+    i32 vertex_count;
+};
+
+struct Dial_Parameters {
+    Dial_3D dial;
+    i32 vertex_count_major;
+    i32 vertex_count_minor;
+};
+
+static void bake_arrow(Baked_Geometry_Writer& writer, Options const& options, Arrow_Parameters const& parameters) {
+    Geometry_Key const key = make_arrow_3d_key(parameters.arrow, parameters.vertex_count);
+    writer.add_triangle_list(key, make_slice(generate_arrow_3d_geometry(parameters.arrow, parameters.vertex_count)));
+    if(options.indexed) {
+        writer.add_indexed(key, generate_arrow_3d_geometry_indexed(parameters.arrow, parameters.vertex_count));
+    }
+
+    if(options.interleaved) {
+        Array<u8> buffer(arrow_3d_vertex_count(parameters.arrow, parameters.vertex_count) * options.layout.stride);
+        Position_Dequantization const dequantization =
+            generate_arrow_3d_geometry(parameters.arrow, parameters.vertex_count, options.layout, options.handle_id, buffer);
+        writer.add_interleaved(key, options.layout, options.handle_id, dequantization, make_slice(buffer));
+    }
+}
+
+static void bake_dial(Baked_Geometry_Writer& writer, Options const& options, Dial_Parameters const& parameters) {
+    Geometry_Key const key = make_dial_3d_key(parameters.dial, parameters.vertex_count_major, parameters.vertex_count_minor);
+    writer.add_triangle_list(key, make_slice(generate_dial_3d_geometry(parameters.dial, parameters.vertex_count_major, parameters.vertex_count_minor)));
+    if(options.indexed) {
+        writer.add_indexed(key, generate_dial_3d_geometry_indexed(parameters.dial, parameters.vertex_count_major, parameters.vertex_count_minor));
+    }
+
+    if(options.interleaved) {
+        Array<u8> buffer(dial_3d_vertex_count(parameters.vertex_count_major, parameters.vertex_count_minor) * options.layout.stride);
+        Position_Dequantization const dequantization = generate_dial_3d_geometry(parameters.dial, parameters.vertex_count_major, parameters.vertex_count_minor,
+                                                                                 options.layout, options.handle_id, buffer);
+        writer.add_interleaved(key, options.layout, options.handle_id, dequantization, make_slice(buffer));
+    }
+}
+
+static void bake_icosphere(Baked_Geometry_Writer& writer, Options const& options, i64 const subdivision_level) {
+    Geometry_Key const key = make_icosphere_key(subdivision_level);
+    writer.add_triangle_list(key, make_slice(generate_icosphere(subdivision_level)));
+    if(options.indexed) {
+        writer.add_indexed(key, generate_icosphere_indexed(subdivision_level));
+    }
+
+    if(options.interleaved) {
+        Array<u8> buffer(icosphere_vertex_count(subdivision_level) * options.layout.stride);
+        Position_Dequantization const dequantization = generate_icosphere(subdivision_level, options.layout, options.handle_id, buffer);
+        writer.add_interleaved(key, options.layout, options.handle_id, dequantization, make_slice(buffer));
+    }
+}
+
+int main(int const argc, char** const argv) {
+    Options options;
+    int arg = 1;
+    while(arg < argc && strncmp(argv[arg], "--", 2) == 0) {
+        if(strcmp(argv[arg], "--indexed") == 0) {
+            options.indexed = true;
+            arg += 1;
+        } else if(strcmp(argv[arg], "--layout") == 0 && arg + 4 < argc) {
+            Position_Format position_format;
+            Normal_Format normal_format;
+            Handle_ID_Format handle_id_format;
+            i64 handle_id;
+            if(!parse_position_format(argv[arg + 1], position_format) || !parse_normal_format(argv[arg + 2], normal_format) ||
+               !parse_handle_id_format(argv[arg + 3], handle_id_format) || !parse_i64(argv[arg + 4], handle_id)) {
+                fprintf(stderr, "error: invalid --layout\n");
+                return 1;
+            }
+
+            options.interleaved = true;
+            options.layout = make_vertex_layout(position_format, normal_format, handle_id_format);
+            options.handle_id = static_cast<u32>(handle_id);
+            arg += 5;
+        } else {
+            print_usage();
+            return 1;
+        }
+    }
+
+    if(arg + 1 >= argc) {
+        print_usage();
+        return 1;
+    }
+
+    char const* const output = argv[arg];
+    arg += 1;
+    Baked_Geometry_Writer writer;
+    while(arg < argc) {
+        char const* const shape = argv[arg];
+        if(strcmp(shape, "arrow") == 0 && arg + 6 < argc) {
+            Arrow_Parameters parameters;
+            char const* const style = argv[arg + 1];
+            bool valid = true;
+            if(strcmp(style, "cone") == 0) {
+                parameters.arrow.draw_style = Arrow_3D_Style::cone;
+            } else if(strcmp(style, "cube") == 0) {
+                parameters.arrow.draw_style = Arrow_3D_Style::cube;
+            } else {
+                valid = false;
+            }
+
+            valid = valid && parse_f32(argv[arg + 2], parameters.arrow.cap_size) && parse_f32(argv[arg + 3], parameters.arrow.cap_length) &&
+                    parse_f32(argv[arg + 4], parameters.arrow.shaft_length) && parse_f32(argv[arg + 5], parameters.arrow.shaft_diameter) &&
+                    parse_i32(argv[arg + 6], parameters.vertex_count) && parameters.vertex_count >= 3;
+            if(!valid) {
+                fprintf(stderr, "error: invalid arrow parameters\n");
+                return 1;
+            }
+
+            bake_arrow(writer, options, parameters);
+            arg += 7;
+        } else if(strcmp(shape, "dial") == 0 && arg + 4 < argc) {
+            Dial_Parameters parameters;
+            bool const valid = parse_f32(argv[arg + 1], parameters.dial.major_radius) && parse_f32(argv[arg + 2], parameters.dial.minor_radius) &&
+                               parse_i32(argv[arg + 3], parameters.vertex_count_major) && parse_i32(argv[arg + 4], parameters.vertex_count_minor) &&
+                               parameters.vertex_count_major >= 3 && parameters.vertex_count_minor >= 3;
+            if(!valid) {
+                fprintf(stderr, "error: invalid dial parameters\n");
+                return 1;
+            }
+
+            bake_dial(writer, options, parameters);
+            arg += 5;
+        } else if(strcmp(shape, "icosphere") == 0 && arg + 1 < argc) {
+            i64 subdivision_level;
+            if(!parse_i64(argv[arg + 1], subdivision_level) || subdivision_level < 0) {
+                fprintf(stderr, "error: invalid icosphere parameters\n");
+                return 1;
+            }
+
+            bake_icosphere(writer, options, subdivision_level);
+            arg += 2;
+        } else {
+            fprintf(stderr, "error: invalid shape '%s'\n", shape);
+            print_usage();
+            return 1;
+        }
+    }
+
+    if(!writer.write(output)) {
+        fprintf(stderr, "error: could not write '%s'\n", output);
+        return 1;
+    }
+    return 0;
+}
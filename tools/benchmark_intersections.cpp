@@ -0,0 +1,208 @@
+// anton_gizmo_benchmark_intersections
+// Measures the average cost of the intersection tests of the handles against prepared handles.
+//
+// Usage:
+//   anton_gizmo_benchmark_intersections [iterations]
+//
+// Every test is run against the same set of random rays and transforms, a part of which hits the handles.
+// Prints the average time of a single test in nanoseconds, taking the fastest of several repetitions, and the number
+// of hits. arrow_3d_batch is the cost per arrow of intersect_arrow_3d_batch. The *_packet tests are the cost per ray
+// of the packet overloads with packets of 16 rays.
+
+#include <anton/gizmo/arrow_3d.hpp>
+#include <anton/gizmo/dial_3d.hpp>
+#include <anton/gizmo/shapes.hpp>
+#include <anton/math/math.hpp>
+#include <anton/math/transform.hpp>
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace anton;
+using namespace anton::gizmo;
+
+constexpr i64 handle_count = 64;
+constexpr i64 ray_count = 1024;
+constexpr i64 repetition_count = 5;
+
+// A deterministic generator, so that every run tests the same rays.
+struct Random {
+    u32 state = 0x12345678;
+
+    // Returns a value in [-1, 1].
+    f32 next() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return static_cast<f32>(state & 0xFFFFFF) / static_cast<f32>(0x7FFFFF) - 1.0f;
+    }
+
+    math::Vec3 next_vec3() {
+        f32 const x = next();
+        f32 const y = next();
+        f32 const z = next();
+        return math::Vec3{x, y, z};
+    }
+};
+
+struct Scene {
+    Array<Prepared_Handle> spheres;
+    Array<Prepared_Handle> arrows;
+    Array<Prepared_Handle> dials;
+    Arrow_3D_Batch arrow_batch;
+    Array<math::Ray> rays;
+    Array<Ray_Packet> packets;
+};
+
+static Scene create_scene(Arrow_3D const& arrow, Dial_3D const& dial) {
+    Random random;
+    Scene scene;
+    Array<math::Mat4> transforms;
+    for(i64 i = 0; i < handle_count; ++i) {
+        math::Vec3 const axis = math::normalize(random.next_vec3() + math::Vec3{0.0f, 0.0f, 1.5f});
+        math::Mat4 const transform = math::translate(random.next_vec3()) * math::rotate(math::Quat::from_axis_angle(axis, 3.0f * random.next())) *
+                                     math::scale(1.25f + 0.75f * random.next());
+        scene.spheres.emplace_back(prepare_sphere(transform));
+        scene.arrows.emplace_back(prepare_arrow_3d(arrow, transform));
+        scene.dials.emplace_back(prepare_dial_3d(dial, transform));
+        transforms.emplace_back(transform);
+    }
+
+    prepare_arrow_3d_batch(Slice<math::Mat4 const>{transforms.data(), transforms.data() + transforms.size()}, scene.arrow_batch);
+
+    for(i64 i = 0; i < ray_count; ++i) {
+        math::Vec3 const origin = random.next_vec3() * 8.0f;
+        math::Vec3 const target = random.next_vec3();
+        scene.rays.emplace_back(math::Ray{origin, math::normalize(target - origin)});
+    }
+
+    for(i64 i = 0; i < ray_count; i += max_ray_packet_size) {
+        scene.packets.emplace_back(make_ray_packet(Slice<math::Ray const>{scene.rays.data() + i, scene.rays.data() + i + max_ray_packet_size}));
+    }
+    return scene;
+}
+
+static void print_result(char const* const name, f64 const nanoseconds, i64 const hits, f32 const checksum) {
+    // Print the checksum so that the tests cannot be optimized away.
+    printf("%-24s %8.2f ns  hits %lld  checksum %g\n", name, nanoseconds, static_cast<long long>(hits), static_cast<f64>(checksum));
+}
+
+template<typename Test>
+static void run(char const* const name, Scene const& scene, Array<Prepared_Handle> const& handles, i64 const iterations, Test const& test) {
+    f64 best = 0.0;
+    i64 hits = 0;
+    f32 checksum = 0.0f;
+    for(i64 repetition = 0; repetition < repetition_count; ++repetition) {
+        hits = 0;
+        checksum = 0.0f;
+        auto const begin = std::chrono::steady_clock::now();
+        for(i64 iteration = 0; iteration < iterations; ++iteration) {
+            for(math::Ray const& ray: scene.rays) {
+                for(Prepared_Handle const& handle: handles) {
+                    Optional<f32> const hit = test(ray, handle);
+                    if(hit) {
+                        hits += 1;
+                        checksum += *hit;
+                    }
+                }
+            }
+        }
+        auto const end = std::chrono::steady_clock::now();
+        f64 const nanoseconds = std::chrono::duration<f64, std::nano>(end - begin).count() / static_cast<f64>(iterations * ray_count * handles.size());
+        if(repetition == 0 || nanoseconds < best) {
+            best = nanoseconds;
+        }
+    }
+    print_result(name, best, hits / iterations, checksum);
+}
+
+template<typename Test>
+static void run_packet(char const* const name, Scene const& scene, Array<Prepared_Handle> const& handles, i64 const iterations, Test const& test) {
+    f64 best = 0.0;
+    i64 hits = 0;
+    f32 checksum = 0.0f;
+    for(i64 repetition = 0; repetition < repetition_count; ++repetition) {
+        hits = 0;
+        checksum = 0.0f;
+        auto const begin = std::chrono::steady_clock::now();
+        for(i64 iteration = 0; iteration < iterations; ++iteration) {
+            for(Ray_Packet const& packet: scene.packets) {
+                for(Prepared_Handle const& handle: handles) {
+                    Ray_Packet_Hits const packet_hits = test(packet, handle);
+                    for(i64 i = 0; i < packet.count; ++i) {
+                        if(packet_hits.distances[i] != math::infinity) {
+                            hits += 1;
+                            checksum += packet_hits.distances[i];
+                        }
+                    }
+                }
+            }
+        }
+        auto const end = std::chrono::steady_clock::now();
+        f64 const nanoseconds = std::chrono::duration<f64, std::nano>(end - begin).count() / static_cast<f64>(iterations * ray_count * handles.size());
+        if(repetition == 0 || nanoseconds < best) {
+            best = nanoseconds;
+        }
+    }
+    print_result(name, best, hits / iterations, checksum);
+}
+
+static void run_arrow_batch(Scene const& scene, Arrow_3D const& arrow, i64 const iterations) {
+    f64 best = 0.0;
+    i64 hits = 0;
+    f32 checksum = 0.0f;
+    for(i64 repetition = 0; repetition < repetition_count; ++repetition) {
+        hits = 0;
+        checksum = 0.0f;
+        auto const begin = std::chrono::steady_clock::now();
+        for(i64 iteration = 0; iteration < iterations; ++iteration) {
+            for(math::Ray const& ray: scene.rays) {
+                Optional<Arrow_3D_Batch_Hit> const hit = intersect_arrow_3d_batch(ray, arrow, scene.arrow_batch);
+                if(hit) {
+                    hits += 1;
+                    checksum += hit->distance;
+                }
+            }
+        }
+        auto const end = std::chrono::steady_clock::now();
+        f64 const nanoseconds =
+            std::chrono::duration<f64, std::nano>(end - begin).count() / static_cast<f64>(iterations * ray_count * scene.arrow_batch.count);
+        if(repetition == 0 || nanoseconds < best) {
+            best = nanoseconds;
+        }
+    }
+    print_result("arrow_3d_batch", best, hits / iterations, checksum);
+}
+
+int main(int const argc, char** const argv) {
+    i64 iterations = 20;
+    if(argc > 1) {
+        iterations = strtoll(argv[1], nullptr, 10);
+        if(iterations <= 0) {
+            fprintf(stderr, "usage: anton_gizmo_benchmark_intersections [iterations]\n");
+            return 1;
+        }
+    }
+
+    Arrow_3D const arrow{Arrow_3D_Style::cone, 0.15f, 0.3f, 1.0f, 0.05f};
+    Dial_3D const dial{1.0f, 0.05f, Dial_3D_Bounds::torus};
+    Dial_3D const dial_cylinders{1.0f, 0.05f, Dial_3D_Bounds::cylinders};
+    Scene const scene = create_scene(arrow, dial);
+    run("sphere", scene, scene.spheres, iterations, [](math::Ray const& ray, Prepared_Handle const& handle) { return intersect_sphere(ray, handle); });
+    run("arrow_3d", scene, scene.arrows, iterations,
+        [&arrow](math::Ray const& ray, Prepared_Handle const& handle) { return intersect_arrow_3d(ray, arrow, handle); });
+    run("dial_3d", scene, scene.dials, iterations, [&dial](math::Ray const& ray, Prepared_Handle const& handle) { return intersect_dial_3d(ray, dial, handle); });
+    run("dial_3d_cylinders", scene, scene.dials, iterations,
+        [&dial_cylinders](math::Ray const& ray, Prepared_Handle const& handle) { return intersect_dial_3d(ray, dial_cylinders, handle); });
+    run_arrow_batch(scene, arrow, iterations);
+    run_packet("sphere_packet", scene, scene.spheres, iterations,
+               [](Ray_Packet const& packet, Prepared_Handle const& handle) { return intersect_sphere(packet, handle); });
+    run_packet("arrow_3d_packet", scene, scene.arrows, iterations,
+               [&arrow](Ray_Packet const& packet, Prepared_Handle const& handle) { return intersect_arrow_3d(packet, arrow, handle); });
+    run_packet("dial_3d_packet", scene, scene.dials, iterations,
+               [&dial](Ray_Packet const& packet, Prepared_Handle const& handle) { return intersect_dial_3d(packet, dial, handle); });
+    run_packet("dial_3d_cylinders_packet", scene, scene.dials, iterations,
+               [&dial_cylinders](Ray_Packet const& packet, Prepared_Handle const& handle) { return intersect_dial_3d(packet, dial_cylinders, handle); });
+    return 0;
+}
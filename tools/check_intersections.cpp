@@ -0,0 +1,484 @@
+// anton_gizmo_check_intersections
+// Checks the intersection tests against brute force references.
+//
+// Usage:
+//   anton_gizmo_check_intersections
+//
+// Every check runs against the same set of random rays. Prints every failed check and the number of checks
+// that have been run. Exits with 1 if any check has failed.
+
+#include <anton/gizmo/arrow_3d.hpp>
+#include <anton/gizmo/dial_3d.hpp>
+#include <anton/gizmo/mesh_bvh.hpp>
+#include <anton/gizmo/screen_picking.hpp>
+#include <anton/math/math.hpp>
+#include <anton/math/transform.hpp>
+#include <intersection_tests.hpp>
+#include <simd.hpp>
+
+#include <math.h>
+#include <stdio.h>
+
+using namespace anton;
+using namespace anton::gizmo;
+
+// A deterministic generator, so that every run checks the same rays.
+struct Random {
+    u32 state = 0x12345678;
+
+    // Returns a value in [-1, 1].
+    f32 next() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return static_cast<f32>(state & 0xFFFFFF) / static_cast<f32>(0x7FFFFF) - 1.0f;
+    }
+
+    math::Vec3 next_vec3() {
+        f32 const x = next();
+        f32 const y = next();
+        f32 const z = next();
+        return math::Vec3{x, y, z};
+    }
+};
+
+static i64 check_count = 0;
+static i64 failure_count = 0;
+
+static void check(bool const condition, char const* const name, i64 const index, f64 const expected, f64 const actual) {
+    check_count += 1;
+    if(!condition) {
+        failure_count += 1;
+        fprintf(stderr, "FAILED %s #%lld: expected %.9g, got %.9g\n", name, static_cast<long long>(index), expected, actual);
+    }
+}
+
+// Signed distance from a point in the local space of a dial to its torus around the z axis.
+static f64 torus_distance(f64 const x, f64 const y, f64 const z, f64 const major_radius, f64 const minor_radius) {
+    f64 const radial = sqrt(x * x + y * y) - major_radius;
+    return sqrt(radial * radial + z * z) - minor_radius;
+}
+
+// check_torus
+// Compares the torus bounds of intersect_dial_3d with a march along the ray in steps of torus_step that refines
+// the first step that enters the torus by bisection. The march may step over a torus that the ray only grazes,
+// hence a hit reported by only one of them is accepted if the ray never gets deeper than a step into the torus.
+//
+static void check_torus() {
+    constexpr f64 torus_step = 1e-4;
+    constexpr f64 tolerance = 2e-4;
+    Random random;
+    Dial_3D const dial{1.0f, 0.25f, Dial_3D_Bounds::torus};
+    math::Vec3 const center{0.5f, -0.25f, 1.0f};
+    f32 const scale = 1.5f;
+    math::Mat4 const world_transform = math::translate(center) * math::scale(scale);
+    f64 const major_radius = scale * dial.major_radius;
+    f64 const minor_radius = scale * dial.minor_radius;
+    for(i64 i = 0; i < 2000; ++i) {
+        math::Vec3 const origin = center + random.next_vec3() * 4.0f;
+        math::Vec3 const target = center + random.next_vec3() * 1.75f;
+        math::Vec3 const direction = math::normalize(target - origin);
+        Optional<f32> const hit = intersect_dial_3d(math::Ray{origin, direction}, dial, world_transform);
+
+        f64 const ox = origin.x - center.x;
+        f64 const oy = origin.y - center.y;
+        f64 const oz = origin.z - center.z;
+        auto const distance_at = [&](f64 const t) {
+            return torus_distance(ox + t * direction.x, oy + t * direction.y, oz + t * direction.z, major_radius, minor_radius);
+        };
+
+        f64 const length = 8.0 + 2.0 * (major_radius + minor_radius);
+        f64 expected = math::infinity;
+        f64 deepest = distance_at(0.0);
+        if(deepest <= 0.0) {
+            expected = 0.0;
+        } else {
+            for(f64 t = torus_step; t <= length; t += torus_step) {
+                f64 const distance = distance_at(t);
+                deepest = distance < deepest ? distance : deepest;
+                if(distance <= 0.0) {
+                    f64 outside = t - torus_step;
+                    f64 inside = t;
+                    for(i32 iteration = 0; iteration < 60; ++iteration) {
+                        f64 const middle = 0.5 * (outside + inside);
+                        if(distance_at(middle) <= 0.0) {
+                            inside = middle;
+                        } else {
+                            outside = middle;
+                        }
+                    }
+                    expected = inside;
+                    break;
+                }
+            }
+        }
+
+        bool const grazing = deepest > -torus_step;
+        if(hit && expected != math::infinity) {
+            check(fabs(*hit - expected) <= tolerance, "torus distance", i, expected, *hit);
+        } else if(!grazing) {
+            check(false, "torus hit", i, expected, hit ? *hit : math::infinity);
+        } else {
+            check_count += 1;
+        }
+
+        // The distance is measured in units of the length of the direction.
+        Optional<f32> const scaled_hit = intersect_dial_3d(math::Ray{origin, direction * 4.0f}, dial, world_transform);
+        check(static_cast<bool>(hit) == static_cast<bool>(scaled_hit) && (!hit || fabs(*hit - 4.0 * *scaled_hit) <= 1e-5 * (1.0 + *hit)),
+              "torus unnormalized direction", i, hit ? *hit : math::infinity, scaled_hit ? 4.0 * *scaled_hit : math::infinity);
+    }
+}
+
+// Entry and exit distances of a ray through an axis aligned box. Components of the direction that are 0 are handled
+// explicitly instead of relying on infinities.
+struct Slab_Reference {
+    f64 t_min;
+    f64 t_max;
+};
+
+static Slab_Reference reference_slabs(f32 const* const origin, f32 const* const direction, f32 const* const box_min, f32 const* const box_max) {
+    Slab_Reference result{0.0, math::infinity};
+    for(i32 axis = 0; axis < 3; ++axis) {
+        if(direction[axis] == 0.0f) {
+            if(origin[axis] < box_min[axis] || origin[axis] > box_max[axis]) {
+                return {math::infinity, -math::infinity};
+            }
+            continue;
+        }
+
+        f64 const t1 = (static_cast<f64>(box_min[axis]) - origin[axis]) / direction[axis];
+        f64 const t2 = (static_cast<f64>(box_max[axis]) - origin[axis]) / direction[axis];
+        result.t_min = fmax(result.t_min, fmin(t1, t2));
+        result.t_max = fmin(result.t_max, fmax(t1, t2));
+    }
+    return result;
+}
+
+// check_slabs
+// Compares intersect_ray_slabs, both with f32 and with every lane of simd::Float, with reference_slabs. The origins and
+// directions are built from values that hit the edge cases of the slab test: rays parallel to the axes, rays starting
+// on the faces of the box and boxes with no thickness along some axes. Hits are compared exactly where the reference
+// finds an entry that is clearly before the exit and the results must never be NaN.
+//
+static void check_slabs() {
+    constexpr i64 case_count = 20000;
+    constexpr i64 lanes = simd::lane_count;
+    Random random;
+    auto const pick = [&random](f32 const* const values, i32 const count) {
+        f32 const r = 0.5f * (random.next() + 1.0f) * static_cast<f32>(count);
+        i32 const index = static_cast<i32>(r);
+        return values[index < count ? index : count - 1];
+    };
+
+    for(i64 i = 0; i < case_count; i += lanes) {
+        f32 box_min[3];
+        f32 box_max[3];
+        for(i32 axis = 0; axis < 3; ++axis) {
+            f32 const bounds[] = {-1.0f, -0.5f, 0.0f, 0.25f, 1.0f};
+            f32 const a = pick(bounds, 5);
+            f32 const b = pick(bounds, 5);
+            box_min[axis] = a < b ? a : b;
+            box_max[axis] = a < b ? b : a;
+        }
+
+        f32 origins[3][lanes];
+        f32 directions[3][lanes];
+        for(i64 lane = 0; lane < lanes; ++lane) {
+            for(i32 axis = 0; axis < 3; ++axis) {
+                f32 const positions[] = {box_min[axis], box_max[axis], 0.5f * (box_min[axis] + box_max[axis]), -2.0f, 2.0f, 0.0f, random.next() * 3.0f};
+                f32 const components[] = {0.0f, -0.0f, 1.0f, -1.0f, 0.5f, random.next()};
+                origins[axis][lane] = pick(positions, 7);
+                directions[axis][lane] = pick(components, 6);
+            }
+
+            if(directions[0][lane] == 0.0f && directions[1][lane] == 0.0f && directions[2][lane] == 0.0f) {
+                directions[2][lane] = 1.0f;
+            }
+        }
+
+        simd::Float3 const origin{simd::load<simd::Float>(origins[0]), simd::load<simd::Float>(origins[1]), simd::load<simd::Float>(origins[2])};
+        simd::Float3 const direction{simd::load<simd::Float>(directions[0]), simd::load<simd::Float>(directions[1]),
+                                     simd::load<simd::Float>(directions[2])};
+        simd::Float3 const lanes_min{simd::splat<simd::Float>(box_min[0]), simd::splat<simd::Float>(box_min[1]), simd::splat<simd::Float>(box_min[2])};
+        simd::Float3 const lanes_max{simd::splat<simd::Float>(box_max[0]), simd::splat<simd::Float>(box_max[1]), simd::splat<simd::Float>(box_max[2])};
+        f32 lane_distances[lanes];
+        simd::store(lane_distances, intersect_ray_slabs(make_ray_slabs(origin, direction), lanes_min, lanes_max));
+
+        for(i64 lane = 0; lane < lanes; ++lane) {
+            i64 const index = i + lane;
+            f32 const ray_origin[3] = {origins[0][lane], origins[1][lane], origins[2][lane]};
+            f32 const ray_direction[3] = {directions[0][lane], directions[1][lane], directions[2][lane]};
+            math::Vec3 const vec_origin{ray_origin[0], ray_origin[1], ray_origin[2]};
+            math::Vec3 const vec_direction{ray_direction[0], ray_direction[1], ray_direction[2]};
+            f32 const distance = intersect_ray_slabs(make_ray_slabs(vec_origin, vec_direction), math::Vec3{box_min[0], box_min[1], box_min[2]},
+                                                     math::Vec3{box_max[0], box_max[1], box_max[2]});
+            Slab_Reference const reference = reference_slabs(ray_origin, ray_direction, box_min, box_max);
+            f64 const expected = reference.t_min <= reference.t_max ? reference.t_min : math::infinity;
+            f64 const tolerance = 1e-5 * (1.0 + fabs(reference.t_min));
+            check(distance == distance, "slabs NaN", index, expected, distance);
+            check(lane_distances[lane] == distance, "slabs lanes", index, distance, lane_distances[lane]);
+            if(reference.t_max - reference.t_min > tolerance || reference.t_min > reference.t_max + tolerance) {
+                bool const equal = expected == math::infinity ? distance == math::infinity : fabs(distance - expected) <= tolerance;
+                check(equal, "slabs distance", index, expected, distance);
+            } else {
+                // The ray only touches an edge or a corner of the box.
+                check_count += 1;
+            }
+        }
+    }
+}
+
+// A hit of reference_triangle.
+struct Triangle_Reference {
+    f64 distance;
+    // The smallest barycentric weight of the hit point. Negative if the ray passes outside of the triangle.
+    f64 min_weight;
+};
+
+// Moller-Trumbore test in doubles that reports how far inside of the triangle the ray passes instead of
+// rejecting rays outside of it. Returns infinity for rays parallel to the triangle and hits behind the origin.
+static Triangle_Reference reference_triangle(math::Vec3 const& origin, math::Vec3 const& direction, math::Vec3 const& v0, math::Vec3 const& v1,
+                                             math::Vec3 const& v2) {
+    f64 const d[3] = {direction.x, direction.y, direction.z};
+    f64 const e1[3] = {static_cast<f64>(v1.x) - v0.x, static_cast<f64>(v1.y) - v0.y, static_cast<f64>(v1.z) - v0.z};
+    f64 const e2[3] = {static_cast<f64>(v2.x) - v0.x, static_cast<f64>(v2.y) - v0.y, static_cast<f64>(v2.z) - v0.z};
+    f64 const s[3] = {static_cast<f64>(origin.x) - v0.x, static_cast<f64>(origin.y) - v0.y, static_cast<f64>(origin.z) - v0.z};
+    f64 const p[3] = {d[1] * e2[2] - d[2] * e2[1], d[2] * e2[0] - d[0] * e2[2], d[0] * e2[1] - d[1] * e2[0]};
+    f64 const q[3] = {s[1] * e1[2] - s[2] * e1[1], s[2] * e1[0] - s[0] * e1[2], s[0] * e1[1] - s[1] * e1[0]};
+    f64 const determinant = e1[0] * p[0] + e1[1] * p[1] + e1[2] * p[2];
+    if(fabs(determinant) < 1e-12) {
+        return {math::infinity, -1.0};
+    }
+
+    f64 const u = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) / determinant;
+    f64 const v = (d[0] * q[0] + d[1] * q[1] + d[2] * q[2]) / determinant;
+    f64 const distance = (e2[0] * q[0] + e2[1] * q[1] + e2[2] * q[2]) / determinant;
+    if(distance < 0.0) {
+        return {math::infinity, -1.0};
+    }
+    return {distance, fmin(fmin(u, v), 1.0 - u - v)};
+}
+
+// check_mesh
+// Compares Mesh_BVH::intersect with reference_triangle called for every triangle of the mesh. triangles holds the 3
+// vertices of every triangle in the order of the triangle indices of the hierarchy. Rays that pass within edge_weight
+// of an edge may hit either of the triangles sharing the edge or slip between them, hence they are only required not
+// to miss the triangles they clearly hit. The barycentric coordinates must interpolate the vertices of the reported
+// triangle to the hit point. The error of the point grows as the ray gets parallel to the triangle, so the tolerance
+// is divided by the cosine of the angle between the ray and the normal.
+//
+static void check_mesh(char const* const name, Mesh_BVH const& mesh, Array<math::Vec3> const& triangles) {
+    constexpr f64 edge_weight = 1e-4;
+    constexpr f64 tolerance = 1e-4;
+    Random random;
+    i64 const triangle_count = triangles.size() / 3;
+    for(i64 i = 0; i < 2000; ++i) {
+        // Aim most rays at a random point of a random triangle and the rest anywhere near the mesh.
+        math::Vec3 const origin = random.next_vec3() * 3.0f;
+        math::Vec3 target = random.next_vec3() * 1.2f;
+        if(i % 4 != 0) {
+            i64 const triangle = static_cast<i64>(0.5f * (random.next() + 1.0f) * static_cast<f32>(triangle_count - 1));
+            f32 const a = 0.5f * (random.next() + 1.0f);
+            f32 const b = 0.5f * (random.next() + 1.0f) * (1.0f - a);
+            target = triangles[3 * triangle] * (1.0f - a - b) + triangles[3 * triangle + 1] * a + triangles[3 * triangle + 2] * b;
+        }
+        math::Vec3 const direction = math::normalize(target - origin);
+        Optional<Mesh_Hit> const hit = mesh.intersect(math::Ray{origin, direction});
+
+        // The nearest hit that is clearly inside of its triangle.
+        f64 nearest = math::infinity;
+        for(i64 triangle = 0; triangle < triangle_count; ++triangle) {
+            Triangle_Reference const reference =
+                reference_triangle(origin, direction, triangles[3 * triangle], triangles[3 * triangle + 1], triangles[3 * triangle + 2]);
+            if(reference.min_weight >= edge_weight) {
+                nearest = fmin(nearest, reference.distance);
+            }
+        }
+
+        if(!hit) {
+            check(nearest == math::infinity, name, i, nearest, math::infinity);
+            continue;
+        }
+
+        // The hit must be on the reported triangle and not farther than the nearest triangle.
+        bool const valid_triangle = hit->triangle >= 0 && hit->triangle < triangle_count;
+        check(valid_triangle, name, i, static_cast<f64>(triangle_count), static_cast<f64>(hit->triangle));
+        if(!valid_triangle) {
+            continue;
+        }
+
+        math::Vec3 const v0 = triangles[3 * hit->triangle];
+        math::Vec3 const v1 = triangles[3 * hit->triangle + 1];
+        math::Vec3 const v2 = triangles[3 * hit->triangle + 2];
+        Triangle_Reference const reference = reference_triangle(origin, direction, v0, v1, v2);
+        check(reference.min_weight > -edge_weight && fabs(hit->distance - reference.distance) <= tolerance, name, i, reference.distance, hit->distance);
+        check(hit->distance <= nearest + tolerance, name, i, nearest, hit->distance);
+
+        math::Vec3 const weights = hit->barycentric_coordinates;
+        f64 const weight_sum = static_cast<f64>(weights.x) + weights.y + weights.z;
+        check(fabs(weight_sum - 1.0) <= 1e-5, "barycentric sum", i, 1.0, weight_sum);
+        f64 const min_weight = fmin(fmin(weights.x, weights.y), weights.z);
+        check(min_weight >= -edge_weight, "barycentric weight", i, 0.0, min_weight);
+        math::Vec3 const interpolated = v0 * weights.x + v1 * weights.y + v2 * weights.z;
+        f64 const error = math::length(interpolated - (origin + direction * hit->distance));
+        f64 const cosine = fabs(math::dot(direction, math::normalize(math::cross(v1 - v0, v2 - v0))));
+        check(error * cosine <= tolerance, "barycentric point", i, 0.0, error);
+    }
+}
+
+// check_mesh_bvh
+// Checks Mesh_BVH built over a triangle list, a triangle strip and indexed geometry.
+//
+static void check_mesh_bvh() {
+    Dial_3D const dial{1.0f, 0.05f, Dial_3D_Bounds::torus};
+    {
+        Array<math::Vec3> const vertices = generate_dial_3d_geometry(dial, 32, 8);
+        Mesh_BVH mesh;
+        mesh.build(Slice<math::Vec3 const>{vertices.data(), vertices.data() + vertices.size()});
+        check_mesh("mesh_bvh triangle list", mesh, vertices);
+    }
+
+    {
+        Array<math::Vec3> const vertices = generate_dial_3d_geometry(dial, 32, 8, Primitive_Topology::triangle_strip);
+        Mesh_BVH mesh;
+        mesh.build(Slice<math::Vec3 const>{vertices.data(), vertices.data() + vertices.size()}, Primitive_Topology::triangle_strip);
+        Array<math::Vec3> triangles;
+        for(i64 i = 0; i + 2 < vertices.size(); ++i) {
+            triangles.emplace_back(vertices[i]);
+            triangles.emplace_back(vertices[i + 1]);
+            triangles.emplace_back(vertices[i + 2]);
+        }
+        check_mesh("mesh_bvh triangle strip", mesh, triangles);
+    }
+
+    {
+        Arrow_3D const arrow{Arrow_3D_Style::cone, 0.15f, 0.3f, 1.0f, 0.05f};
+        Indexed_Geometry const geometry = generate_arrow_3d_geometry_indexed(arrow, 16);
+        Mesh_BVH mesh;
+        mesh.build(geometry);
+        Array<math::Vec3> triangles;
+        for(u32 const index: geometry.indices) {
+            triangles.emplace_back(geometry.vertices[index]);
+        }
+        check_mesh("mesh_bvh indexed", mesh, triangles);
+    }
+}
+
+// Distance from a point to the ellipse with the semi-axes a and b along the x and y axes. The ellipse is sampled
+// densely and the nearest sample is refined by a golden section search over the angle.
+static f64 reference_ellipse_distance(f64 const x, f64 const y, f64 const a, f64 const b) {
+    constexpr i64 sample_count = 20000;
+    constexpr f64 pi = 3.14159265358979323846;
+    auto const distance_at = [&](f64 const angle) {
+        f64 const dx = a * cos(angle) - x;
+        f64 const dy = b * sin(angle) - y;
+        return sqrt(dx * dx + dy * dy);
+    };
+
+    f64 const step = 2.0 * pi / static_cast<f64>(sample_count);
+    f64 nearest_angle = 0.0;
+    f64 nearest = distance_at(0.0);
+    for(i64 i = 1; i < sample_count; ++i) {
+        f64 const distance = distance_at(static_cast<f64>(i) * step);
+        if(distance < nearest) {
+            nearest = distance;
+            nearest_angle = static_cast<f64>(i) * step;
+        }
+    }
+
+    f64 const ratio = 0.5 * (sqrt(5.0) - 1.0);
+    f64 low = nearest_angle - step;
+    f64 high = nearest_angle + step;
+    for(i32 iteration = 0; iteration < 80; ++iteration) {
+        f64 const first = high - ratio * (high - low);
+        f64 const second = low + ratio * (high - low);
+        if(distance_at(first) < distance_at(second)) {
+            high = second;
+        } else {
+            low = first;
+        }
+    }
+    return fmin(nearest, distance_at(0.5 * (low + high)));
+}
+
+// check_screen_picking
+// Compares the distances of pick_projected_gizmo to a dial, and to a center handle, projected to ellipses of various
+// flatness with reference_ellipse_distance. Cursors are placed around the outline and near the ends of the major axis,
+// where the curvature of flat ellipses is the greatest. Cursors within 1e-3 pixels of the tolerance may be either
+// picked or not.
+//
+static void check_screen_picking() {
+    constexpr f64 pi = 3.14159265358979323846;
+    constexpr f64 tolerance = 1e-2;
+    f32 const ratios[] = {1.0f, 0.6f, 0.2f, 0.1f, 0.05f, 0.01f, 0.0f};
+    f32 const pixel_tolerances[] = {2.0f, 4.0f, 8.0f};
+    Random random;
+    for(i64 i = 0; i < 3000; ++i) {
+        f32 const a = 60.0f + 50.0f * random.next();
+        f32 const b = a * ratios[i % 7];
+        f32 const pixel_tolerance = pixel_tolerances[(i / 7) % 3];
+        f32 const angle = static_cast<f32>(pi) * random.next();
+        math::Vec2 const major_axis{cosf(angle), sinf(angle)};
+        math::Vec2 const minor_axis{-major_axis.y, major_axis.x};
+        math::Vec2 const center{400.0f + 100.0f * random.next(), 300.0f + 100.0f * random.next()};
+
+        // The position of the cursor in the space of the ellipse.
+        f32 x;
+        f32 y;
+        if(i % 2 == 0) {
+            // Along the major axis near its ends.
+            x = (random.next() > 0.0f ? 1.0f : -1.0f) * (a + 2.0f * pixel_tolerance * random.next());
+            y = 0.5f * pixel_tolerance * random.next();
+        } else {
+            f32 const t = static_cast<f32>(pi) * random.next();
+            x = a * cosf(t) + 2.0f * pixel_tolerance * random.next();
+            y = b * sinf(t) + 2.0f * pixel_tolerance * random.next();
+        }
+
+        // The example of a cursor inside of the ellipse shrunk by the tolerance yet near the outline.
+        if(i == 0) {
+            x = 95.0f;
+            y = 0.0f;
+        }
+
+        bool const filled = i % 5 == 0;
+        Projected_Gizmo gizmo = {};
+        Projected_Handle& handle = gizmo.handles[static_cast<i64>(filled ? Gizmo_Handle::center : Gizmo_Handle::axis_z)];
+        handle.shape = filled ? Projected_Handle_Shape::filled_ellipse : Projected_Handle_Shape::ellipse;
+        handle.points[0] = center;
+        handle.major_axis = major_axis;
+        handle.major_radius = i == 0 ? 100.0f : a;
+        handle.minor_radius = i == 0 ? 10.0f : b;
+        gizmo.bounds_min = center - math::Vec2{handle.major_radius, handle.major_radius};
+        gizmo.bounds_max = center + math::Vec2{handle.major_radius, handle.major_radius};
+        math::Vec2 const cursor = center + major_axis * x + minor_axis * y;
+        Optional<Gizmo_Screen_Pick> const pick = pick_projected_gizmo(cursor, gizmo, i == 0 ? 4.0f : pixel_tolerance, 0);
+
+        // Use the cursor as rounded to f32 on the screen.
+        math::Vec2 const offset = cursor - center;
+        f64 const local_x = static_cast<f64>(offset.x) * major_axis.x + static_cast<f64>(offset.y) * major_axis.y;
+        f64 const local_y = static_cast<f64>(offset.x) * minor_axis.x + static_cast<f64>(offset.y) * minor_axis.y;
+        f64 const major_radius = handle.major_radius;
+        f64 const minor_radius = handle.minor_radius;
+        bool const inside = minor_radius > 0.0 && (local_x * local_x) / (major_radius * major_radius) + (local_y * local_y) / (minor_radius * minor_radius) <= 1.0;
+        f64 const expected = filled && inside ? 0.0 : reference_ellipse_distance(local_x, local_y, major_radius, minor_radius);
+        f64 const limit = i == 0 ? 4.0 : pixel_tolerance;
+        if(expected <= limit - 1e-3) {
+            check(pick && fabs(pick->pixel_distance - expected) <= tolerance, "screen picking distance", i, expected,
+                  pick ? pick->pixel_distance : math::infinity);
+        } else if(expected >= limit + 1e-3) {
+            check(!pick, "screen picking miss", i, expected, pick ? pick->pixel_distance : math::infinity);
+        } else {
+            check_count += 1;
+        }
+    }
+}
+
+int main() {
+    check_torus();
+    check_slabs();
+    check_mesh_bvh();
+    check_screen_picking();
+    printf("%lld checks, %lld failed\n", static_cast<long long>(check_count), static_cast<long long>(failure_count));
+    return failure_count > 0 ? 1 : 0;
+}